@@ -0,0 +1,22 @@
+#include "benchfw.h"
+
+#include <string.h>
+
+bool __bench_json_output = false;
+
+externbench(proto)
+externbench(cemi)
+externbench(data)
+
+int main(int argc, char** argv) {
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--json") == 0)
+			__bench_json_output = true;
+	}
+
+	runbench(proto);
+	runbench(cemi);
+	runbench(data);
+
+	return 0;
+}
@@ -0,0 +1,141 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_BENCH_BENCHFW_H_
+#define KNXPROTO_BENCH_BENCHFW_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+/**
+ * Minimum duration of a measurement in nanoseconds
+ */
+#ifndef KNX_BENCH_TARGET_NS
+	#define KNX_BENCH_TARGET_NS 100000000ull
+#endif
+
+/**
+ * Emit JSON lines instead of a table (set by the benchmark runner).
+ */
+extern bool __bench_json_output;
+
+inline static uint64_t __bench_now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/**
+ * Read the time stamp counter. This counts reference cycles, which may differ from core cycles
+ * if frequency scaling is active. Yields `0` on architectures without a time stamp counter.
+ */
+inline static uint64_t __bench_cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+	return __builtin_ia32_rdtsc();
+#else
+	return 0;
+#endif
+}
+
+inline static void __bench_report(
+	const char* name,
+	uint64_t    iterations,
+	uint64_t    elapsed_ns,
+	uint64_t    elapsed_cycles
+) {
+	double ns_per_op = (double) elapsed_ns / iterations;
+	double cycles_per_op = (double) elapsed_cycles / iterations;
+	double frames_per_sec = ns_per_op > 0 ? 1e9 / ns_per_op : 0;
+
+	if (__bench_json_output) {
+		printf(
+			"{\"name\":\"%s\",\"iterations\":%llu,\"ns_per_op\":%.3f,"
+			"\"cycles_per_op\":%.3f,\"frames_per_sec\":%.0f}\n",
+			name, (unsigned long long) iterations, ns_per_op, cycles_per_op, frames_per_sec
+		);
+	} else {
+		printf(
+			"%-48s %12.2f ns/op %12.2f cycles/op %14.0f frames/s\n",
+			name, ns_per_op, cycles_per_op, frames_per_sec
+		);
+	}
+
+	fflush(stdout);
+}
+
+/**
+ * Prevent the compiler from discarding the computation of `*ptr`.
+ */
+#define escape(ptr) __asm__ __volatile__("" : : "g"(ptr) : "memory")
+
+/**
+ * Define a group of benchmarks.
+ * Example:
+ * 	defbench(my_bench, {
+ * 		measure(addition, {
+ * 			int x = 2 + 2;
+ * 			escape(&x);
+ * 		});
+ * 	})
+ */
+#define defbench(name, ...) \
+	void __benchgroup_##name(void) { \
+		{ __VA_ARGS__ }; \
+	}
+
+/**
+ * Simply generate the signature of this benchmark group.
+ */
+#define externbench(name) \
+	void __benchgroup_##name(void);
+
+/**
+ * Run a benchmark group.
+ */
+#define runbench(name) __benchgroup_##name()
+
+/**
+ * Measure the given statements. The number of iterations is doubled until the measurement takes
+ * at least `KNX_BENCH_TARGET_NS` nanoseconds, which also serves as warm-up.
+ */
+#define measure(name, ...) { \
+	uint64_t __iterations = 1; \
+	while (true) { \
+		uint64_t __elapsed_ns = __bench_now(); \
+		uint64_t __elapsed_cycles = __bench_cycles(); \
+		for (uint64_t __i = 0; __i < __iterations; __i++) { \
+			__VA_ARGS__; \
+			__asm__ __volatile__("" : : : "memory"); \
+		} \
+		__elapsed_cycles = __bench_cycles() - __elapsed_cycles; \
+		__elapsed_ns = __bench_now() - __elapsed_ns; \
+		if (__elapsed_ns >= KNX_BENCH_TARGET_NS || __iterations >= (1ull << 40)) { \
+			__bench_report(__STRING(name), __iterations, __elapsed_ns, __elapsed_cycles); \
+			break; \
+		} \
+		__iterations *= 2; \
+	} \
+}
+
+#endif
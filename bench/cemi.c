@@ -0,0 +1,97 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "benchfw.h"
+
+#include "../src/proto/cemi.h"
+
+#include <stdlib.h>
+
+defbench(cemi, {
+	const uint8_t apdu[3] = {0, 0x0C, 0x1A};
+
+	knx_cemi cemi = {
+		KNX_CEMI_LDATA_IND,
+		0,
+		NULL,
+		{
+			.ldata = {
+				.control1 = {KNX_LDATA_PRIO_LOW, true, true, false, false},
+				.control2 = {KNX_LDATA_ADDR_GROUP, 6},
+				.source = 0x1101,
+				.destination = 0x0A03,
+				.tpdu = {
+					.tpci = KNX_TPCI_UNNUMBERED_DATA,
+					.info = {
+						.data = {
+							.apci = KNX_APCI_GROUPVALUEWRITE,
+							.payload = apdu,
+							.length = sizeof(apdu)
+						}
+					}
+				}
+			}
+		}
+	};
+
+	uint8_t buffer[64];
+	size_t length = knx_cemi_size(&cemi);
+	knx_cemi_generate(buffer, &cemi);
+
+	const uint8_t* ldata_buffer = buffer + KNX_CEMI_HEADER_SIZE;
+	size_t ldata_length = length - KNX_CEMI_HEADER_SIZE;
+
+	const uint8_t* tpdu_buffer = ldata_buffer + KNX_LDATA_HEADER_SIZE;
+	size_t tpdu_length = ldata_length - KNX_LDATA_HEADER_SIZE;
+
+	measure(knx_cemi_generate, {
+		bool result = knx_cemi_generate(buffer, &cemi);
+		escape(&result);
+		escape(buffer);
+	});
+
+	measure(knx_cemi_parse, {
+		knx_cemi frame;
+		bool result = knx_cemi_parse(buffer, length, &frame);
+		escape(&result);
+		escape(&frame);
+	});
+
+	measure(knx_ldata_parse, {
+		knx_ldata frame;
+		bool result = knx_ldata_parse(ldata_buffer, ldata_length, &frame);
+		escape(&result);
+		escape(&frame);
+	});
+
+	measure(knx_tpdu_parse, {
+		knx_tpdu tpdu;
+		bool result = knx_tpdu_parse(tpdu_buffer, tpdu_length, &tpdu);
+		escape(&result);
+		escape(&tpdu);
+	});
+
+	measure(knx_ldata_duplicate, {
+		knx_ldata* copy = knx_ldata_duplicate(&cemi.payload.ldata);
+		escape(copy);
+		free(copy);
+	});
+})
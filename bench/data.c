@@ -0,0 +1,60 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "benchfw.h"
+
+#include "../src/proto/data.h"
+
+// Measure conversion of the given value to its APDU and back
+#define bench_dpt(type, ctype, ...) { \
+	ctype value = __VA_ARGS__; \
+	ctype result; \
+	uint8_t apdu[8] = {0}; \
+	size_t length = knx_dpt_size(type); \
+	\
+	measure(knx_dpt_to_apdu/type, { \
+		knx_dpt_to_apdu(apdu, type, &value); \
+		escape(apdu); \
+	}); \
+	\
+	measure(knx_dpt_from_apdu/type, { \
+		bool success = knx_dpt_from_apdu(apdu, length, type, &result); \
+		escape(&success); \
+		escape(&result); \
+	}); \
+}
+
+defbench(data, {
+	bench_dpt(KNX_DPT_BOOL, knx_bool, true);
+	bench_dpt(KNX_DPT_CVALUE, knx_cvalue, {true, false});
+	bench_dpt(KNX_DPT_CSTEP, knx_cstep, {true, 5});
+	bench_dpt(KNX_DPT_CHAR, knx_char, 'K');
+	bench_dpt(KNX_DPT_UNSIGNED8, knx_unsigned8, 200);
+	bench_dpt(KNX_DPT_SIGNED8, knx_signed8, -100);
+	bench_dpt(KNX_DPT_UNSIGNED16, knx_unsigned16, 50000);
+	bench_dpt(KNX_DPT_SIGNED16, knx_signed16, -20000);
+	bench_dpt(KNX_DPT_FLOAT16, knx_float16, 21.5);
+	bench_dpt(KNX_DPT_TIMEOFDAY, knx_timeofday, {KNX_MONDAY, 12, 34, 56});
+	bench_dpt(KNX_DPT_DATE, knx_date, {18, 10, 26});
+	bench_dpt(KNX_DPT_UNSIGNED32, knx_unsigned32, 4000000000u);
+	bench_dpt(KNX_DPT_SIGNED32, knx_signed32, -2000000000);
+	bench_dpt(KNX_DPT_FLOAT32, knx_float32, 1234.5678f);
+})
@@ -0,0 +1,173 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "benchfw.h"
+
+#include "../src/proto/proto.h"
+#include "../src/proto/view.h"
+#include "../src/proto/batch.h"
+#include "../src/proto/classify.h"
+
+#include <string.h>
+
+static
+const uint8_t example_apdu[3] = {0, 0x0C, 0x1A};
+
+static
+const knx_ldata example_ldata = {
+	.control1 = {KNX_LDATA_PRIO_LOW, true, true, true, false},
+	.control2 = {KNX_LDATA_ADDR_GROUP, 6},
+	.source = 0x1101,
+	.destination = 0x0A03,
+	.tpdu = {
+		.tpci = KNX_TPCI_UNNUMBERED_DATA,
+		.info = {
+			.data = {
+				.apci = KNX_APCI_GROUPVALUEWRITE,
+				.payload = example_apdu,
+				.length = sizeof(example_apdu)
+			}
+		}
+	}
+};
+
+// M_PropRead.req for PID_IP_ADDRESS of the KNXnet/IP parameter object
+static
+const uint8_t example_prop_read[7] = {KNX_CEMI_MPROPREAD_REQ, 0x00, 0x0B, 0x01, 0x34, 0x10, 0x01};
+
+static
+knx_description_service example_services[3] = {{2, 1}, {3, 1}, {4, 1}};
+
+static
+const knx_description_response example_description = {
+	.medium = 2,
+	.address = 0x1101,
+	.multicast_address = 0x0C1700E0,
+	.name = "Benchmark",
+	.num_services = 3,
+	.services = example_services
+};
+
+// Generate the frame once, then measure generation and parsing of it
+#define bench_service(service, input) { \
+	uint8_t buffer[256]; \
+	size_t length = knx_size(service, input); \
+	knx_generate(buffer, service, input); \
+	\
+	measure(knx_generate/service, { \
+		bool result = knx_generate(buffer, service, input); \
+		escape(&result); \
+		escape(buffer); \
+	}); \
+	\
+	measure(knx_generate_bounded/service, { \
+		ssize_t result = knx_generate_bounded(buffer, sizeof(buffer), service, input); \
+		escape(&result); \
+		escape(buffer); \
+	}); \
+	\
+	measure(knx_parse/service, { \
+		knx_packet packet; \
+		ssize_t result = knx_parse(buffer, length, &packet); \
+		if (service == KNX_DESCRIPTION_RESPONSE) \
+			knx_description_response_free_services(&packet.payload.description_res); \
+		else if (service == KNX_SEARCH_RESPONSE) \
+			knx_description_response_free_services(&packet.payload.search_res.description); \
+		escape(&result); \
+		escape(&packet); \
+	}); \
+}
+
+defbench(proto, {
+	knx_host_info host = {KNX_PROTO_UDP, 0x0100007F, 0x3E0E};
+
+	knx_connection_request conn_req = {
+		KNX_CONNECTION_REQUEST_TUNNEL,
+		KNX_CONNECTION_LAYER_TUNNEL,
+		host,
+		host
+	};
+
+	knx_connection_response conn_res = {1, 0, host, {4, 0x11, 0x05}};
+	knx_connection_state_request conn_state_req = {1, 0, host};
+	knx_connection_state_response conn_state_res = {1, 0};
+	knx_disconnect_request dc_req = {1, 0, host};
+	knx_disconnect_response dc_res = {1, 0};
+	knx_tunnel_request tunnel_req = {1, 0, {KNX_CEMI_LDATA_REQ, 0, NULL, {.ldata = example_ldata}}};
+	knx_tunnel_response tunnel_res = {1, 0, 0};
+	knx_device_configuration_request config_req = {
+		1,
+		0,
+		example_prop_read,
+		sizeof(example_prop_read)
+	};
+	knx_routing_indication routing_ind = {{KNX_CEMI_LDATA_IND, 0, NULL, {.ldata = example_ldata}}};
+	knx_description_request description_req = {host};
+	knx_search_response search_res = {host, example_description};
+
+	bench_service(KNX_SEARCH_REQUEST, &description_req);
+	bench_service(KNX_SEARCH_RESPONSE, &search_res);
+	bench_service(KNX_DESCRIPTION_REQUEST, &description_req);
+	bench_service(KNX_DESCRIPTION_RESPONSE, &example_description);
+	bench_service(KNX_CONNECTION_REQUEST, &conn_req);
+	bench_service(KNX_CONNECTION_RESPONSE, &conn_res);
+	bench_service(KNX_CONNECTION_STATE_REQUEST, &conn_state_req);
+	bench_service(KNX_CONNECTION_STATE_RESPONSE, &conn_state_res);
+	bench_service(KNX_DISCONNECT_REQUEST, &dc_req);
+	bench_service(KNX_DISCONNECT_RESPONSE, &dc_res);
+	bench_service(KNX_DEVICE_CONFIGURATION_REQUEST, &config_req);
+	bench_service(KNX_DEVICE_CONFIGURATION_ACK, &tunnel_res);
+	bench_service(KNX_TUNNEL_REQUEST, &tunnel_req);
+	bench_service(KNX_TUNNEL_RESPONSE, &tunnel_res);
+	bench_service(KNX_ROUTING_INDICATION, &routing_ind);
+
+	// Lightweight alternatives to knx_parse
+	uint8_t frame[64];
+	size_t frame_length = knx_size(KNX_ROUTING_INDICATION, &routing_ind);
+	knx_generate(frame, KNX_ROUTING_INDICATION, &routing_ind);
+
+	measure(knx_frame_view_destination/KNX_ROUTING_INDICATION, {
+		knx_frame_view view;
+		knx_addr destination = 0;
+		if (knx_frame_view_init(&view, frame, frame_length) > 0)
+			knx_frame_view_destination(&view, &destination, NULL);
+		escape(&destination);
+	});
+
+	measure(knx_classify/KNX_ROUTING_INDICATION, {
+		knx_class key = knx_classify(frame, frame_length);
+		escape(&key);
+	});
+
+	knx_datagram datagrams[KNX_BATCH_SIZE];
+	for (size_t i = 0; i < KNX_BATCH_SIZE; i++) {
+		datagrams[i].frame = frame;
+		datagrams[i].length = frame_length;
+	}
+
+	static knx_batch_result batch;
+
+	measure(knx_parse_batch/KNX_BATCH_SIZE, {
+		size_t count = knx_parse_batch(datagrams, KNX_BATCH_SIZE, &batch);
+		escape(&count);
+		escape(&batch);
+	});
+})
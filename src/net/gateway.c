@@ -0,0 +1,587 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "gateway.h"
+
+#include <string.h>
+
+// Status codes used in responses
+#define KNX_GATEWAY_SIM_E_CONNECTION_ID       0x21
+#define KNX_GATEWAY_SIM_E_NO_MORE_CONNECTIONS 0x24
+
+static
+uint32_t knx_gateway_sim_random(knx_gateway_sim* sim) {
+	// xorshift32
+	uint32_t x = sim->random;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+
+	return sim->random = x;
+}
+
+static
+knx_addr knx_gateway_sim_destination(knx_gateway_sim* sim) {
+	const knx_gateway_sim_traffic* traffic = &sim->traffic;
+	uint16_t offset;
+
+	switch (traffic->distribution) {
+		case KNX_GATEWAY_SIM_SEQUENTIAL:
+			offset = sim->cursor;
+			sim->cursor = (sim->cursor + 1) % traffic->count;
+			break;
+
+		case KNX_GATEWAY_SIM_HOTSPOT: {
+			uint32_t r = knx_gateway_sim_random(sim);
+			uint16_t hot = traffic->count / 5 > 0 ? traffic->count / 5 : 1;
+
+			if (r % 10 < 8 || hot == traffic->count)
+				offset = (r >> 8) % hot;
+			else
+				offset = hot + (r >> 8) % (traffic->count - hot);
+
+			break;
+		}
+
+		default:
+			offset = knx_gateway_sim_random(sim) % traffic->count;
+			break;
+	}
+
+	return traffic->first + offset;
+}
+
+// Generate the next synthetic L_Data.ind, returns its size
+static
+size_t knx_gateway_sim_synthesize(knx_gateway_sim* sim, uint8_t* buffer) {
+	uint8_t apdu[2] = {0, sim->counter++};
+
+	knx_cemi cemi = {
+		KNX_CEMI_LDATA_IND,
+		0,
+		NULL,
+		{
+			.ldata = {
+				.control1 = {KNX_LDATA_PRIO_LOW, true, true, false, false},
+				.control2 = {KNX_LDATA_ADDR_GROUP, 6},
+				.source = sim->traffic.source,
+				.destination = knx_gateway_sim_destination(sim),
+				.tpdu = {
+					.tpci = KNX_TPCI_UNNUMBERED_DATA,
+					.info = {
+						.data = {
+							.apci = KNX_APCI_GROUPVALUEWRITE,
+							.payload = apdu,
+							.length = sizeof(apdu)
+						}
+					}
+				}
+			}
+		}
+	};
+
+	knx_cemi_generate(buffer, &cemi);
+	return knx_cemi_size(&cemi);
+}
+
+static
+void knx_gateway_sim_close(knx_gateway_sim_channel* channel) {
+	knx_timer_cancel(&channel->request_timer);
+	knx_timer_cancel(&channel->alive_timer);
+
+	channel->active = false;
+	channel->frame_length = 0;
+	channel->backlog = 0;
+	channel->queue_count = 0;
+}
+
+// Tell the client that the connection is gone
+static
+void knx_gateway_sim_abort(knx_gateway_sim_channel* channel) {
+	knx_disconnect_request req = {
+		channel->channel,
+		0,
+		KNX_HOST_INFO_NAT(KNX_PROTO_UDP)
+	};
+
+	knx_transport_queue(channel->sim->transport, &channel->control, KNX_DISCONNECT_REQUEST, &req);
+	knx_gateway_sim_close(channel);
+}
+
+// Confirmations take precedence over synthetic traffic
+static
+void knx_gateway_sim_transmit(knx_gateway_sim_channel* channel) {
+	knx_gateway_sim* sim = channel->sim;
+
+	if (!channel->active || channel->frame_length > 0)
+		return;
+
+	uint8_t* cemi = channel->frame + KNX_HEADER_SIZE + 4;
+	size_t length;
+
+	if (channel->queue_count > 0) {
+		const knx_tunnel_slot* slot = &channel->queue[channel->queue_head];
+
+		memcpy(cemi, slot->cemi, slot->length);
+		length = slot->length;
+
+		channel->queue_head = (channel->queue_head + 1) % KNX_GATEWAY_SIM_QUEUE_SIZE;
+		channel->queue_count--;
+	} else if (channel->backlog > 0 || sim->traffic.rate == KNX_GATEWAY_SIM_UNPACED) {
+		length = knx_gateway_sim_synthesize(sim, cemi);
+
+		if (channel->backlog > 0)
+			channel->backlog--;
+
+		sim->stats.injected++;
+	} else {
+		return;
+	}
+
+	knx_header_generate(channel->frame, KNX_TUNNEL_REQUEST, 4 + length);
+
+	uint8_t* payload = channel->frame + KNX_HEADER_SIZE;
+	payload[0] = 4;
+	payload[1] = channel->channel;
+	payload[2] = channel->tx_seq_number;
+	payload[3] = 0;
+
+	channel->frame_length = KNX_HEADER_SIZE + 4 + length;
+	channel->attempts = 1;
+
+	// The frame is copied, a repetition may still be queued when the acknowledgement arrives
+	knx_transport_queue_copy(sim->transport, &channel->tunnel, channel->frame, channel->frame_length);
+	knx_timer_schedule(sim->wheel, &channel->request_timer, KNX_TUNNEL_ACK_TIMEOUT);
+}
+
+static
+void knx_gateway_sim_request_timeout(knx_timer* timer, void* data) {
+	knx_gateway_sim_channel* channel = data;
+	knx_gateway_sim* sim = channel->sim;
+
+	if (!channel->active || channel->frame_length == 0)
+		return;
+
+	// A tunnel request is repeated once, then the connection is given up
+	if (channel->attempts < 2) {
+		channel->attempts++;
+		sim->stats.repeated++;
+
+		knx_transport_queue_copy(
+			sim->transport,
+			&channel->tunnel,
+			channel->frame,
+			channel->frame_length
+		);
+		knx_timer_schedule(sim->wheel, timer, KNX_TUNNEL_ACK_TIMEOUT);
+	} else {
+		sim->stats.dropped += 1 + channel->backlog;
+		knx_gateway_sim_abort(channel);
+	}
+}
+
+static
+void knx_gateway_sim_alive_timeout(knx_timer* timer, void* data) {
+	knx_gateway_sim_channel* channel = data;
+	(void) timer;
+
+	if (channel->active)
+		knx_gateway_sim_abort(channel);
+}
+
+static
+void knx_gateway_sim_inject(knx_timer* timer, void* data) {
+	knx_gateway_sim* sim = data;
+	uint64_t now = sim->wheel->now;
+	uint64_t elapsed = now - sim->injected_at;
+
+	sim->injected_at = now;
+
+	for (size_t i = 0; i < KNX_GATEWAY_SIM_CHANNELS; i++) {
+		knx_gateway_sim_channel* channel = &sim->channels[i];
+
+		if (!channel->active)
+			continue;
+
+		channel->credit += elapsed * sim->traffic.rate;
+
+		uint64_t due = channel->backlog + channel->credit / 1000;
+		channel->credit %= 1000;
+
+		if (due > KNX_GATEWAY_SIM_BACKLOG) {
+			sim->stats.dropped += due - KNX_GATEWAY_SIM_BACKLOG;
+			due = KNX_GATEWAY_SIM_BACKLOG;
+		}
+
+		channel->backlog = due;
+		knx_gateway_sim_transmit(channel);
+	}
+
+	knx_timer_schedule(sim->wheel, timer, sim->wheel->resolution);
+}
+
+void knx_gateway_sim_init(
+	knx_gateway_sim*        sim,
+	knx_transport*          transport,
+	knx_timer_wheel*        wheel,
+	knx_gateway_sim_handler handler,
+	void*                   data
+) {
+	sim->transport = transport;
+	sim->wheel = wheel;
+	sim->handler = handler;
+	sim->data = data;
+
+	sim->address = knx_individual_addr(1, 1, 200);
+	sim->confirm = true;
+
+	sim->traffic.rate = 0;
+	sim->traffic.distribution = KNX_GATEWAY_SIM_SEQUENTIAL;
+	sim->traffic.first = knx_group_addr(1, 0, 0);
+	sim->traffic.count = 1;
+	sim->traffic.source = knx_individual_addr(1, 1, 1);
+
+	sim->cursor = 0;
+	sim->counter = 0;
+	sim->random = (uint32_t) (knx_timer_now() ^ (uintptr_t) sim) | 1;
+	sim->injected_at = wheel->now;
+	knx_timer_init(&sim->inject_timer, knx_gateway_sim_inject, sim);
+
+	memset(&sim->stats, 0, sizeof(sim->stats));
+
+	for (size_t i = 0; i < KNX_GATEWAY_SIM_CHANNELS; i++) {
+		knx_gateway_sim_channel* channel = &sim->channels[i];
+
+		channel->sim = sim;
+		channel->active = false;
+		channel->channel = i + 1;
+
+		knx_timer_init(&channel->request_timer, knx_gateway_sim_request_timeout, channel);
+		knx_timer_init(&channel->alive_timer, knx_gateway_sim_alive_timeout, channel);
+
+		channel->frame_length = 0;
+		channel->queue_head = 0;
+		channel->queue_count = 0;
+	}
+}
+
+void knx_gateway_sim_destroy(knx_gateway_sim* sim) {
+	knx_timer_cancel(&sim->inject_timer);
+
+	for (size_t i = 0; i < KNX_GATEWAY_SIM_CHANNELS; i++)
+		knx_gateway_sim_close(&sim->channels[i]);
+}
+
+bool knx_gateway_sim_set_traffic(knx_gateway_sim* sim, const knx_gateway_sim_traffic* traffic) {
+	if (traffic->rate > 0 && traffic->count == 0)
+		return false;
+
+	sim->traffic = *traffic;
+	sim->cursor = 0;
+	sim->injected_at = sim->wheel->now;
+
+	knx_timer_cancel(&sim->inject_timer);
+
+	if (traffic->rate > 0 && traffic->rate != KNX_GATEWAY_SIM_UNPACED)
+		knx_timer_schedule(sim->wheel, &sim->inject_timer, sim->wheel->resolution);
+
+	for (size_t i = 0; i < KNX_GATEWAY_SIM_CHANNELS; i++) {
+		sim->channels[i].credit = 0;
+		knx_gateway_sim_transmit(&sim->channels[i]);
+	}
+
+	return true;
+}
+
+static
+knx_gateway_sim_channel* knx_gateway_sim_find(knx_gateway_sim* sim, uint8_t channel) {
+	if (channel == 0 || channel > KNX_GATEWAY_SIM_CHANNELS || !sim->channels[channel - 1].active)
+		return NULL;
+
+	return &sim->channels[channel - 1];
+}
+
+// Endpoints in NAT mode are replaced with the origin of the request
+static
+void knx_gateway_sim_endpoint(
+	struct sockaddr_in*       endpoint,
+	const knx_host_info*      host,
+	const struct sockaddr_in* sender
+) {
+	if (host->address == 0 || host->port == 0) {
+		*endpoint = *sender;
+	} else {
+		memset(endpoint, 0, sizeof(*endpoint));
+		endpoint->sin_family = AF_INET;
+		endpoint->sin_addr.s_addr = host->address;
+		endpoint->sin_port = host->port;
+	}
+}
+
+// Core, device management and tunnelling, each in version 1
+static const uint8_t knx_gateway_sim_services[] = {2, 1, 3, 1, 4, 1};
+
+static
+void knx_gateway_sim_describe(
+	knx_gateway_sim*               sim,
+	const struct sockaddr_in*      sender,
+	const knx_description_request* req
+) {
+	knx_description_view view = {
+		.medium = 2,
+		.address = sim->address,
+		.name = "knxproto gateway simulator",
+		.services = knx_gateway_sim_services,
+		.num_services = sizeof(knx_gateway_sim_services) / 2
+	};
+
+	uint8_t frame[KNX_HEADER_SIZE + 56 + sizeof(knx_gateway_sim_services)];
+	struct sockaddr_in control;
+
+	knx_gateway_sim_endpoint(&control, &req->control_host, sender);
+
+	knx_header_generate(frame, KNX_DESCRIPTION_RESPONSE, knx_description_view_size(&view));
+	knx_description_view_generate(frame + KNX_HEADER_SIZE, &view);
+
+	knx_transport_queue_copy(sim->transport, &control, frame, sizeof(frame));
+}
+
+static
+void knx_gateway_sim_connect(
+	knx_gateway_sim*              sim,
+	const struct sockaddr_in*     sender,
+	const knx_connection_request* req
+) {
+	knx_gateway_sim_channel* channel = NULL;
+
+	for (size_t i = 0; i < KNX_GATEWAY_SIM_CHANNELS && !channel; i++) {
+		if (!sim->channels[i].active)
+			channel = &sim->channels[i];
+	}
+
+	struct sockaddr_in control;
+	knx_gateway_sim_endpoint(&control, &req->control_host, sender);
+
+	if (!channel) {
+		knx_connection_response res = {
+			0,
+			KNX_GATEWAY_SIM_E_NO_MORE_CONNECTIONS,
+			KNX_HOST_INFO_NAT(KNX_PROTO_UDP),
+			{0, 0, 0}
+		};
+
+		knx_transport_queue(sim->transport, &control, KNX_CONNECTION_RESPONSE, &res);
+		sim->stats.rejected++;
+		return;
+	}
+
+	channel->active = true;
+	channel->address = sim->address + (channel->channel - 1);
+	channel->control = control;
+	knx_gateway_sim_endpoint(&channel->tunnel, &req->tunnel_host, sender);
+
+	channel->tx_seq_number = 0;
+	channel->rx_seq_number = 0;
+	channel->attempts = 0;
+	channel->backlog = 0;
+	channel->credit = 0;
+	channel->frame_length = 0;
+	channel->queue_head = 0;
+	channel->queue_count = 0;
+
+	knx_connection_response res = {
+		channel->channel,
+		0,
+		KNX_HOST_INFO_NAT(KNX_PROTO_UDP),
+		{KNX_CONNECTION_REQUEST_TUNNEL, channel->address >> 8, channel->address & 0xFF}
+	};
+
+	knx_transport_queue(sim->transport, &control, KNX_CONNECTION_RESPONSE, &res);
+	knx_timer_schedule(sim->wheel, &channel->alive_timer, KNX_GATEWAY_SIM_ALIVE_TIMEOUT);
+
+	sim->stats.connections++;
+
+	knx_gateway_sim_transmit(channel);
+}
+
+static
+void knx_gateway_sim_confirm(knx_gateway_sim_channel* channel, const knx_cemi* req) {
+	if (channel->queue_count >= KNX_GATEWAY_SIM_QUEUE_SIZE)
+		return;
+
+	knx_cemi con = *req;
+	con.service = KNX_CEMI_LDATA_CON;
+	con.payload.ldata.control1.error = false;
+
+	if (con.payload.ldata.source == 0)
+		con.payload.ldata.source = channel->address;
+
+	size_t length = knx_cemi_size(&con);
+	if (length > KNX_TUNNEL_CEMI_SIZE)
+		return;
+
+	knx_tunnel_slot* slot =
+		&channel->queue[(channel->queue_head + channel->queue_count) % KNX_GATEWAY_SIM_QUEUE_SIZE];
+
+	if (!knx_cemi_generate(slot->cemi, &con))
+		return;
+
+	slot->length = length;
+	channel->queue_count++;
+}
+
+static
+void knx_gateway_sim_incoming(knx_gateway_sim_channel* channel, const knx_tunnel_request* req) {
+	knx_gateway_sim* sim = channel->sim;
+	knx_tunnel_response res = {channel->channel, req->seq_number, 0};
+
+	if (req->seq_number == channel->rx_seq_number) {
+		knx_transport_queue(sim->transport, &channel->tunnel, KNX_TUNNEL_RESPONSE, &res);
+		channel->rx_seq_number++;
+		sim->stats.received++;
+
+		if (sim->handler)
+			sim->handler(sim->data, channel, &req->data);
+
+		if (sim->confirm && req->data.service == KNX_CEMI_LDATA_REQ) {
+			knx_gateway_sim_confirm(channel, &req->data);
+			knx_gateway_sim_transmit(channel);
+		}
+	} else if (req->seq_number == (uint8_t) (channel->rx_seq_number - 1)) {
+		// Our acknowledgement got lost, the client repeats its request
+		knx_transport_queue(sim->transport, &channel->tunnel, KNX_TUNNEL_RESPONSE, &res);
+	}
+}
+
+static
+void knx_gateway_sim_acknowledged(knx_gateway_sim_channel* channel, const knx_tunnel_response* res) {
+	if (channel->frame_length == 0 || res->seq_number != channel->tx_seq_number || res->status != 0)
+		return;
+
+	knx_timer_cancel(&channel->request_timer);
+
+	channel->tx_seq_number++;
+	channel->frame_length = 0;
+	channel->attempts = 0;
+	channel->sim->stats.acknowledged++;
+
+	knx_gateway_sim_transmit(channel);
+}
+
+bool knx_gateway_sim_handle(
+	knx_gateway_sim*          sim,
+	const struct sockaddr_in* sender,
+	const knx_packet*         packet
+) {
+	knx_gateway_sim_channel* channel;
+
+	switch (packet->service) {
+		case KNX_DESCRIPTION_REQUEST:
+			knx_gateway_sim_describe(sim, sender, &packet->payload.description_req);
+			return true;
+
+		case KNX_CONNECTION_REQUEST:
+			knx_gateway_sim_connect(sim, sender, &packet->payload.conn_req);
+			return true;
+
+		case KNX_CONNECTION_STATE_REQUEST: {
+			const knx_connection_state_request* req = &packet->payload.conn_state_req;
+			knx_connection_state_response res = {req->channel, 0};
+			struct sockaddr_in control;
+
+			knx_gateway_sim_endpoint(&control, &req->host, sender);
+			channel = knx_gateway_sim_find(sim, req->channel);
+
+			if (channel)
+				knx_timer_schedule(sim->wheel, &channel->alive_timer, KNX_GATEWAY_SIM_ALIVE_TIMEOUT);
+			else
+				res.status = KNX_GATEWAY_SIM_E_CONNECTION_ID;
+
+			knx_transport_queue(sim->transport, &control, KNX_CONNECTION_STATE_RESPONSE, &res);
+			return true;
+		}
+
+		case KNX_DISCONNECT_REQUEST: {
+			const knx_disconnect_request* req = &packet->payload.dc_req;
+			knx_disconnect_response res = {req->channel, 0};
+			struct sockaddr_in control;
+
+			knx_gateway_sim_endpoint(&control, &req->host, sender);
+			channel = knx_gateway_sim_find(sim, req->channel);
+
+			if (channel)
+				knx_gateway_sim_close(channel);
+			else
+				res.status = KNX_GATEWAY_SIM_E_CONNECTION_ID;
+
+			knx_transport_queue(sim->transport, &control, KNX_DISCONNECT_RESPONSE, &res);
+			return true;
+		}
+
+		case KNX_DISCONNECT_RESPONSE:
+			// The channel has already been closed when the request was sent
+			return true;
+
+		case KNX_TUNNEL_REQUEST:
+			channel = knx_gateway_sim_find(sim, packet->payload.tunnel_req.channel);
+			if (!channel)
+				return false;
+
+			knx_gateway_sim_incoming(channel, &packet->payload.tunnel_req);
+			return true;
+
+		case KNX_TUNNEL_RESPONSE:
+			channel = knx_gateway_sim_find(sim, packet->payload.tunnel_res.channel);
+			if (!channel)
+				return false;
+
+			knx_gateway_sim_acknowledged(channel, &packet->payload.tunnel_res);
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+void knx_gateway_sim_dispatch(
+	void*                     data,
+	const struct sockaddr_in* sender,
+	const uint8_t*            frame,
+	size_t                    length,
+	const knx_packet*         packet
+) {
+	(void) frame;
+	(void) length;
+
+	if (packet)
+		knx_gateway_sim_handle(data, sender, packet);
+}
+
+size_t knx_gateway_sim_connections(const knx_gateway_sim* sim) {
+	size_t count = 0;
+
+	for (size_t i = 0; i < KNX_GATEWAY_SIM_CHANNELS; i++) {
+		if (sim->channels[i].active)
+			count++;
+	}
+
+	return count;
+}
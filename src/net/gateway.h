@@ -0,0 +1,308 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_NET_GATEWAY_H_
+#define KNXPROTO_NET_GATEWAY_H_
+
+#include "tunnel.h"
+
+#include <netinet/in.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Maximum number of tunnel connections served by a simulated gateway
+ */
+#define KNX_GATEWAY_SIM_CHANNELS 32
+
+/**
+ * Number of L_Data.con frames that can be queued per connection
+ */
+#define KNX_GATEWAY_SIM_QUEUE_SIZE 16
+
+/**
+ * Maximum number of injected frames a connection may fall behind before they are dropped
+ */
+#define KNX_GATEWAY_SIM_BACKLOG 1024
+
+/**
+ * Time after which a connection without connection state requests is dropped
+ */
+#define KNX_GATEWAY_SIM_ALIVE_TIMEOUT 120000
+
+/**
+ * Injection rate which sends the next frame as soon as the previous one is acknowledged
+ */
+#define KNX_GATEWAY_SIM_UNPACED UINT32_MAX
+
+/**
+ * Destination Address Distribution
+ */
+typedef enum {
+	/**
+	 * Cycle through the address range
+	 */
+	KNX_GATEWAY_SIM_SEQUENTIAL,
+
+	/**
+	 * Pick addresses uniformly at random
+	 */
+	KNX_GATEWAY_SIM_UNIFORM,
+
+	/**
+	 * Send 80% of the traffic to the first 20% of the address range
+	 */
+	KNX_GATEWAY_SIM_HOTSPOT
+} knx_gateway_sim_distribution;
+
+/**
+ * Synthetic Traffic
+ */
+typedef struct {
+	/**
+	 * L_Data.ind frames per second and connection (`0` disables injection)
+	 */
+	uint32_t rate;
+
+	knx_gateway_sim_distribution distribution;
+
+	/**
+	 * First group address of the destination range
+	 */
+	knx_addr first;
+
+	/**
+	 * Number of group addresses in the destination range
+	 */
+	uint16_t count;
+
+	/**
+	 * Source address of the injected frames
+	 */
+	knx_addr source;
+} knx_gateway_sim_traffic;
+
+typedef struct _knx_gateway_sim knx_gateway_sim;
+
+/**
+ * Tunnel Connection on the Gateway Side
+ */
+typedef struct {
+	knx_gateway_sim* sim;
+
+	bool active;
+
+	/**
+	 * Channel identifier, never `0`
+	 */
+	uint8_t channel;
+
+	/**
+	 * Individual address assigned to the client
+	 */
+	knx_addr address;
+
+	/**
+	 * Where control responses are sent
+	 */
+	struct sockaddr_in control;
+
+	/**
+	 * Where tunnel requests are sent
+	 */
+	struct sockaddr_in tunnel;
+
+	/**
+	 * Sequence number of the next outgoing tunnel request
+	 */
+	uint8_t tx_seq_number;
+
+	/**
+	 * Sequence number of the next expected incoming tunnel request
+	 */
+	uint8_t rx_seq_number;
+
+	/**
+	 * Number of transmissions of the request in flight
+	 */
+	uint8_t attempts;
+
+	/**
+	 * Injected frames that are due but have not been sent yet
+	 */
+	uint32_t backlog;
+
+	/**
+	 * Injection credit in thousandths of a frame
+	 */
+	uint64_t credit;
+
+	knx_timer request_timer;
+	knx_timer alive_timer;
+
+	/**
+	 * Frame of the request in flight
+	 */
+	uint8_t frame[KNX_HEADER_SIZE + 4 + KNX_TUNNEL_CEMI_SIZE];
+	size_t  frame_length;
+
+	size_t          queue_head;
+	size_t          queue_count;
+	knx_tunnel_slot queue[KNX_GATEWAY_SIM_QUEUE_SIZE];
+} knx_gateway_sim_channel;
+
+/**
+ * Handler for frames received from a client (may be `NULL`)
+ */
+typedef void (* knx_gateway_sim_handler)(
+	void*                    data,
+	knx_gateway_sim_channel* channel,
+	const knx_cemi*          cemi
+);
+
+/**
+ * Simulated KNXnet/IP Tunnelling Gateway
+ *
+ * Serves tunnel connections for load tests, so clients can be benchmarked on loopback without
+ * real hardware. Description requests are answered, connection requests are assigned a free
+ * channel, connection state requests and disconnect requests are answered and tunnel requests are
+ * acknowledged. Each L_Data.req is confirmed with an L_Data.con, unless `confirm` is cleared.
+ *
+ * In addition, every connection receives synthetic L_Data.ind traffic as configured by
+ * `knx_gateway_sim_set_traffic`. Like a real gateway, only one tunnel request is in flight per
+ * connection, therefore the achievable rate is bounded by the client's acknowledgement latency.
+ * Frames the client cannot keep up with accumulate up to `KNX_GATEWAY_SIM_BACKLOG` and are
+ * dropped afterwards.
+ *
+ * The simulator does not own a socket or a clock. Packets are fed into `knx_gateway_sim_handle`
+ * and replies are queued on the transport.
+ */
+struct _knx_gateway_sim {
+	knx_transport*   transport;
+	knx_timer_wheel* wheel;
+
+	knx_gateway_sim_handler handler;
+	void*                   data;
+
+	/**
+	 * Individual address assigned to the first channel, the others follow consecutively
+	 */
+	knx_addr address;
+
+	/**
+	 * Answer L_Data.req with L_Data.con
+	 */
+	bool confirm;
+
+	knx_gateway_sim_traffic traffic;
+
+	/**
+	 * Next destination offset for `KNX_GATEWAY_SIM_SEQUENTIAL`
+	 */
+	uint16_t cursor;
+
+	/**
+	 * Payload of the next injected frame
+	 */
+	uint8_t counter;
+
+	uint32_t  random;
+	uint64_t  injected_at;
+	knx_timer inject_timer;
+
+	/**
+	 * Statistics
+	 */
+	struct {
+		uint64_t connections;
+		uint64_t rejected;
+		uint64_t received;
+		uint64_t injected;
+		uint64_t acknowledged;
+		uint64_t repeated;
+		uint64_t dropped;
+	} stats;
+
+	knx_gateway_sim_channel channels[KNX_GATEWAY_SIM_CHANNELS];
+};
+
+/**
+ * Initialize the simulator. No traffic is injected until `knx_gateway_sim_set_traffic` is
+ * called.
+ *
+ * \param sim       Simulator
+ * \param transport Transport bound to the gateway address
+ * \param wheel     Timer wheel driving timeouts and injection
+ * \param handler   Handler for frames received from clients (may be `NULL`)
+ * \param data      User data for the handler
+ */
+void knx_gateway_sim_init(
+	knx_gateway_sim*        sim,
+	knx_transport*          transport,
+	knx_timer_wheel*        wheel,
+	knx_gateway_sim_handler handler,
+	void*                   data
+);
+
+/**
+ * Cancel all timers. Clients are not notified.
+ */
+void knx_gateway_sim_destroy(knx_gateway_sim* sim);
+
+/**
+ * Configure the synthetic traffic. Takes effect immediately for all connections.
+ *
+ * \returns `true` on success, `false` if the destination range is empty
+ */
+bool knx_gateway_sim_set_traffic(knx_gateway_sim* sim, const knx_gateway_sim_traffic* traffic);
+
+/**
+ * Process a packet received from a client.
+ *
+ * \param sim    Simulator
+ * \param sender Origin of the packet
+ * \param packet Parsed packet
+ * \returns `true` if the packet has been handled, otherwise `false`
+ */
+bool knx_gateway_sim_handle(
+	knx_gateway_sim*          sim,
+	const struct sockaddr_in* sender,
+	const knx_packet*         packet
+);
+
+/**
+ * Handler suitable for `knx_transport_dispatch`, `data` must point to the simulator.
+ */
+void knx_gateway_sim_dispatch(
+	void*                     data,
+	const struct sockaddr_in* sender,
+	const uint8_t*            frame,
+	size_t                    length,
+	const knx_packet*         packet
+);
+
+/**
+ * Number of open connections.
+ */
+size_t knx_gateway_sim_connections(const knx_gateway_sim* sim);
+
+#endif
@@ -0,0 +1,228 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "pipeline.h"
+#include "../proto/classify.h"
+#include "../util/alloc.h"
+
+#include <string.h>
+
+static
+void knx_pipeline_decode(knx_pipeline_worker* worker, const knx_pipeline_slot* slot) {
+	knx_pipeline* pipeline = worker->pipeline;
+	knx_packet packet;
+
+	if (knx_parse(slot->frame, slot->length, &packet) < 0)
+		return;
+
+	knx_pipeline_event event;
+	event.worker = worker->index;
+	event.service = packet.service;
+	event.has_value = false;
+
+	if (packet.service == KNX_TUNNEL_REQUEST)
+		event.cemi = &packet.payload.tunnel_req.data;
+	else if (packet.service == KNX_ROUTING_INDICATION)
+		event.cemi = &packet.payload.routing_ind.data;
+	else
+		return;
+
+	const knx_tpdu* tpdu = &event.cemi->payload.ldata.tpdu;
+
+	if (pipeline->resolver &&
+	    (tpdu->tpci == KNX_TPCI_UNNUMBERED_DATA || tpdu->tpci == KNX_TPCI_NUMBERED_DATA) &&
+	    pipeline->resolver(pipeline->data, event.cemi->payload.ldata.destination, &event.type)) {
+		event.has_value = knx_dpt_from_apdu(
+			tpdu->info.data.payload,
+			tpdu->info.data.length,
+			event.type,
+			&event.value
+		);
+	}
+
+	pipeline->handler(pipeline->data, &event);
+}
+
+static
+void* knx_pipeline_work(void* data) {
+	knx_pipeline_worker* worker = data;
+	knx_spsc_index* ring = &worker->ring;
+
+	while (true) {
+		size_t count = knx_spsc_index_peek(ring);
+
+		if (count > 0) {
+			for (size_t i = 0; i < count; i++)
+				knx_pipeline_decode(worker, &worker->slots[(ring->tail + i) & ring->mask]);
+
+			knx_spsc_index_release(ring, count);
+			continue;
+		}
+
+		// Remaining frames have been decoded above
+		if (!__atomic_load_n(&worker->pipeline->running, __ATOMIC_SEQ_CST))
+			break;
+
+		// Announce that we are about to sleep, then check again to not miss a wake-up
+		pthread_mutex_lock(&worker->lock);
+		__atomic_store_n(&worker->sleeping, 1, __ATOMIC_SEQ_CST);
+
+		if (__atomic_load_n(&ring->head, __ATOMIC_SEQ_CST) == ring->tail &&
+		    __atomic_load_n(&worker->pipeline->running, __ATOMIC_SEQ_CST))
+			pthread_cond_wait(&worker->wakeup, &worker->lock);
+
+		__atomic_store_n(&worker->sleeping, 0, __ATOMIC_RELAXED);
+		pthread_mutex_unlock(&worker->lock);
+	}
+
+	return NULL;
+}
+
+static
+void knx_pipeline_wake(knx_pipeline_worker* worker) {
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+	if (__atomic_load_n(&worker->sleeping, __ATOMIC_SEQ_CST)) {
+		pthread_mutex_lock(&worker->lock);
+		pthread_cond_signal(&worker->wakeup);
+		pthread_mutex_unlock(&worker->lock);
+	}
+}
+
+static
+void knx_pipeline_free_worker(knx_pipeline_worker* worker) {
+	pthread_cond_destroy(&worker->wakeup);
+	pthread_mutex_destroy(&worker->lock);
+	free(worker->slots);
+}
+
+bool knx_pipeline_start(
+	knx_pipeline*         pipeline,
+	size_t                num_workers,
+	size_t                capacity,
+	knx_pipeline_handler  handler,
+	knx_pipeline_resolver resolver,
+	void*                 data
+) {
+	if (num_workers == 0 || num_workers > KNX_PIPELINE_MAX_WORKERS)
+		return false;
+
+	pipeline->num_workers = 0;
+	pipeline->running = true;
+	pipeline->handler = handler;
+	pipeline->resolver = resolver;
+	pipeline->data = data;
+
+	for (size_t i = 0; i < num_workers; i++) {
+		knx_pipeline_worker* worker = &pipeline->workers[i];
+
+		worker->pipeline = pipeline;
+		worker->index = i;
+		worker->slots = newa(knx_pipeline_slot, knx_spsc_index_init(&worker->ring, capacity));
+		worker->sleeping = 0;
+
+		pthread_mutex_init(&worker->lock, NULL);
+		pthread_cond_init(&worker->wakeup, NULL);
+
+		if (!worker->slots || pthread_create(&worker->thread, NULL, knx_pipeline_work, worker) != 0) {
+			knx_pipeline_free_worker(worker);
+			knx_pipeline_stop(pipeline);
+			return false;
+		}
+
+		pipeline->num_workers++;
+	}
+
+	return true;
+}
+
+void knx_pipeline_stop(knx_pipeline* pipeline) {
+	__atomic_store_n(&pipeline->running, false, __ATOMIC_SEQ_CST);
+
+	for (size_t i = 0; i < pipeline->num_workers; i++) {
+		knx_pipeline_worker* worker = &pipeline->workers[i];
+
+		pthread_mutex_lock(&worker->lock);
+		pthread_cond_signal(&worker->wakeup);
+		pthread_mutex_unlock(&worker->lock);
+
+		pthread_join(worker->thread, NULL);
+		knx_pipeline_free_worker(worker);
+	}
+
+	pipeline->num_workers = 0;
+}
+
+// Queue a frame without waking the worker, returns the worker index or -1
+static
+int knx_pipeline_enqueue(knx_pipeline* pipeline, const uint8_t* frame, size_t length) {
+	if (length > KNX_PIPELINE_FRAME_SIZE)
+		return -1;
+
+	knx_class key = knx_classify(frame, length);
+	if (key == 0)
+		return -1;
+
+	size_t index = knx_pipeline_select(pipeline, knx_class_destination(key));
+	knx_pipeline_worker* worker = &pipeline->workers[index];
+	size_t slot_index;
+
+	if (!knx_spsc_index_reserve(&worker->ring, &slot_index))
+		return -1;
+
+	knx_pipeline_slot* slot = &worker->slots[slot_index];
+	memcpy(slot->frame, frame, length);
+	slot->length = length;
+
+	knx_spsc_index_commit(&worker->ring);
+	return index;
+}
+
+bool knx_pipeline_push(knx_pipeline* pipeline, const uint8_t* frame, size_t length) {
+	int index = knx_pipeline_enqueue(pipeline, frame, length);
+
+	if (index < 0)
+		return false;
+
+	knx_pipeline_wake(&pipeline->workers[index]);
+	return true;
+}
+
+size_t knx_pipeline_push_batch(knx_pipeline* pipeline, const knx_datagram* datagrams, size_t count) {
+	uint32_t touched = 0;
+	size_t queued = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		int index = knx_pipeline_enqueue(pipeline, datagrams[i].frame, datagrams[i].length);
+
+		if (index >= 0) {
+			touched |= 1u << index;
+			queued++;
+		}
+	}
+
+	for (size_t i = 0; i < pipeline->num_workers; i++) {
+		if (touched & (1u << i))
+			knx_pipeline_wake(&pipeline->workers[i]);
+	}
+
+	return queued;
+}
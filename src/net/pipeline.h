@@ -0,0 +1,196 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_NET_PIPELINE_H_
+#define KNXPROTO_NET_PIPELINE_H_
+
+#include "transport.h"
+#include "../proto/proto.h"
+#include "../proto/batch.h"
+#include "../proto/data.h"
+#include "../util/address.h"
+#include "../util/ring.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Maximum number of decode workers
+ */
+#define KNX_PIPELINE_MAX_WORKERS 16
+
+/**
+ * Maximum size of a frame passed through the pipeline
+ */
+#define KNX_PIPELINE_FRAME_SIZE KNX_TRANSPORT_FRAME_SIZE
+
+/**
+ * Decoded Frame
+ */
+typedef struct {
+	/**
+	 * Index of the worker which decoded the frame
+	 */
+	size_t worker;
+
+	/**
+	 * `KNX_TUNNEL_REQUEST` or `KNX_ROUTING_INDICATION`
+	 */
+	knx_service service;
+
+	/**
+	 * Fully parsed cEMI frame
+	 */
+	const knx_cemi* cemi;
+
+	/**
+	 * Whether `type` and `value` are valid
+	 */
+	bool has_value;
+
+	/**
+	 * Datapoint type reported by the resolver
+	 */
+	knx_dpt type;
+
+	/**
+	 * Decoded datapoint value
+	 */
+	knx_value value;
+} knx_pipeline_event;
+
+/**
+ * Handler for decoded frames. It runs on the worker threads, hence it may be invoked
+ * concurrently for different destinations.
+ */
+typedef void (* knx_pipeline_handler)(void* data, const knx_pipeline_event* event);
+
+/**
+ * Datapoint type lookup (may be `NULL`). It runs on the worker threads.
+ *
+ * \returns `true` if the destination has a known datapoint type
+ */
+typedef bool (* knx_pipeline_resolver)(void* data, knx_addr destination, knx_dpt* type);
+
+/**
+ * Raw Frame Slot
+ */
+typedef struct {
+	uint16_t length;
+	uint8_t  frame[KNX_PIPELINE_FRAME_SIZE];
+} knx_pipeline_slot;
+
+typedef struct _knx_pipeline knx_pipeline;
+
+/**
+ * Decode Worker
+ *
+ * Owns a single-producer single-consumer ring of raw frames and a thread which decodes them.
+ */
+typedef struct {
+	knx_pipeline* pipeline;
+	size_t        index;
+	pthread_t     thread;
+
+	knx_pipeline_slot* slots;
+	knx_spsc_index     ring;
+
+	/**
+	 * Set while the worker waits for frames
+	 */
+	int sleeping KNX_CACHE_ALIGNED;
+
+	pthread_mutex_t lock;
+	pthread_cond_t  wakeup;
+} knx_pipeline_worker;
+
+/**
+ * Sharded Decode Pipeline
+ *
+ * The I/O thread classifies each raw frame with `knx_classify`, which only peeks at a few
+ * octets, and hands it to the worker selected by hashing the L_Data destination. Workers run
+ * the full parse and datapoint decoding. Frames for one destination always go to the same worker
+ * and are decoded in arrival order, so writes to one group address never reorder.
+ *
+ * Frames must be pushed from a single thread.
+ */
+struct _knx_pipeline {
+	size_t num_workers;
+	bool   running;
+
+	knx_pipeline_handler  handler;
+	knx_pipeline_resolver resolver;
+	void*                 data;
+
+	knx_pipeline_worker workers[KNX_PIPELINE_MAX_WORKERS];
+};
+
+/**
+ * Allocate the rings and start the workers.
+ *
+ * \param pipeline    Pipeline
+ * \param num_workers Number of worker threads (at most `KNX_PIPELINE_MAX_WORKERS`)
+ * \param capacity    Number of frames each worker can buffer (rounded up to a power of 2)
+ * \param handler     Handler for decoded frames
+ * \param resolver    Datapoint type lookup (may be `NULL`)
+ * \param data        User data for `handler` and `resolver`
+ * \returns `true` on success, otherwise `false`
+ */
+bool knx_pipeline_start(
+	knx_pipeline*         pipeline,
+	size_t                num_workers,
+	size_t                capacity,
+	knx_pipeline_handler  handler,
+	knx_pipeline_resolver resolver,
+	void*                 data
+);
+
+/**
+ * Decode the remaining frames, stop the workers and free the rings.
+ */
+void knx_pipeline_stop(knx_pipeline* pipeline);
+
+/**
+ * Select the worker responsible for a destination address.
+ */
+inline static
+size_t knx_pipeline_select(const knx_pipeline* pipeline, knx_addr destination) {
+	return knx_addr_bucket(destination, pipeline->num_workers);
+}
+
+/**
+ * Hand a raw tunnel request or routing indication to its worker.
+ *
+ * \returns `true` if the frame has been queued, `false` if it carries no L_Data frame, is too
+ *          large or the worker's ring is full
+ */
+bool knx_pipeline_push(knx_pipeline* pipeline, const uint8_t* frame, size_t length);
+
+/**
+ * Hand a batch of raw frames to their workers. Each worker is woken up at most once.
+ *
+ * \returns Number of queued frames
+ */
+size_t knx_pipeline_push_batch(knx_pipeline* pipeline, const knx_datagram* datagrams, size_t count);
+
+#endif
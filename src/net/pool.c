@@ -0,0 +1,216 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "pool.h"
+
+static
+void knx_tunnel_pool_state_changed(void* data, knx_tunnel_client* client, knx_tunnel_state state) {
+	knx_tunnel_pool* pool = data;
+
+	if (state == KNX_TUNNEL_CONNECTED || state == KNX_TUNNEL_DISCONNECTED)
+		pool->stale = true;
+
+	// Continue with the next connection, or retry after a failure
+	if (pool->active && state == KNX_TUNNEL_CONNECTED)
+		knx_timer_schedule(pool->wheel, &pool->connect_timer, 0);
+	else if (pool->active && state == KNX_TUNNEL_DISCONNECTED)
+		knx_timer_schedule(pool->wheel, &pool->connect_timer, pool->reconnect_delay);
+
+	if (pool->handlers.state_changed)
+		pool->handlers.state_changed(pool->data, client, state);
+}
+
+static
+void knx_tunnel_pool_received(void* data, knx_tunnel_client* client, const knx_cemi* cemi) {
+	knx_tunnel_pool* pool = data;
+
+	if (pool->handlers.received)
+		pool->handlers.received(pool->data, client, cemi);
+}
+
+static
+void knx_tunnel_pool_connect_next(knx_tunnel_pool* pool) {
+	knx_tunnel_client* next = NULL;
+
+	for (size_t i = 0; i < pool->size; i++) {
+		if (pool->clients[i].state == KNX_TUNNEL_CONNECTING)
+			return;
+
+		if (!next && pool->clients[i].state == KNX_TUNNEL_DISCONNECTED)
+			next = &pool->clients[i];
+	}
+
+	if (next && !knx_tunnel_client_connect(next))
+		knx_timer_schedule(pool->wheel, &pool->connect_timer, pool->reconnect_delay);
+}
+
+static
+void knx_tunnel_pool_connect_timeout(knx_timer* timer, void* data) {
+	knx_tunnel_pool* pool = data;
+	(void) timer;
+
+	if (pool->active)
+		knx_tunnel_pool_connect_next(pool);
+}
+
+bool knx_tunnel_pool_init(
+	knx_tunnel_pool*           pool,
+	size_t                     size,
+	knx_transport*             transport,
+	knx_timer_wheel*           wheel,
+	const struct sockaddr_in*  gateway,
+	const knx_tunnel_handlers* handlers,
+	void*                      data
+) {
+	if (size == 0 || size > KNX_TUNNEL_POOL_SIZE)
+		return false;
+
+	pool->size = size;
+	pool->wheel = wheel;
+	pool->handlers = *handlers;
+	pool->data = data;
+	pool->reconnect_delay = 5000;
+	pool->active = false;
+	pool->stale = false;
+	pool->num_routes = 0;
+	pool->num_old_routes = 0;
+	pool->drained = 0;
+
+	knx_timer_init(&pool->connect_timer, knx_tunnel_pool_connect_timeout, pool);
+
+	knx_tunnel_handlers forward = {knx_tunnel_pool_state_changed, knx_tunnel_pool_received};
+
+	// Reconnects are coordinated by the pool, so the clients' own reconnect timers stay unused
+	for (size_t i = 0; i < size; i++)
+		knx_tunnel_client_init(&pool->clients[i], transport, wheel, gateway, &forward, pool);
+
+	return true;
+}
+
+void knx_tunnel_pool_destroy(knx_tunnel_pool* pool) {
+	knx_timer_cancel(&pool->connect_timer);
+
+	for (size_t i = 0; i < pool->size; i++)
+		knx_tunnel_client_destroy(&pool->clients[i]);
+}
+
+void knx_tunnel_pool_connect(knx_tunnel_pool* pool) {
+	pool->active = true;
+	knx_tunnel_pool_connect_next(pool);
+}
+
+void knx_tunnel_pool_disconnect(knx_tunnel_pool* pool) {
+	pool->active = false;
+	knx_timer_cancel(&pool->connect_timer);
+
+	for (size_t i = 0; i < pool->size; i++)
+		knx_tunnel_client_disconnect(&pool->clients[i]);
+}
+
+size_t knx_tunnel_pool_connected(const knx_tunnel_pool* pool) {
+	size_t count = 0;
+
+	for (size_t i = 0; i < pool->size; i++)
+		count += pool->clients[i].state == KNX_TUNNEL_CONNECTED;
+
+	return count;
+}
+
+// Finish a pending change once every previous connection has drained, then apply the next one
+static
+void knx_tunnel_pool_update_routes(knx_tunnel_pool* pool) {
+	if (pool->num_old_routes > 0) {
+		for (size_t i = 0; i < pool->num_old_routes; i++) {
+			size_t index = pool->old_routes[i];
+
+			if (pool->clients[index].queue_count == 0)
+				pool->drained |= 1u << index;
+			else if (!(pool->drained & (1u << index)))
+				return;
+		}
+
+		pool->num_old_routes = 0;
+	}
+
+	if (!pool->stale)
+		return;
+
+	bool pending = false;
+
+	for (size_t i = 0; i < pool->num_routes; i++) {
+		pool->old_routes[i] = pool->routes[i];
+		pending |= pool->clients[pool->routes[i]].queue_count > 0;
+	}
+
+	pool->num_old_routes = pending ? pool->num_routes : 0;
+	pool->drained = 0;
+	pool->num_routes = 0;
+
+	for (size_t i = 0; i < pool->size; i++) {
+		if (pool->clients[i].state == KNX_TUNNEL_CONNECTED)
+			pool->routes[pool->num_routes++] = i;
+	}
+
+	pool->stale = false;
+}
+
+knx_tunnel_client* knx_tunnel_pool_select(knx_tunnel_pool* pool, knx_addr destination) {
+	knx_tunnel_pool_update_routes(pool);
+
+	if (pool->num_routes == 0)
+		return NULL;
+
+	size_t index = pool->routes[knx_addr_bucket(destination, pool->num_routes)];
+
+	// Stay with the previous connection while it still has frames that could be overtaken
+	if (pool->num_old_routes > 0) {
+		size_t old_index = pool->old_routes[knx_addr_bucket(destination, pool->num_old_routes)];
+
+		if (old_index != index && !(pool->drained & (1u << old_index))) {
+			if (pool->clients[old_index].queue_count > 0)
+				return &pool->clients[old_index];
+
+			pool->drained |= 1u << old_index;
+		}
+	}
+
+	return &pool->clients[index];
+}
+
+bool knx_tunnel_pool_send(knx_tunnel_pool* pool, const knx_cemi* cemi) {
+	// Every cEMI service is an L_Data service
+	knx_tunnel_client* client = knx_tunnel_pool_select(pool, cemi->payload.ldata.destination);
+
+	// Frames queued on a connection that is not established might never leave
+	if (!client || client->state != KNX_TUNNEL_CONNECTED)
+		return false;
+
+	return knx_tunnel_client_send(client, cemi);
+}
+
+bool knx_tunnel_pool_handle(knx_tunnel_pool* pool, const knx_packet* packet) {
+	for (size_t i = 0; i < pool->size; i++) {
+		if (knx_tunnel_client_handle(&pool->clients[i], packet))
+			return true;
+	}
+
+	return false;
+}
@@ -0,0 +1,157 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_NET_POOL_H_
+#define KNXPROTO_NET_POOL_H_
+
+#include "tunnel.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Maximum number of tunnel connections in a pool
+ */
+#define KNX_TUNNEL_POOL_SIZE 8
+
+/**
+ * Tunnel Connection Pool
+ *
+ * Opens several tunnel connections to the same gateway. Each connection permits one
+ * unacknowledged tunnel request, so the write rate scales with the number of connections.
+ *
+ * Outgoing frames are assigned to established connections by hashing their destination address.
+ * All frames for one destination therefore travel through the same connection and cannot overtake
+ * each other. When connections are established or lost, destinations are hashed over the new set
+ * of connections, but a destination only moves once the queue of its previous connection has
+ * drained. Gateways which offer fewer tunnel slots than `size` thus still use every slot they
+ * accept.
+ *
+ * Connection responses carry no request identifier, hence only one connection is established at
+ * a time.
+ */
+typedef struct {
+	size_t size;
+
+	knx_timer_wheel*    wheel;
+	knx_tunnel_handlers handlers;
+	void*               data;
+
+	/**
+	 * Delay before reconnecting a lost connection
+	 */
+	uint32_t reconnect_delay;
+
+	/**
+	 * Connections are (re-)established while this is set
+	 */
+	bool active;
+
+	knx_timer connect_timer;
+
+	/**
+	 * Set when a connection has been established or lost since `routes` was computed
+	 */
+	bool stale;
+
+	/**
+	 * Indices of the connections destinations are hashed over
+	 */
+	uint8_t routes[KNX_TUNNEL_POOL_SIZE];
+	size_t  num_routes;
+
+	/**
+	 * Routes before the last change, kept until the connections they point to have drained
+	 * (`num_old_routes` is `0` if there is no change in progress)
+	 */
+	uint8_t  old_routes[KNX_TUNNEL_POOL_SIZE];
+	size_t   num_old_routes;
+	uint32_t drained;
+
+	knx_tunnel_client clients[KNX_TUNNEL_POOL_SIZE];
+} knx_tunnel_pool;
+
+/**
+ * Initialize the pool.
+ *
+ * \param pool      Pool
+ * \param size      Number of connections (at most `KNX_TUNNEL_POOL_SIZE`)
+ * \param transport Transport used for outgoing frames
+ * \param wheel     Timer wheel driving the timeouts
+ * \param gateway   Gateway address
+ * \param handlers  Event handlers, they receive the individual connection as `client`
+ * \param data      User data for the handlers
+ * \returns `true` on success, `false` if `size` is out of range
+ */
+bool knx_tunnel_pool_init(
+	knx_tunnel_pool*           pool,
+	size_t                     size,
+	knx_transport*             transport,
+	knx_timer_wheel*           wheel,
+	const struct sockaddr_in*  gateway,
+	const knx_tunnel_handlers* handlers,
+	void*                      data
+);
+
+/**
+ * Cancel all timers.
+ */
+void knx_tunnel_pool_destroy(knx_tunnel_pool* pool);
+
+/**
+ * Start establishing the connections one after another.
+ */
+void knx_tunnel_pool_connect(knx_tunnel_pool* pool);
+
+/**
+ * Disconnect all connections.
+ */
+void knx_tunnel_pool_disconnect(knx_tunnel_pool* pool);
+
+/**
+ * Number of established connections
+ */
+size_t knx_tunnel_pool_connected(const knx_tunnel_pool* pool);
+
+/**
+ * Select the connection responsible for a destination address.
+ *
+ * \returns Connection or `NULL` if none has been established yet
+ */
+knx_tunnel_client* knx_tunnel_pool_select(knx_tunnel_pool* pool, knx_addr destination);
+
+/**
+ * Queue a cEMI frame on the connection responsible for its destination.
+ *
+ * \returns `true` if the frame has been queued, `false` if the responsible connection is not
+ *          established or its queue is full
+ */
+bool knx_tunnel_pool_send(knx_tunnel_pool* pool, const knx_cemi* cemi);
+
+/**
+ * Process a packet which has been received from the gateway.
+ *
+ * \returns `true` if the packet belonged to one of the connections
+ */
+bool knx_tunnel_pool_handle(knx_tunnel_pool* pool, const knx_packet* packet);
+
+#endif
@@ -0,0 +1,238 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "reactor.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+
+static
+void knx_reactor_link(knx_reactor* reactor, knx_reactor_session* session) {
+	session->reactor = reactor;
+	session->prev = NULL;
+	session->next = reactor->sessions;
+
+	if (reactor->sessions)
+		reactor->sessions->prev = session;
+
+	reactor->sessions = session;
+	reactor->num_sessions++;
+}
+
+static
+void knx_reactor_unlink(knx_reactor* reactor, knx_reactor_session* session) {
+	if (session->prev)
+		session->prev->next = session->next;
+	else
+		reactor->sessions = session->next;
+
+	if (session->next)
+		session->next->prev = session->prev;
+
+	reactor->num_sessions--;
+}
+
+static
+bool knx_reactor_watch(knx_reactor* reactor, knx_reactor_session* session) {
+	struct epoll_event event = {
+		.events = EPOLLIN | EPOLLET,
+		.data = {.ptr = session}
+	};
+
+	return epoll_ctl(reactor->epoll, EPOLL_CTL_ADD, session->transport.sock, &event) == 0;
+}
+
+static
+void knx_reactor_handle(
+	void*                     data,
+	const struct sockaddr_in* sender,
+	const uint8_t*            frame,
+	size_t                    length,
+	const knx_packet*         packet
+) {
+	knx_reactor_session* session = data;
+	(void) sender;
+	(void) frame;
+	(void) length;
+
+	if (!packet)
+		return;
+
+	if (session->routing)
+		knx_routing_engine_handle(&session->link.routing, packet);
+	else
+		knx_tunnel_client_handle(&session->link.tunnel, packet);
+}
+
+bool knx_reactor_init(knx_reactor* reactor) {
+	reactor->epoll = epoll_create1(EPOLL_CLOEXEC);
+	if (reactor->epoll < 0)
+		return false;
+
+	knx_timer_wheel_init(&reactor->wheel, knx_timer_now(), KNX_REACTOR_RESOLUTION);
+
+	reactor->sessions = NULL;
+	reactor->num_sessions = 0;
+
+	return true;
+}
+
+void knx_reactor_destroy(knx_reactor* reactor) {
+	while (reactor->sessions)
+		knx_reactor_remove(reactor, reactor->sessions);
+
+	close(reactor->epoll);
+	reactor->epoll = -1;
+}
+
+bool knx_reactor_add_tunnel(
+	knx_reactor*               reactor,
+	knx_reactor_session*       session,
+	const struct sockaddr_in*  gateway,
+	const knx_tunnel_handlers* handlers,
+	void*                      data
+) {
+	if (!knx_transport_init(&session->transport, NULL))
+		return false;
+
+	if (!knx_reactor_watch(reactor, session)) {
+		knx_transport_destroy(&session->transport);
+		return false;
+	}
+
+	session->routing = false;
+	knx_tunnel_client_init(
+		&session->link.tunnel,
+		&session->transport,
+		&reactor->wheel,
+		gateway,
+		handlers,
+		data
+	);
+
+	session->link.tunnel.reconnect_delay = KNX_REACTOR_RECONNECT_DELAY;
+
+	if (!knx_tunnel_client_connect(&session->link.tunnel)) {
+		knx_tunnel_client_destroy(&session->link.tunnel);
+		epoll_ctl(reactor->epoll, EPOLL_CTL_DEL, session->transport.sock, NULL);
+		knx_transport_destroy(&session->transport);
+		return false;
+	}
+
+	knx_reactor_link(reactor, session);
+	return true;
+}
+
+bool knx_reactor_add_routing(
+	knx_reactor*              reactor,
+	knx_reactor_session*      session,
+	const struct sockaddr_in* local,
+	in_addr_t                 interface,
+	knx_routing_handler       handler,
+	void*                     data
+) {
+	if (!knx_transport_init(&session->transport, local))
+		return false;
+
+	if (!knx_transport_join(&session->transport, htonl(KNX_ROUTING_MULTICAST_ADDRESS), interface) ||
+	    !knx_reactor_watch(reactor, session)) {
+		knx_transport_destroy(&session->transport);
+		return false;
+	}
+
+	session->routing = true;
+	knx_routing_engine_init(
+		&session->link.routing,
+		&session->transport,
+		&reactor->wheel,
+		NULL,
+		handler,
+		data
+	);
+
+	knx_reactor_link(reactor, session);
+	return true;
+}
+
+void knx_reactor_remove(knx_reactor* reactor, knx_reactor_session* session) {
+	if (session->routing) {
+		knx_routing_engine_destroy(&session->link.routing);
+	} else {
+		knx_tunnel_client_disconnect(&session->link.tunnel);
+		knx_tunnel_client_destroy(&session->link.tunnel);
+	}
+
+	// Best effort, the disconnect request cannot be repeated anymore
+	knx_transport_flush(&session->transport);
+
+	epoll_ctl(reactor->epoll, EPOLL_CTL_DEL, session->transport.sock, NULL);
+	knx_transport_destroy(&session->transport);
+
+	knx_reactor_unlink(reactor, session);
+}
+
+bool knx_reactor_send(knx_reactor_session* session, const knx_cemi* cemi) {
+	if (session->routing)
+		return knx_routing_engine_send(&session->link.routing, cemi);
+	else
+		return knx_tunnel_client_send(&session->link.tunnel, cemi);
+}
+
+int knx_reactor_run_once(knx_reactor* reactor, int max_wait) {
+	int timeout = knx_timer_wheel_timeout(&reactor->wheel);
+
+	if (max_wait >= 0 && (timeout < 0 || timeout > max_wait))
+		timeout = max_wait;
+
+	struct epoll_event events[KNX_REACTOR_EVENTS];
+	int count = epoll_wait(reactor->epoll, events, KNX_REACTOR_EVENTS, timeout);
+
+	if (count < 0) {
+		if (errno != EINTR)
+			return -1;
+
+		count = 0;
+	}
+
+	knx_timer_wheel_advance(&reactor->wheel, knx_timer_now());
+
+	// Edge-triggered readiness is only reported once, so each socket is drained completely. A
+	// short read means the receive queue was empty. Dropped datagrams count towards the read, a
+	// dispatch may return fewer datagrams while more are pending.
+	for (int i = 0; i < count; i++) {
+		knx_reactor_session* session = events[i].data.ptr;
+		ssize_t received;
+
+		do {
+			received = knx_transport_dispatch(&session->transport, knx_reactor_handle, session);
+		} while (received > 0 && session->transport.rx_read == KNX_TRANSPORT_BATCH);
+	}
+
+	// Frames queued by handlers and timers leave with one system call per session
+	for (knx_reactor_session* session = reactor->sessions; session; session = session->next) {
+		if (session->transport.tx_count > 0)
+			knx_transport_flush(&session->transport);
+	}
+
+	return count;
+}
@@ -0,0 +1,166 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_NET_REACTOR_H_
+#define KNXPROTO_NET_REACTOR_H_
+
+#include "transport.h"
+#include "tunnel.h"
+#include "routing.h"
+#include "../util/timerwheel.h"
+
+#include <netinet/in.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Maximum number of readiness events processed per iteration
+ */
+#define KNX_REACTOR_EVENTS 64
+
+/**
+ * Resolution of the reactor's timer wheel in milliseconds
+ */
+#define KNX_REACTOR_RESOLUTION 10
+
+/**
+ * Delay in milliseconds before a tunnel session reconnects after its connection was lost
+ */
+#define KNX_REACTOR_RECONNECT_DELAY 5000
+
+typedef struct _knx_reactor knx_reactor;
+typedef struct _knx_reactor_session knx_reactor_session;
+
+/**
+ * Reactor Session
+ *
+ * A tunnel connection or routing participant with its own socket. The storage is provided by the
+ * user and must stay in place while the session is part of a reactor.
+ */
+struct _knx_reactor_session {
+	knx_reactor*         reactor;
+	knx_reactor_session* next;
+	knx_reactor_session* prev;
+
+	knx_transport transport;
+
+	/**
+	 * Whether this is a routing session
+	 */
+	bool routing;
+
+	union {
+		knx_tunnel_client  tunnel;
+		knx_routing_engine routing;
+	} link;
+};
+
+/**
+ * Single-threaded Reactor
+ *
+ * Multiplexes any number of sessions on one epoll instance. Sockets are registered
+ * edge-triggered and drained in batches when they become readable. All session timers share one
+ * timer wheel, and every outgoing frame queued during an iteration is flushed at its end.
+ */
+struct _knx_reactor {
+	int epoll;
+
+	knx_timer_wheel wheel;
+
+	knx_reactor_session* sessions;
+	size_t               num_sessions;
+};
+
+/**
+ * Create the epoll instance.
+ *
+ * \returns `true` on success, otherwise `false` (`errno` indicates the error)
+ */
+bool knx_reactor_init(knx_reactor* reactor);
+
+/**
+ * Remove all sessions and close the epoll instance.
+ */
+void knx_reactor_destroy(knx_reactor* reactor);
+
+/**
+ * Add a tunnel session and start connecting to the gateway. Lost connections are re-established
+ * after `KNX_REACTOR_RECONNECT_DELAY`.
+ *
+ * \param reactor  Reactor
+ * \param session  Uninitialized session
+ * \param gateway  Gateway address
+ * \param handlers Event handlers
+ * \param data     User data for the handlers
+ * \returns `true` on success, `false` if the socket could not be set up or the connection
+ *          request could not be queued
+ */
+bool knx_reactor_add_tunnel(
+	knx_reactor*               reactor,
+	knx_reactor_session*       session,
+	const struct sockaddr_in*  gateway,
+	const knx_tunnel_handlers* handlers,
+	void*                      data
+);
+
+/**
+ * Add a routing session. Its socket is bound to `local` and joins the routing multicast group.
+ *
+ * \param reactor   Reactor
+ * \param session   Uninitialized session
+ * \param local     Local address (usually `INADDR_ANY` and `KNX_ROUTING_PORT`)
+ * \param interface Interface used for the multicast membership in network byte order
+ * \param handler   Handler for incoming routing indications
+ * \param data      User data for the handler
+ * \returns `true` on success, otherwise `false`
+ */
+bool knx_reactor_add_routing(
+	knx_reactor*              reactor,
+	knx_reactor_session*      session,
+	const struct sockaddr_in* local,
+	in_addr_t                 interface,
+	knx_routing_handler       handler,
+	void*                     data
+);
+
+/**
+ * Remove a session. Tunnel sessions send a disconnect request before the socket is closed.
+ */
+void knx_reactor_remove(knx_reactor* reactor, knx_reactor_session* session);
+
+/**
+ * Queue a cEMI frame on the session.
+ *
+ * \returns `true` if the frame has been queued
+ */
+bool knx_reactor_send(knx_reactor_session* session, const knx_cemi* cemi);
+
+/**
+ * Wait for readiness or the next timer, process all ready sessions and expired timers and flush
+ * outgoing frames.
+ *
+ * \param reactor  Reactor
+ * \param max_wait Upper bound for the time to wait in milliseconds (`-1` for no bound)
+ * \returns Number of processed readiness events or `-1` on error
+ */
+int knx_reactor_run_once(knx_reactor* reactor, int max_wait);
+
+#endif
@@ -0,0 +1,221 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "routing.h"
+
+#include <arpa/inet.h>
+
+static
+uint32_t knx_routing_engine_random(knx_routing_engine* engine) {
+	// xorshift32
+	uint32_t x = engine->random;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+
+	return engine->random = x;
+}
+
+static
+void knx_routing_engine_refill(knx_routing_engine* engine, uint64_t now) {
+	uint64_t capacity = (uint64_t) engine->burst * 1000;
+
+	engine->tokens += (now - engine->refilled) * engine->rate;
+	engine->refilled = now;
+
+	if (engine->tokens > capacity)
+		engine->tokens = capacity;
+}
+
+// Once no routing busy arrived for N * 100ms, N is decremented every 5ms.
+static
+void knx_routing_engine_decay(knx_routing_engine* engine, uint64_t now) {
+	if (engine->busy_count == 0)
+		return;
+
+	uint64_t slow_end = engine->last_busy + engine->busy_count * 100;
+	if (now <= slow_end)
+		return;
+
+	uint64_t steps = (now - slow_end) / 5;
+
+	if (steps >= engine->busy_count) {
+		engine->busy_count = 0;
+	} else if (steps > 0) {
+		engine->busy_count -= steps;
+		engine->last_busy = now - engine->busy_count * 100;
+	}
+}
+
+static
+void knx_routing_engine_pump(knx_routing_engine* engine) {
+	uint64_t now = engine->wheel->now;
+
+	knx_routing_engine_refill(engine, now);
+
+	while (engine->queue_count > 0 && now >= engine->paused_until && engine->tokens >= 1000) {
+		if (!knx_transport_queue_copy(
+			engine->transport,
+			&engine->group,
+			engine->queue[engine->queue_head].frame,
+			engine->queue[engine->queue_head].length
+		))
+			break;
+
+		engine->queue_head = (engine->queue_head + 1) % KNX_ROUTING_QUEUE_SIZE;
+		engine->queue_count--;
+		engine->tokens -= 1000;
+	}
+
+	if (engine->queue_count == 0) {
+		knx_timer_cancel(&engine->pump_timer);
+		return;
+	}
+
+	// Wake up once the next frame may leave
+	uint64_t delay;
+
+	if (now < engine->paused_until)
+		delay = engine->paused_until - now;
+	else if (engine->tokens < 1000)
+		delay = (1000 - engine->tokens + engine->rate - 1) / engine->rate;
+	else
+		delay = engine->wheel->resolution;
+
+	knx_timer_schedule(engine->wheel, &engine->pump_timer, delay);
+}
+
+static
+void knx_routing_engine_pump_timeout(knx_timer* timer, void* data) {
+	(void) timer;
+	knx_routing_engine_pump(data);
+}
+
+void knx_routing_engine_init(
+	knx_routing_engine*       engine,
+	knx_transport*            transport,
+	knx_timer_wheel*          wheel,
+	const struct sockaddr_in* group,
+	knx_routing_handler       handler,
+	void*                     data
+) {
+	engine->transport = transport;
+	engine->wheel = wheel;
+
+	if (group) {
+		engine->group = *group;
+	} else {
+		engine->group.sin_family = AF_INET;
+		engine->group.sin_addr.s_addr = htonl(KNX_ROUTING_MULTICAST_ADDRESS);
+		engine->group.sin_port = htons(KNX_ROUTING_PORT);
+	}
+
+	engine->handler = handler;
+	engine->data = data;
+
+	engine->rate = KNX_ROUTING_RATE;
+	engine->burst = KNX_ROUTING_BURST;
+	engine->tokens = (uint64_t) engine->burst * 1000;
+	engine->refilled = wheel->now;
+
+	engine->paused_until = 0;
+	engine->last_busy = 0;
+	engine->busy_count = 0;
+	engine->lost_messages = 0;
+
+	engine->random = (uint32_t) (knx_timer_now() ^ (uintptr_t) engine) | 1;
+	knx_timer_init(&engine->pump_timer, knx_routing_engine_pump_timeout, engine);
+
+	engine->queue_head = 0;
+	engine->queue_count = 0;
+}
+
+void knx_routing_engine_destroy(knx_routing_engine* engine) {
+	knx_timer_cancel(&engine->pump_timer);
+	engine->queue_count = 0;
+}
+
+bool knx_routing_engine_send(knx_routing_engine* engine, const knx_cemi* cemi) {
+	if (engine->queue_count >= KNX_ROUTING_QUEUE_SIZE)
+		return false;
+
+	size_t slot = (engine->queue_head + engine->queue_count) % KNX_ROUTING_QUEUE_SIZE;
+	knx_routing_indication ind = {*cemi};
+
+	ssize_t length = knx_generate_bounded(
+		engine->queue[slot].frame,
+		KNX_ROUTING_FRAME_SIZE,
+		KNX_ROUTING_INDICATION,
+		&ind
+	);
+
+	if (length < 0)
+		return false;
+
+	engine->queue[slot].length = length;
+	engine->queue_count++;
+
+	knx_routing_engine_pump(engine);
+	return true;
+}
+
+static
+void knx_routing_engine_busy(knx_routing_engine* engine, const knx_routing_busy* busy) {
+	uint64_t now = engine->wheel->now;
+
+	knx_routing_engine_decay(engine, now);
+
+	// Announcements within 10ms of each other count as one
+	if (engine->busy_count == 0 || now >= engine->last_busy + 10)
+		engine->busy_count++;
+
+	engine->last_busy = now;
+
+	// Random back-off spreads the participants' resumption over N * 50ms
+	uint64_t backoff = knx_routing_engine_random(engine) % (engine->busy_count * 50 + 1);
+	uint64_t until = now + busy->wait_time + backoff;
+
+	if (until > engine->paused_until)
+		engine->paused_until = until;
+
+	knx_routing_engine_pump(engine);
+}
+
+bool knx_routing_engine_handle(knx_routing_engine* engine, const knx_packet* packet) {
+	switch (packet->service) {
+		case KNX_ROUTING_INDICATION:
+			if (engine->handler)
+				engine->handler(engine->data, engine, &packet->payload.routing_ind.data);
+
+			return true;
+
+		case KNX_ROUTING_BUSY:
+			knx_routing_engine_busy(engine, &packet->payload.routing_busy);
+			return true;
+
+		case KNX_ROUTING_LOST_MESSAGE:
+			engine->lost_messages += packet->payload.routing_lost.lost_messages;
+			return true;
+
+		default:
+			return false;
+	}
+}
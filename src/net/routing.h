@@ -0,0 +1,190 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_NET_ROUTING_H_
+#define KNXPROTO_NET_ROUTING_H_
+
+#include "transport.h"
+#include "../proto/proto.h"
+#include "../util/timerwheel.h"
+
+#include <netinet/in.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Routing multicast group 224.0.23.12 (host byte order)
+ */
+#define KNX_ROUTING_MULTICAST_ADDRESS 0xE000170C
+
+/**
+ * Routing port
+ */
+#define KNX_ROUTING_PORT 3671
+
+/**
+ * Maximum number of routing indications per second a participant may send
+ */
+#define KNX_ROUTING_RATE 50
+
+/**
+ * Default number of routing indications that may be sent back-to-back
+ */
+#define KNX_ROUTING_BURST 10
+
+/**
+ * Number of outgoing frames that can be queued
+ */
+#define KNX_ROUTING_QUEUE_SIZE 64
+
+/**
+ * Maximum size of a queued routing indication frame
+ */
+#define KNX_ROUTING_FRAME_SIZE (KNX_HEADER_SIZE + 256)
+
+typedef struct _knx_routing_engine knx_routing_engine;
+
+/**
+ * Handler for incoming routing indications
+ */
+typedef void (* knx_routing_handler)(void* data, knx_routing_engine* engine, const knx_cemi* cemi);
+
+/**
+ * Routing Engine
+ *
+ * Sends routing indications to the multicast group and implements the flow control mandated for
+ * routing participants. Output is paced by a token bucket at `rate` frames per second. When a
+ * router announces that it is busy, sending stops for the announced wait time plus a random
+ * delay that grows with the number of consecutive busy announcements.
+ *
+ * Like the tunnelling client, the engine does not own a socket or a clock. The transport should
+ * be bound to `KNX_ROUTING_PORT` and joined to the multicast group.
+ */
+struct _knx_routing_engine {
+	knx_transport*     transport;
+	knx_timer_wheel*   wheel;
+	struct sockaddr_in group;
+
+	knx_routing_handler handler;
+	void*               data;
+
+	/**
+	 * Frames per second
+	 */
+	uint32_t rate;
+
+	/**
+	 * Bucket capacity in frames
+	 */
+	uint32_t burst;
+
+	/**
+	 * Available tokens in thousandths of a frame
+	 */
+	uint64_t tokens;
+
+	/**
+	 * Time of the last refill
+	 */
+	uint64_t refilled;
+
+	/**
+	 * Sending is paused until this time
+	 */
+	uint64_t paused_until;
+
+	/**
+	 * Time of the last routing busy
+	 */
+	uint64_t last_busy;
+
+	/**
+	 * Number of consecutive routing busy announcements
+	 */
+	uint32_t busy_count;
+
+	/**
+	 * Sum of all messages other participants reported lost
+	 */
+	uint64_t lost_messages;
+
+	uint32_t  random;
+	knx_timer pump_timer;
+
+	size_t queue_head;
+	size_t queue_count;
+
+	struct {
+		uint16_t length;
+		uint8_t  frame[KNX_ROUTING_FRAME_SIZE];
+	} queue[KNX_ROUTING_QUEUE_SIZE];
+};
+
+/**
+ * Initialize the engine.
+ *
+ * \param engine    Engine
+ * \param transport Transport used for outgoing frames
+ * \param wheel     Timer wheel used for pacing
+ * \param group     Destination of outgoing frames (may be `NULL` for the routing multicast group)
+ * \param handler   Handler for incoming routing indications (may be `NULL`)
+ * \param data      User data for the handler
+ */
+void knx_routing_engine_init(
+	knx_routing_engine*       engine,
+	knx_transport*            transport,
+	knx_timer_wheel*          wheel,
+	const struct sockaddr_in* group,
+	knx_routing_handler       handler,
+	void*                     data
+);
+
+/**
+ * Cancel the pacing timer. Queued frames are discarded.
+ */
+void knx_routing_engine_destroy(knx_routing_engine* engine);
+
+/**
+ * Queue a cEMI frame. It is handed to the transport as soon as the rate limit and the busy state
+ * allow it.
+ *
+ * \returns `true` if the frame has been queued, `false` if the queue is full or the frame is
+ *          too large
+ */
+bool knx_routing_engine_send(knx_routing_engine* engine, const knx_cemi* cemi);
+
+/**
+ * Process a packet received on the multicast group.
+ *
+ * \returns `true` if the packet is a routing service, otherwise `false`
+ */
+bool knx_routing_engine_handle(knx_routing_engine* engine, const knx_packet* packet);
+
+/**
+ * Check whether sending is paused due to a routing busy.
+ */
+inline static
+bool knx_routing_engine_paused(const knx_routing_engine* engine) {
+	return engine->wheel->now < engine->paused_until;
+}
+
+#endif
@@ -0,0 +1,185 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "rxpool.h"
+#include "../util/alloc.h"
+
+#include <errno.h>
+#include <string.h>
+
+bool knx_rx_pool_init(knx_rx_pool* pool, size_t capacity) {
+	pool->buffers = newa(knx_rx_buffer, capacity);
+	if (!pool->buffers)
+		return false;
+
+	pool->capacity = capacity;
+	pool->free = NULL;
+	pool->returned = NULL;
+
+	for (size_t i = capacity; i > 0; i--) {
+		knx_rx_buffer* buffer = &pool->buffers[i - 1];
+
+		buffer->pool = pool;
+		buffer->refs = 0;
+		buffer->next = pool->free;
+		pool->free = buffer;
+	}
+
+	return true;
+}
+
+void knx_rx_pool_destroy(knx_rx_pool* pool) {
+	free(pool->buffers);
+
+	pool->buffers = NULL;
+	pool->free = NULL;
+	pool->returned = NULL;
+}
+
+knx_rx_buffer* knx_rx_pool_acquire(knx_rx_pool* pool) {
+	// Only the I/O thread takes from the return list and it takes all of it, hence no ABA
+	if (!pool->free)
+		pool->free = __atomic_exchange_n(&pool->returned, NULL, __ATOMIC_ACQUIRE);
+
+	knx_rx_buffer* buffer = pool->free;
+	if (!buffer)
+		return NULL;
+
+	pool->free = buffer->next;
+
+	buffer->next = NULL;
+	buffer->refs = 1;
+	buffer->length = 0;
+
+	return buffer;
+}
+
+void knx_rx_buffer_release(knx_rx_buffer* buffer) {
+	if (__atomic_fetch_sub(&buffer->refs, 1, __ATOMIC_ACQ_REL) != 1)
+		return;
+
+	knx_rx_pool* pool = buffer->pool;
+	knx_rx_buffer* head = __atomic_load_n(&pool->returned, __ATOMIC_RELAXED);
+
+	do {
+		buffer->next = head;
+	} while (!__atomic_compare_exchange_n(
+		&pool->returned,
+		&head,
+		buffer,
+		true,
+		__ATOMIC_RELEASE,
+		__ATOMIC_RELAXED
+	));
+}
+
+static
+void knx_rx_pool_put(knx_rx_pool* pool, knx_rx_buffer* buffer) {
+	buffer->refs = 0;
+	buffer->next = pool->free;
+	pool->free = buffer;
+}
+
+ssize_t knx_rx_pool_receive(
+	knx_rx_pool*    pool,
+	knx_transport*  transport,
+	knx_rx_buffer** buffers,
+	size_t          max
+) {
+	struct mmsghdr msgs[KNX_TRANSPORT_BATCH];
+	struct iovec iov[KNX_TRANSPORT_BATCH];
+	size_t kept;
+
+	if (max > KNX_TRANSPORT_BATCH)
+		max = KNX_TRANSPORT_BATCH;
+
+	do {
+		size_t acquired = 0;
+
+		for (; acquired < max; acquired++) {
+			knx_rx_buffer* buffer = knx_rx_pool_acquire(pool);
+			if (!buffer)
+				break;
+
+			buffers[acquired] = buffer;
+
+			iov[acquired].iov_base = buffer->data;
+			iov[acquired].iov_len = sizeof(buffer->data);
+
+			memset(&msgs[acquired], 0, sizeof(struct mmsghdr));
+			msgs[acquired].msg_hdr.msg_name = &buffer->sender;
+			msgs[acquired].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+			msgs[acquired].msg_hdr.msg_iov = &iov[acquired];
+			msgs[acquired].msg_hdr.msg_iovlen = 1;
+		}
+
+		if (acquired == 0)
+			return 0;
+
+		int count = recvmmsg(transport->sock, msgs, acquired, 0, NULL);
+		int error = errno;
+
+		kept = 0;
+
+		for (int i = 0; i < count; i++) {
+			// Datagrams that did not fit into a buffer are incomplete and would be misparsed
+			if (msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+				transport->rx_truncated++;
+				knx_rx_pool_put(pool, buffers[i]);
+				continue;
+			}
+
+			buffers[i]->length = msgs[i].msg_len;
+			buffers[kept++] = buffers[i];
+		}
+
+		// Put back what has not been filled
+		for (size_t i = count > 0 ? count : 0; i < acquired; i++)
+			knx_rx_pool_put(pool, buffers[i]);
+
+		if (count <= 0)
+			return count == 0 || error == EAGAIN || error == EWOULDBLOCK || error == EINTR ? 0 : -1;
+
+		// Only retry if the whole batch was dropped, otherwise 0 would signal an empty socket
+	} while (kept == 0);
+
+	return kept;
+}
+
+bool knx_rx_packet_parse(knx_rx_packet* rx_packet, knx_rx_buffer* buffer) {
+	if (knx_parse(buffer->data, buffer->length, &rx_packet->packet) <= 0)
+		return false;
+
+	rx_packet->buffer = knx_rx_buffer_retain(buffer);
+	return true;
+}
+
+void knx_rx_packet_release(knx_rx_packet* rx_packet) {
+	knx_packet* packet = &rx_packet->packet;
+
+	if (packet->service == KNX_DESCRIPTION_RESPONSE)
+		knx_description_response_free_services(&packet->payload.description_res);
+	else if (packet->service == KNX_SEARCH_RESPONSE)
+		knx_description_response_free_services(&packet->payload.search_res.description);
+
+	knx_rx_buffer_release(rx_packet->buffer);
+	rx_packet->buffer = NULL;
+}
@@ -0,0 +1,179 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_NET_RXPOOL_H_
+#define KNXPROTO_NET_RXPOOL_H_
+
+#include "transport.h"
+#include "../proto/proto.h"
+
+#include <netinet/in.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+typedef struct _knx_rx_pool knx_rx_pool;
+typedef struct _knx_rx_buffer knx_rx_buffer;
+
+/**
+ * Reference-counted Receive Buffer
+ */
+struct _knx_rx_buffer {
+	knx_rx_pool* pool;
+
+	/**
+	 * Number of references, modified atomically
+	 */
+	uint32_t refs;
+
+	/**
+	 * Next buffer in a free list
+	 */
+	knx_rx_buffer* next;
+
+	/**
+	 * Origin of the datagram
+	 */
+	struct sockaddr_in sender;
+
+	/**
+	 * Number of bytes in `data`
+	 */
+	size_t length;
+
+	uint8_t data[KNX_TRANSPORT_FRAME_SIZE];
+};
+
+/**
+ * Receive Buffer Pool
+ *
+ * Datagrams are received straight into pooled buffers. Every buffer carries a reference count,
+ * so packets parsed from it remain valid on any thread for as long as a reference is held. The
+ * last release returns the buffer to the pool.
+ *
+ * Buffers are acquired by a single I/O thread only. Releases from other threads are pushed onto
+ * a lock-free return list, which the I/O thread takes over as a whole once its own free list runs
+ * dry.
+ */
+struct _knx_rx_pool {
+	knx_rx_buffer* buffers;
+	size_t         capacity;
+
+	/**
+	 * Buffers available to the I/O thread
+	 */
+	knx_rx_buffer* free;
+
+	/**
+	 * Buffers released since the I/O thread last took them over
+	 */
+	knx_rx_buffer* returned;
+};
+
+/**
+ * Parsed Packet which Pins its Buffer
+ *
+ * All pointers within `packet` refer to `buffer`. The structure may be copied to other threads,
+ * each copy has to be released once.
+ */
+typedef struct {
+	knx_packet     packet;
+	knx_rx_buffer* buffer;
+} knx_rx_packet;
+
+/**
+ * Allocate the buffers.
+ *
+ * \param pool     Pool
+ * \param capacity Number of buffers
+ */
+bool knx_rx_pool_init(knx_rx_pool* pool, size_t capacity);
+
+/**
+ * Free the buffers. All references must have been released.
+ */
+void knx_rx_pool_destroy(knx_rx_pool* pool);
+
+/**
+ * Take a buffer with a reference count of 1 (I/O thread only).
+ *
+ * \returns Buffer or `NULL` if all buffers are in use
+ */
+knx_rx_buffer* knx_rx_pool_acquire(knx_rx_pool* pool);
+
+/**
+ * Receive a batch of datagrams from the transport's socket into pooled buffers (I/O thread
+ * only). The caller owns one reference to each returned buffer. Datagrams larger than a buffer
+ * are dropped and counted in the transport's `rx_truncated`.
+ *
+ * \param pool      Pool
+ * \param transport Transport whose socket is read
+ * \param buffers   Output buffers
+ * \param max       Capacity of `buffers` (at most `KNX_TRANSPORT_BATCH` are received)
+ * \returns Number of received datagrams, `0` if none are pending or no buffer is available,
+ *          `-1` on error
+ */
+ssize_t knx_rx_pool_receive(
+	knx_rx_pool*    pool,
+	knx_transport*  transport,
+	knx_rx_buffer** buffers,
+	size_t          max
+);
+
+/**
+ * Add a reference (any thread).
+ */
+inline static
+knx_rx_buffer* knx_rx_buffer_retain(knx_rx_buffer* buffer) {
+	__atomic_fetch_add(&buffer->refs, 1, __ATOMIC_RELAXED);
+	return buffer;
+}
+
+/**
+ * Drop a reference (any thread). The last one returns the buffer to its pool.
+ */
+void knx_rx_buffer_release(knx_rx_buffer* buffer);
+
+/**
+ * Parse the datagram in a buffer. On success the packet holds its own reference to the buffer.
+ *
+ * \returns `true` if parsing was successful, otherwise `false`
+ */
+bool knx_rx_packet_parse(knx_rx_packet* rx_packet, knx_rx_buffer* buffer);
+
+/**
+ * Add a reference for a copy of the packet.
+ */
+inline static
+void knx_rx_packet_retain(knx_rx_packet* rx_packet) {
+	knx_rx_buffer_retain(rx_packet->buffer);
+}
+
+/**
+ * Release the packet's reference to its buffer.
+ *
+ * \note Description and search responses own a `services` array, which is freed here. Such
+ *       packets must not be retained.
+ */
+void knx_rx_packet_release(knx_rx_packet* rx_packet);
+
+#endif
@@ -0,0 +1,302 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "transport.h"
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+bool knx_transport_init(knx_transport* transport, const struct sockaddr_in* local) {
+	transport->sock = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_UDP);
+	if (transport->sock < 0)
+		return false;
+
+	// Multiple routing participants may share the same port on one host
+	int reuse = 1;
+	setsockopt(transport->sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+	struct sockaddr_in any = {
+		.sin_family = AF_INET,
+		.sin_addr = {INADDR_ANY},
+		.sin_port = 0
+	};
+
+	if (bind(transport->sock, (const struct sockaddr*) (local ? local : &any), sizeof(any)) != 0) {
+		int error = errno;
+		close(transport->sock);
+		errno = error;
+		return false;
+	}
+
+	// The message headers never change, except for the name and data lengths
+	memset(transport->rx_msgs, 0, sizeof(transport->rx_msgs));
+	memset(transport->tx_msgs, 0, sizeof(transport->tx_msgs));
+
+	for (size_t i = 0; i < KNX_TRANSPORT_BATCH; i++) {
+		transport->rx_iov[i].iov_base = transport->rx_buffers[i];
+		transport->rx_iov[i].iov_len = KNX_TRANSPORT_FRAME_SIZE;
+
+		transport->rx_msgs[i].msg_hdr.msg_name = &transport->rx_senders[i];
+		transport->rx_msgs[i].msg_hdr.msg_iov = &transport->rx_iov[i];
+		transport->rx_msgs[i].msg_hdr.msg_iovlen = 1;
+
+		transport->rx_datagrams[i].frame = transport->rx_buffers[i];
+		transport->rx_datagrams[i].length = 0;
+
+		transport->tx_msgs[i].msg_hdr.msg_name = &transport->tx_targets[i];
+		transport->tx_msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+		transport->tx_msgs[i].msg_hdr.msg_iov = &transport->tx_iov[i];
+		transport->tx_msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	transport->rx_count = 0;
+	transport->rx_read = 0;
+	transport->rx_truncated = 0;
+	transport->tx_count = 0;
+	transport->tx_dropped = 0;
+
+	return true;
+}
+
+void knx_transport_destroy(knx_transport* transport) {
+	if (transport->sock >= 0)
+		close(transport->sock);
+
+	transport->sock = -1;
+}
+
+bool knx_transport_join(knx_transport* transport, in_addr_t group, in_addr_t interface) {
+	struct ip_mreq request = {
+		.imr_multiaddr = {group},
+		.imr_interface = {interface}
+	};
+
+	return setsockopt(
+		transport->sock,
+		IPPROTO_IP,
+		IP_ADD_MEMBERSHIP,
+		&request,
+		sizeof(request)
+	) == 0;
+}
+
+bool knx_transport_local_address(const knx_transport* transport, struct sockaddr_in* local) {
+	socklen_t length = sizeof(struct sockaddr_in);
+	return getsockname(transport->sock, (struct sockaddr*) local, &length) == 0;
+}
+
+ssize_t knx_transport_poll(knx_transport* transport) {
+	size_t kept;
+
+	do {
+		for (size_t i = 0; i < KNX_TRANSPORT_BATCH; i++)
+			transport->rx_msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+
+		int count = recvmmsg(transport->sock, transport->rx_msgs, KNX_TRANSPORT_BATCH, 0, NULL);
+
+		if (count <= 0) {
+			transport->rx_count = 0;
+			transport->rx_read = 0;
+			return count == 0 || errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR ? 0 : -1;
+		}
+
+		transport->rx_read = count;
+		kept = 0;
+
+		for (int i = 0; i < count; i++) {
+			// Datagrams that did not fit into a slot are incomplete and would be misparsed
+			if (transport->rx_msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+				transport->rx_truncated++;
+				continue;
+			}
+
+			if (kept != (size_t) i)
+				transport->rx_senders[kept] = transport->rx_senders[i];
+
+			transport->rx_datagrams[kept].frame = transport->rx_buffers[i];
+			transport->rx_datagrams[kept].length = transport->rx_msgs[i].msg_len;
+			kept++;
+		}
+
+		// Only retry if the whole batch was dropped, otherwise 0 would signal an empty socket
+	} while (kept == 0);
+
+	transport->rx_count = kept;
+	return kept;
+}
+
+ssize_t knx_transport_dispatch(
+	knx_transport*        transport,
+	knx_transport_handler handler,
+	void*                 data
+) {
+	ssize_t count = knx_transport_poll(transport);
+
+	for (ssize_t i = 0; i < count; i++) {
+		const knx_datagram* datagram = &transport->rx_datagrams[i];
+
+		knx_packet packet;
+		bool valid = knx_parse(datagram->frame, datagram->length, &packet) > 0;
+
+		handler(
+			data,
+			&transport->rx_senders[i],
+			datagram->frame,
+			datagram->length,
+			valid ? &packet : NULL
+		);
+
+		// The packet does not outlive the handler
+		if (valid && packet.service == KNX_DESCRIPTION_RESPONSE)
+			knx_description_response_free_services(&packet.payload.description_res);
+		else if (valid && packet.service == KNX_SEARCH_RESPONSE)
+			knx_description_response_free_services(&packet.payload.search_res.description);
+	}
+
+	return count;
+}
+
+inline static
+bool knx_transport_make_room(knx_transport* transport) {
+	if (transport->tx_count < KNX_TRANSPORT_BATCH)
+		return true;
+
+	// A failed flush still frees the slot of the dropped frame
+	knx_transport_flush(transport);
+	return transport->tx_count < KNX_TRANSPORT_BATCH;
+}
+
+bool knx_transport_queue(
+	knx_transport*            transport,
+	const struct sockaddr_in* target,
+	knx_service               service,
+	const void*               payload
+) {
+	if (!knx_transport_make_room(transport))
+		return false;
+
+	size_t slot = transport->tx_count;
+
+	ssize_t length = knx_generate_bounded(
+		transport->tx_buffers[slot],
+		KNX_TRANSPORT_FRAME_SIZE,
+		service,
+		payload
+	);
+
+	if (length < 0)
+		return false;
+
+	transport->tx_targets[slot] = *target;
+	transport->tx_iov[slot].iov_base = transport->tx_buffers[slot];
+	transport->tx_iov[slot].iov_len = length;
+	transport->tx_count++;
+
+	return true;
+}
+
+bool knx_transport_queue_raw(
+	knx_transport*            transport,
+	const struct sockaddr_in* target,
+	const uint8_t*            frame,
+	size_t                    length
+) {
+	if (!knx_transport_make_room(transport))
+		return false;
+
+	size_t slot = transport->tx_count;
+
+	transport->tx_targets[slot] = *target;
+	transport->tx_iov[slot].iov_base = (void*) frame;
+	transport->tx_iov[slot].iov_len = length;
+	transport->tx_count++;
+
+	return true;
+}
+
+bool knx_transport_queue_copy(
+	knx_transport*            transport,
+	const struct sockaddr_in* target,
+	const uint8_t*            frame,
+	size_t                    length
+) {
+	if (length > KNX_TRANSPORT_FRAME_SIZE || !knx_transport_make_room(transport))
+		return false;
+
+	size_t slot = transport->tx_count;
+
+	memcpy(transport->tx_buffers[slot], frame, length);
+
+	transport->tx_targets[slot] = *target;
+	transport->tx_iov[slot].iov_base = transport->tx_buffers[slot];
+	transport->tx_iov[slot].iov_len = length;
+	transport->tx_count++;
+
+	return true;
+}
+
+static
+void knx_transport_shift(knx_transport* transport, size_t count) {
+	// Move the remaining frames to the front of the queue
+	size_t remaining = transport->tx_count - count;
+
+	for (size_t i = 0; i < remaining; i++) {
+		size_t from = count + i;
+
+		transport->tx_targets[i] = transport->tx_targets[from];
+		transport->tx_iov[i].iov_len = transport->tx_iov[from].iov_len;
+
+		if (transport->tx_iov[from].iov_base == transport->tx_buffers[from]) {
+			memcpy(transport->tx_buffers[i], transport->tx_buffers[from], transport->tx_iov[from].iov_len);
+			transport->tx_iov[i].iov_base = transport->tx_buffers[i];
+		} else {
+			transport->tx_iov[i].iov_base = transport->tx_iov[from].iov_base;
+		}
+	}
+
+	transport->tx_count = remaining;
+}
+
+ssize_t knx_transport_flush(knx_transport* transport) {
+	if (transport->tx_count == 0)
+		return 0;
+
+	int sent = sendmmsg(transport->sock, transport->tx_msgs, transport->tx_count, 0);
+
+	if (sent < 0) {
+		if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+			return 0;
+
+		// The head frame can never be sent (e.g. EMSGSIZE or an unreachable target), keeping it
+		// would block every frame behind it
+		int error = errno;
+		knx_transport_shift(transport, 1);
+		transport->tx_dropped++;
+		errno = error;
+
+		return -1;
+	}
+
+	// A partial send leaves the failing frame at the head, the next flush reports or sends it
+	knx_transport_shift(transport, sent);
+	return sent;
+}
@@ -0,0 +1,225 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_NET_TRANSPORT_H_
+#define KNXPROTO_NET_TRANSPORT_H_
+
+#include "../proto/proto.h"
+#include "../proto/batch.h"
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Number of datagrams received or sent with a single system call
+ */
+#define KNX_TRANSPORT_BATCH KNX_BATCH_SIZE
+
+/**
+ * Maximum datagram size
+ */
+#define KNX_TRANSPORT_FRAME_SIZE 512
+
+/**
+ * Batched UDP Transport
+ *
+ * Owns a non-blocking UDP socket. Datagrams are received with `recvmmsg` into fixed slots and
+ * handed to the user in-place. Outgoing frames are generated directly into send slots and
+ * transmitted with `sendmmsg`.
+ */
+typedef struct {
+	/**
+	 * Socket file descriptor
+	 */
+	int sock;
+
+	/**
+	 * Number of datagrams received by the last call to `knx_transport_poll`
+	 */
+	size_t rx_count;
+
+	/**
+	 * Number of datagrams read from the socket by the last system call of `knx_transport_poll`,
+	 * including dropped ones. Fewer than `KNX_TRANSPORT_BATCH` means the socket has been drained.
+	 */
+	size_t rx_read;
+
+	/**
+	 * Received datagrams, they point into `rx_buffers`
+	 */
+	knx_datagram rx_datagrams[KNX_TRANSPORT_BATCH];
+
+	/**
+	 * Sender of each received datagram
+	 */
+	struct sockaddr_in rx_senders[KNX_TRANSPORT_BATCH];
+
+	/**
+	 * Number of incoming datagrams that have been dropped because they exceeded
+	 * `KNX_TRANSPORT_FRAME_SIZE`
+	 */
+	size_t rx_truncated;
+
+	/**
+	 * Number of queued outgoing datagrams
+	 */
+	size_t tx_count;
+
+	/**
+	 * Target of each outgoing datagram
+	 */
+	struct sockaddr_in tx_targets[KNX_TRANSPORT_BATCH];
+
+	/**
+	 * Number of outgoing datagrams that have been dropped because sending them failed permanently
+	 */
+	size_t tx_dropped;
+
+	struct mmsghdr rx_msgs[KNX_TRANSPORT_BATCH];
+	struct iovec rx_iov[KNX_TRANSPORT_BATCH];
+	uint8_t rx_buffers[KNX_TRANSPORT_BATCH][KNX_TRANSPORT_FRAME_SIZE];
+
+	struct mmsghdr tx_msgs[KNX_TRANSPORT_BATCH];
+	struct iovec tx_iov[KNX_TRANSPORT_BATCH];
+	uint8_t tx_buffers[KNX_TRANSPORT_BATCH][KNX_TRANSPORT_FRAME_SIZE];
+} knx_transport;
+
+/**
+ * Handler for parsed packets
+ *
+ * \param data   User data given to `knx_transport_dispatch`
+ * \param sender Origin of the datagram
+ * \param frame  Raw frame
+ * \param length Number of bytes in `frame`
+ * \param packet Parsed packet, only valid during the call (`NULL` if parsing failed)
+ */
+typedef void (* knx_transport_handler)(
+	void*                     data,
+	const struct sockaddr_in* sender,
+	const uint8_t*            frame,
+	size_t                    length,
+	const knx_packet*         packet
+);
+
+/**
+ * Create the socket.
+ *
+ * \param transport Transport to initialize
+ * \param local     Local address to bind to (may be `NULL` to bind to an ephemeral port)
+ * \returns `true` on success, otherwise `false` (`errno` indicates the error)
+ */
+bool knx_transport_init(knx_transport* transport, const struct sockaddr_in* local);
+
+/**
+ * Close the socket.
+ */
+void knx_transport_destroy(knx_transport* transport);
+
+/**
+ * Join a multicast group (e.g. 224.0.23.12 for routing).
+ *
+ * \param transport Transport
+ * \param group     Multicast group address in network byte order
+ * \param interface Local interface address in network byte order (`INADDR_ANY` for default)
+ */
+bool knx_transport_join(knx_transport* transport, in_addr_t group, in_addr_t interface);
+
+/**
+ * Retrieve the local address of the socket.
+ */
+bool knx_transport_local_address(const knx_transport* transport, struct sockaddr_in* local);
+
+/**
+ * Receive a batch of datagrams. Results are stored in `rx_datagrams` and `rx_senders`, which
+ * remain valid until the next call. They can be fed straight into `knx_parse_batch`,
+ * `knx_classify` or `knx_parse`. Datagrams larger than `KNX_TRANSPORT_FRAME_SIZE` are dropped
+ * and counted in `rx_truncated`.
+ *
+ * \returns Number of received datagrams, `0` if none are pending or `-1` on error
+ */
+ssize_t knx_transport_poll(knx_transport* transport);
+
+/**
+ * Receive a batch of datagrams, parse them and invoke the handler for each one.
+ *
+ * \returns Number of processed datagrams, `0` if none are pending or `-1` on error
+ */
+ssize_t knx_transport_dispatch(
+	knx_transport*        transport,
+	knx_transport_handler handler,
+	void*                 data
+);
+
+/**
+ * Generate a frame directly into the next send slot. The queue is flushed first if it is full.
+ *
+ * \param transport Transport
+ * \param target    Destination of the frame
+ * \param service   Service identifier
+ * \param payload   Pointer to a payload structure
+ * \returns `true` if the frame has been queued, otherwise `false`
+ */
+bool knx_transport_queue(
+	knx_transport*            transport,
+	const struct sockaddr_in* target,
+	knx_service               service,
+	const void*               payload
+);
+
+/**
+ * Queue a preformatted frame (e.g. from a `knx_frame_template`) without copying it.
+ *
+ * \note `frame` must remain valid until the queue has been flushed.
+ */
+bool knx_transport_queue_raw(
+	knx_transport*            transport,
+	const struct sockaddr_in* target,
+	const uint8_t*            frame,
+	size_t                    length
+);
+
+/**
+ * Copy a preformatted frame into the next send slot.
+ *
+ * \returns `true` if the frame has been queued, `false` if the queue is full or the frame exceeds
+ *          `KNX_TRANSPORT_FRAME_SIZE`
+ */
+bool knx_transport_queue_copy(
+	knx_transport*            transport,
+	const struct sockaddr_in* target,
+	const uint8_t*            frame,
+	size_t                    length
+);
+
+/**
+ * Send all queued frames. Frames that could not be sent because the socket would block remain
+ * queued. If the frame at the head of the queue fails with any other error, it is dropped and
+ * counted in `tx_dropped`, so the frames behind it can be sent by the next call.
+ *
+ * \returns Number of sent frames or `-1` on error (`errno` indicates the error)
+ */
+ssize_t knx_transport_flush(knx_transport* transport);
+
+#endif
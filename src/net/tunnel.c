@@ -0,0 +1,402 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "tunnel.h"
+
+#include <string.h>
+
+static
+void knx_tunnel_client_set_state(knx_tunnel_client* client, knx_tunnel_state state) {
+	if (client->state == state)
+		return;
+
+	client->state = state;
+
+	if (client->handlers.state_changed)
+		client->handlers.state_changed(client->data, client, state);
+}
+
+// Connection has been lost or refused, the in-flight frame stays queued for the next connection
+static
+void knx_tunnel_client_lost(knx_tunnel_client* client) {
+	knx_timer_cancel(&client->request_timer);
+	knx_timer_cancel(&client->heartbeat_timer);
+
+	client->frame_length = 0;
+	client->attempts = 0;
+
+	knx_tunnel_client_set_state(client, KNX_TUNNEL_DISCONNECTED);
+
+	if (client->reconnect_delay > 0 && client->state == KNX_TUNNEL_DISCONNECTED)
+		knx_timer_schedule(client->wheel, &client->reconnect_timer, client->reconnect_delay);
+}
+
+static
+void knx_tunnel_client_abort(knx_tunnel_client* client) {
+	knx_disconnect_request req = {
+		client->channel,
+		0,
+		KNX_HOST_INFO_NAT(KNX_PROTO_UDP)
+	};
+
+	knx_transport_queue(client->transport, &client->gateway, KNX_DISCONNECT_REQUEST, &req);
+	knx_tunnel_client_lost(client);
+}
+
+static
+void knx_tunnel_client_transmit(knx_tunnel_client* client) {
+	if (client->state != KNX_TUNNEL_CONNECTED || client->frame_length > 0 ||
+	    client->queue_count == 0)
+		return;
+
+	const knx_tunnel_slot* slot = &client->queue[client->queue_head];
+
+	knx_header_generate(client->frame, KNX_TUNNEL_REQUEST, 4 + slot->length);
+
+	uint8_t* payload = client->frame + KNX_HEADER_SIZE;
+	payload[0] = 4;
+	payload[1] = client->channel;
+	payload[2] = client->tx_seq_number;
+	payload[3] = 0;
+	memcpy(payload + 4, slot->cemi, slot->length);
+
+	client->frame_length = KNX_HEADER_SIZE + 4 + slot->length;
+	client->attempts = 1;
+
+	knx_transport_queue_copy(client->transport, &client->gateway, client->frame, client->frame_length);
+	knx_timer_schedule(client->wheel, &client->request_timer, KNX_TUNNEL_ACK_TIMEOUT);
+}
+
+static
+void knx_tunnel_client_request_timeout(knx_timer* timer, void* data) {
+	knx_tunnel_client* client = data;
+	(void) timer;
+
+	switch (client->state) {
+		case KNX_TUNNEL_CONNECTING:
+			knx_tunnel_client_lost(client);
+			break;
+
+		case KNX_TUNNEL_DISCONNECTING:
+			knx_tunnel_client_set_state(client, KNX_TUNNEL_DISCONNECTED);
+			break;
+
+		case KNX_TUNNEL_CONNECTED:
+			if (client->frame_length == 0)
+				break;
+
+			// A tunnel request is repeated once, then the connection is given up
+			if (client->attempts < 2) {
+				client->attempts++;
+
+				knx_transport_queue_copy(
+					client->transport,
+					&client->gateway,
+					client->frame,
+					client->frame_length
+				);
+				knx_timer_schedule(client->wheel, &client->request_timer, KNX_TUNNEL_ACK_TIMEOUT);
+			} else {
+				knx_tunnel_client_abort(client);
+			}
+
+			break;
+
+		default:
+			break;
+	}
+}
+
+static
+void knx_tunnel_client_heartbeat(knx_timer* timer, void* data) {
+	knx_tunnel_client* client = data;
+
+	if (client->state != KNX_TUNNEL_CONNECTED)
+		return;
+
+	if (client->heartbeats >= KNX_TUNNEL_HEARTBEAT_ATTEMPTS) {
+		knx_tunnel_client_abort(client);
+		return;
+	}
+
+	knx_connection_state_request req = {
+		client->channel,
+		0,
+		KNX_HOST_INFO_NAT(KNX_PROTO_UDP)
+	};
+
+	knx_transport_queue(client->transport, &client->gateway, KNX_CONNECTION_STATE_REQUEST, &req);
+
+	client->heartbeats++;
+	knx_timer_schedule(client->wheel, timer, KNX_TUNNEL_HEARTBEAT_TIMEOUT);
+}
+
+static
+void knx_tunnel_client_reconnect(knx_timer* timer, void* data) {
+	knx_tunnel_client* client = data;
+
+	// The connection request could not be queued, try again later
+	if (!knx_tunnel_client_connect(client) &&
+	    client->state == KNX_TUNNEL_DISCONNECTED &&
+	    client->reconnect_delay > 0)
+		knx_timer_schedule(client->wheel, timer, client->reconnect_delay);
+}
+
+void knx_tunnel_client_init(
+	knx_tunnel_client*         client,
+	knx_transport*             transport,
+	knx_timer_wheel*           wheel,
+	const struct sockaddr_in*  gateway,
+	const knx_tunnel_handlers* handlers,
+	void*                      data
+) {
+	client->state = KNX_TUNNEL_DISCONNECTED;
+	client->transport = transport;
+	client->wheel = wheel;
+	client->gateway = *gateway;
+	client->handlers = *handlers;
+	client->data = data;
+	client->reconnect_delay = 0;
+
+	client->channel = 0;
+	client->tx_seq_number = 0;
+	client->rx_seq_number = 0;
+	client->attempts = 0;
+	client->heartbeats = 0;
+
+	knx_timer_init(&client->request_timer, knx_tunnel_client_request_timeout, client);
+	knx_timer_init(&client->heartbeat_timer, knx_tunnel_client_heartbeat, client);
+	knx_timer_init(&client->reconnect_timer, knx_tunnel_client_reconnect, client);
+
+	client->frame_length = 0;
+	client->queue_head = 0;
+	client->queue_count = 0;
+}
+
+void knx_tunnel_client_destroy(knx_tunnel_client* client) {
+	knx_timer_cancel(&client->request_timer);
+	knx_timer_cancel(&client->heartbeat_timer);
+	knx_timer_cancel(&client->reconnect_timer);
+}
+
+bool knx_tunnel_client_connect(knx_tunnel_client* client) {
+	if (client->state != KNX_TUNNEL_DISCONNECTED)
+		return false;
+
+	knx_connection_request req = {
+		KNX_CONNECTION_REQUEST_TUNNEL,
+		KNX_CONNECTION_LAYER_TUNNEL,
+		KNX_HOST_INFO_NAT(KNX_PROTO_UDP),
+		KNX_HOST_INFO_NAT(KNX_PROTO_UDP)
+	};
+
+	knx_timer_cancel(&client->reconnect_timer);
+
+	if (!knx_transport_queue(client->transport, &client->gateway, KNX_CONNECTION_REQUEST, &req))
+		return false;
+
+	knx_timer_schedule(client->wheel, &client->request_timer, KNX_TUNNEL_CONNECT_TIMEOUT);
+	knx_tunnel_client_set_state(client, KNX_TUNNEL_CONNECTING);
+
+	return true;
+}
+
+void knx_tunnel_client_disconnect(knx_tunnel_client* client) {
+	client->reconnect_delay = 0;
+	knx_timer_cancel(&client->reconnect_timer);
+
+	switch (client->state) {
+		case KNX_TUNNEL_CONNECTING:
+			knx_timer_cancel(&client->request_timer);
+			knx_tunnel_client_set_state(client, KNX_TUNNEL_DISCONNECTED);
+			break;
+
+		case KNX_TUNNEL_CONNECTED: {
+			knx_disconnect_request req = {
+				client->channel,
+				0,
+				KNX_HOST_INFO_NAT(KNX_PROTO_UDP)
+			};
+
+			knx_transport_queue(client->transport, &client->gateway, KNX_DISCONNECT_REQUEST, &req);
+
+			knx_timer_cancel(&client->heartbeat_timer);
+			knx_timer_schedule(client->wheel, &client->request_timer, KNX_TUNNEL_CONNECT_TIMEOUT);
+
+			client->frame_length = 0;
+			knx_tunnel_client_set_state(client, KNX_TUNNEL_DISCONNECTING);
+			break;
+		}
+
+		default:
+			break;
+	}
+}
+
+bool knx_tunnel_client_send(knx_tunnel_client* client, const knx_cemi* cemi) {
+	size_t length = knx_cemi_size(cemi);
+
+	if (client->queue_count >= KNX_TUNNEL_QUEUE_SIZE || length > KNX_TUNNEL_CEMI_SIZE)
+		return false;
+
+	knx_tunnel_slot* slot =
+		&client->queue[(client->queue_head + client->queue_count) % KNX_TUNNEL_QUEUE_SIZE];
+
+	if (!knx_cemi_generate(slot->cemi, cemi))
+		return false;
+
+	slot->length = length;
+	client->queue_count++;
+
+	knx_tunnel_client_transmit(client);
+	return true;
+}
+
+static
+void knx_tunnel_client_connected(knx_tunnel_client* client, const knx_connection_response* res) {
+	knx_timer_cancel(&client->request_timer);
+
+	if (res->status != 0) {
+		knx_tunnel_client_lost(client);
+		return;
+	}
+
+	client->channel = res->channel;
+	client->tx_seq_number = 0;
+	client->rx_seq_number = 0;
+	client->attempts = 0;
+	client->heartbeats = 0;
+	client->frame_length = 0;
+
+	knx_timer_schedule(client->wheel, &client->heartbeat_timer, KNX_TUNNEL_HEARTBEAT_INTERVAL);
+	knx_tunnel_client_set_state(client, KNX_TUNNEL_CONNECTED);
+
+	knx_tunnel_client_transmit(client);
+}
+
+static
+void knx_tunnel_client_incoming(knx_tunnel_client* client, const knx_tunnel_request* req) {
+	knx_tunnel_response res = {client->channel, req->seq_number, 0};
+
+	if (req->seq_number == client->rx_seq_number) {
+		knx_transport_queue(client->transport, &client->gateway, KNX_TUNNEL_RESPONSE, &res);
+		client->rx_seq_number++;
+
+		if (client->handlers.received)
+			client->handlers.received(client->data, client, &req->data);
+	} else if (req->seq_number == (uint8_t) (client->rx_seq_number - 1)) {
+		// Our acknowledgement got lost, the gateway repeats its request
+		knx_transport_queue(client->transport, &client->gateway, KNX_TUNNEL_RESPONSE, &res);
+	}
+}
+
+static
+void knx_tunnel_client_acknowledged(knx_tunnel_client* client, const knx_tunnel_response* res) {
+	// Negative acknowledgements are handled like missing ones
+	if (client->frame_length == 0 || res->seq_number != client->tx_seq_number || res->status != 0)
+		return;
+
+	knx_timer_cancel(&client->request_timer);
+
+	client->queue_head = (client->queue_head + 1) % KNX_TUNNEL_QUEUE_SIZE;
+	client->queue_count--;
+
+	client->tx_seq_number++;
+	client->frame_length = 0;
+	client->attempts = 0;
+
+	knx_tunnel_client_transmit(client);
+}
+
+bool knx_tunnel_client_handle(knx_tunnel_client* client, const knx_packet* packet) {
+	switch (packet->service) {
+		case KNX_CONNECTION_RESPONSE:
+			if (client->state != KNX_TUNNEL_CONNECTING)
+				return false;
+
+			knx_tunnel_client_connected(client, &packet->payload.conn_res);
+			return true;
+
+		case KNX_CONNECTION_STATE_RESPONSE:
+			if (client->state != KNX_TUNNEL_CONNECTED ||
+			    packet->payload.conn_state_res.channel != client->channel)
+				return false;
+
+			if (packet->payload.conn_state_res.status != 0) {
+				knx_tunnel_client_abort(client);
+			} else {
+				client->heartbeats = 0;
+				knx_timer_schedule(
+					client->wheel,
+					&client->heartbeat_timer,
+					KNX_TUNNEL_HEARTBEAT_INTERVAL
+				);
+			}
+
+			return true;
+
+		case KNX_TUNNEL_REQUEST:
+			if (client->state != KNX_TUNNEL_CONNECTED ||
+			    packet->payload.tunnel_req.channel != client->channel)
+				return false;
+
+			knx_tunnel_client_incoming(client, &packet->payload.tunnel_req);
+			return true;
+
+		case KNX_TUNNEL_RESPONSE:
+			if (client->state != KNX_TUNNEL_CONNECTED ||
+			    packet->payload.tunnel_res.channel != client->channel)
+				return false;
+
+			knx_tunnel_client_acknowledged(client, &packet->payload.tunnel_res);
+			return true;
+
+		case KNX_DISCONNECT_REQUEST: {
+			if (client->state == KNX_TUNNEL_DISCONNECTED ||
+			    packet->payload.dc_req.channel != client->channel)
+				return false;
+
+			knx_disconnect_response res = {client->channel, 0};
+			knx_transport_queue(client->transport, &client->gateway, KNX_DISCONNECT_RESPONSE, &res);
+
+			if (client->state == KNX_TUNNEL_DISCONNECTING) {
+				knx_timer_cancel(&client->request_timer);
+				knx_tunnel_client_set_state(client, KNX_TUNNEL_DISCONNECTED);
+			} else {
+				knx_tunnel_client_lost(client);
+			}
+
+			return true;
+		}
+
+		case KNX_DISCONNECT_RESPONSE:
+			if (client->state != KNX_TUNNEL_DISCONNECTING ||
+			    packet->payload.dc_res.channel != client->channel)
+				return false;
+
+			knx_timer_cancel(&client->request_timer);
+			knx_tunnel_client_set_state(client, KNX_TUNNEL_DISCONNECTED);
+			return true;
+
+		default:
+			return false;
+	}
+}
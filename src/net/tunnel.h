@@ -0,0 +1,223 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_NET_TUNNEL_H_
+#define KNXPROTO_NET_TUNNEL_H_
+
+#include "transport.h"
+#include "../proto/proto.h"
+#include "../util/timerwheel.h"
+
+#include <netinet/in.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Number of outgoing cEMI frames that can be queued per client
+ */
+#define KNX_TUNNEL_QUEUE_SIZE 32
+
+/**
+ * Maximum size of a queued cEMI frame
+ */
+#define KNX_TUNNEL_CEMI_SIZE 256
+
+/**
+ * Time to wait for a tunnel response before the request is repeated
+ */
+#define KNX_TUNNEL_ACK_TIMEOUT 1000
+
+/**
+ * Time to wait for a connection response or disconnect response
+ */
+#define KNX_TUNNEL_CONNECT_TIMEOUT 10000
+
+/**
+ * Interval between heartbeats (connection state requests)
+ */
+#define KNX_TUNNEL_HEARTBEAT_INTERVAL 60000
+
+/**
+ * Time to wait for a connection state response
+ */
+#define KNX_TUNNEL_HEARTBEAT_TIMEOUT 10000
+
+/**
+ * Number of unanswered heartbeats after which the connection is considered lost
+ */
+#define KNX_TUNNEL_HEARTBEAT_ATTEMPTS 3
+
+/**
+ * Tunnel Connection State
+ */
+typedef enum {
+	KNX_TUNNEL_DISCONNECTED,
+	KNX_TUNNEL_CONNECTING,
+	KNX_TUNNEL_CONNECTED,
+	KNX_TUNNEL_DISCONNECTING
+} knx_tunnel_state;
+
+typedef struct _knx_tunnel_client knx_tunnel_client;
+
+/**
+ * Tunnel Client Handlers
+ */
+typedef struct {
+	/**
+	 * Invoked once the connection state has changed (may be `NULL`)
+	 */
+	void (* state_changed)(void* data, knx_tunnel_client* client, knx_tunnel_state state);
+
+	/**
+	 * Invoked for every cEMI frame received through the tunnel (may be `NULL`)
+	 */
+	void (* received)(void* data, knx_tunnel_client* client, const knx_cemi* cemi);
+} knx_tunnel_handlers;
+
+/**
+ * Queued cEMI Frame
+ */
+typedef struct {
+	uint16_t length;
+	uint8_t  cemi[KNX_TUNNEL_CEMI_SIZE];
+} knx_tunnel_slot;
+
+/**
+ * Non-blocking Tunnelling Client
+ *
+ * The client does not own a socket or a clock. Packets from the gateway are fed into
+ * `knx_tunnel_client_handle`, timeouts are driven by a shared `knx_timer_wheel` and outgoing
+ * frames are queued on a shared `knx_transport`. The user decides when to flush the transport,
+ * which lets many clients share one `sendmmsg` call.
+ *
+ * Only one tunnel request is in flight at a time, as the protocol demands. Further frames wait
+ * in a fixed-size queue, hence `knx_tunnel_client_send` never blocks.
+ */
+struct _knx_tunnel_client {
+	knx_tunnel_state state;
+
+	knx_transport*     transport;
+	knx_timer_wheel*   wheel;
+	struct sockaddr_in gateway;
+
+	knx_tunnel_handlers handlers;
+	void*               data;
+
+	/**
+	 * Delay before reconnecting after the connection was lost (`0` disables reconnects)
+	 */
+	uint32_t reconnect_delay;
+
+	/**
+	 * Communication channel assigned by the gateway
+	 */
+	uint8_t channel;
+
+	/**
+	 * Sequence number of the next outgoing tunnel request
+	 */
+	uint8_t tx_seq_number;
+
+	/**
+	 * Sequence number of the next expected incoming tunnel request
+	 */
+	uint8_t rx_seq_number;
+
+	/**
+	 * Number of transmissions of the request in flight
+	 */
+	uint8_t attempts;
+
+	/**
+	 * Number of consecutive unanswered heartbeats
+	 */
+	uint8_t heartbeats;
+
+	knx_timer request_timer;
+	knx_timer heartbeat_timer;
+	knx_timer reconnect_timer;
+
+	/**
+	 * Frame of the request in flight
+	 */
+	uint8_t frame[KNX_HEADER_SIZE + 4 + KNX_TUNNEL_CEMI_SIZE];
+	size_t  frame_length;
+
+	size_t          queue_head;
+	size_t          queue_count;
+	knx_tunnel_slot queue[KNX_TUNNEL_QUEUE_SIZE];
+};
+
+/**
+ * Initialize the client. No connection is established until `knx_tunnel_client_connect` is
+ * called.
+ *
+ * \param client    Client
+ * \param transport Transport used for outgoing frames
+ * \param wheel     Timer wheel driving the timeouts
+ * \param gateway   Gateway address
+ * \param handlers  Event handlers
+ * \param data      User data for the handlers
+ */
+void knx_tunnel_client_init(
+	knx_tunnel_client*         client,
+	knx_transport*             transport,
+	knx_timer_wheel*           wheel,
+	const struct sockaddr_in*  gateway,
+	const knx_tunnel_handlers* handlers,
+	void*                      data
+);
+
+/**
+ * Cancel all timers. The client does not notify the gateway, use `knx_tunnel_client_disconnect`
+ * beforehand.
+ */
+void knx_tunnel_client_destroy(knx_tunnel_client* client);
+
+/**
+ * Start connecting to the gateway.
+ *
+ * \returns `true` if the connection request has been queued
+ */
+bool knx_tunnel_client_connect(knx_tunnel_client* client);
+
+/**
+ * Disconnect from the gateway. Reconnects are disabled.
+ */
+void knx_tunnel_client_disconnect(knx_tunnel_client* client);
+
+/**
+ * Queue a cEMI frame for transmission.
+ *
+ * \returns `true` if the frame has been queued, `false` if the queue is full or the frame is too
+ *          large
+ */
+bool knx_tunnel_client_send(knx_tunnel_client* client, const knx_cemi* cemi);
+
+/**
+ * Process a packet which has been received from the gateway.
+ *
+ * \returns `true` if the packet belonged to this client, otherwise `false`
+ */
+bool knx_tunnel_client_handle(knx_tunnel_client* client, const knx_packet* packet);
+
+#endif
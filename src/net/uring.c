@@ -0,0 +1,464 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "uring.h"
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <linux/time_types.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+
+// There is no libc wrapper for these system calls.
+
+inline static
+int knx_uring_setup(unsigned entries, struct io_uring_params* params) {
+	return syscall(__NR_io_uring_setup, entries, params);
+}
+
+inline static
+int knx_uring_enter(int ring, unsigned submit, unsigned wait, unsigned flags, void* arg, size_t size) {
+	return syscall(__NR_io_uring_enter, ring, submit, wait, flags, arg, size);
+}
+
+inline static
+int knx_uring_register(int ring, unsigned opcode, void* arg, unsigned count) {
+	return syscall(__NR_io_uring_register, ring, opcode, arg, count);
+}
+
+// User data of the multishot receive, send completions carry their slot index
+#define KNX_URING_RECV UINT64_MAX
+
+#define knx_uring_buffer(uring, id) ((uring)->buffers + (size_t) (id) * KNX_URING_BUFFER_SIZE)
+
+static
+struct io_uring_sqe* knx_uring_get_sqe(knx_uring* uring) {
+	unsigned tail = *uring->sq_tail;
+	unsigned head = __atomic_load_n(uring->sq_head, __ATOMIC_ACQUIRE);
+
+	if (tail - head > uring->sq_mask)
+		return NULL;
+
+	unsigned index = tail & uring->sq_mask;
+	struct io_uring_sqe* sqe = &uring->sqes[index];
+
+	memset(sqe, 0, sizeof(struct io_uring_sqe));
+	uring->sq_array[index] = index;
+
+	return sqe;
+}
+
+inline static
+void knx_uring_commit_sqe(knx_uring* uring) {
+	__atomic_store_n(uring->sq_tail, *uring->sq_tail + 1, __ATOMIC_RELEASE);
+	uring->sq_pending++;
+}
+
+static
+void knx_uring_arm_receive(knx_uring* uring) {
+	struct io_uring_sqe* sqe = knx_uring_get_sqe(uring);
+	if (!sqe)
+		return;
+
+	sqe->opcode = IORING_OP_RECVMSG;
+	sqe->fd = 0;
+	sqe->flags = IOSQE_FIXED_FILE | IOSQE_BUFFER_SELECT;
+	sqe->ioprio = IORING_RECV_MULTISHOT;
+	sqe->addr = (uintptr_t) &uring->rx_msg;
+	sqe->len = 1;
+	sqe->buf_group = 0;
+	sqe->user_data = KNX_URING_RECV;
+
+	knx_uring_commit_sqe(uring);
+	uring->receiving = true;
+}
+
+inline static
+void knx_uring_recycle(knx_uring* uring, uint16_t id) {
+	struct io_uring_buf* buffer =
+		&uring->buffer_ring->bufs[uring->buffer_tail & (KNX_URING_BUFFERS - 1)];
+
+	buffer->addr = (uintptr_t) knx_uring_buffer(uring, id);
+	buffer->len = KNX_URING_BUFFER_SIZE;
+	buffer->bid = id;
+
+	uring->buffer_tail++;
+}
+
+inline static
+void knx_uring_publish_buffers(knx_uring* uring) {
+	__atomic_store_n(&uring->buffer_ring->tail, uring->buffer_tail, __ATOMIC_RELEASE);
+}
+
+bool knx_uring_init(knx_uring* uring, const struct sockaddr_in* local) {
+	memset(uring, 0, offsetof(knx_uring, tx_targets));
+
+	uring->ring = -1;
+	uring->ring_memory = MAP_FAILED;
+	uring->sqes = MAP_FAILED;
+	uring->buffer_ring = MAP_FAILED;
+
+	uring->sock = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, IPPROTO_UDP);
+	if (uring->sock < 0)
+		return false;
+
+	int reuse = 1;
+	setsockopt(uring->sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+	struct sockaddr_in any = {
+		.sin_family = AF_INET,
+		.sin_addr = {INADDR_ANY},
+		.sin_port = 0
+	};
+
+	if (bind(uring->sock, (const struct sockaddr*) (local ? local : &any), sizeof(any)) != 0)
+		goto fail;
+
+	// Ring setup, the optimization flags are not known to older kernels
+	struct io_uring_params params;
+	memset(&params, 0, sizeof(params));
+	params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_COOP_TASKRUN;
+	params.cq_entries = KNX_URING_COMPLETIONS;
+
+	uring->ring = knx_uring_setup(KNX_URING_ENTRIES, &params);
+
+	if (uring->ring < 0 && errno == EINVAL) {
+		memset(&params, 0, sizeof(params));
+		params.flags = IORING_SETUP_CQSIZE;
+		params.cq_entries = KNX_URING_COMPLETIONS;
+
+		uring->ring = knx_uring_setup(KNX_URING_ENTRIES, &params);
+	}
+
+	if (uring->ring < 0)
+		goto fail;
+
+	if (!(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_EXT_ARG)) {
+		errno = ENOSYS;
+		goto fail;
+	}
+
+	// Map both queues
+	size_t sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	size_t cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+
+	uring->ring_size = sq_size > cq_size ? sq_size : cq_size;
+	uring->ring_memory = mmap(NULL, uring->ring_size, PROT_READ | PROT_WRITE,
+	                          MAP_SHARED | MAP_POPULATE, uring->ring, IORING_OFF_SQ_RING);
+
+	if (uring->ring_memory == MAP_FAILED)
+		goto fail;
+
+	uring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+	uring->sqes = mmap(NULL, uring->sqes_size, PROT_READ | PROT_WRITE,
+	                   MAP_SHARED | MAP_POPULATE, uring->ring, IORING_OFF_SQES);
+
+	if (uring->sqes == MAP_FAILED)
+		goto fail;
+
+	uint8_t* memory = uring->ring_memory;
+
+	uring->sq_head = (unsigned*) (memory + params.sq_off.head);
+	uring->sq_tail = (unsigned*) (memory + params.sq_off.tail);
+	uring->sq_mask = *(unsigned*) (memory + params.sq_off.ring_mask);
+	uring->sq_array = (unsigned*) (memory + params.sq_off.array);
+
+	uring->cq_head = (unsigned*) (memory + params.cq_off.head);
+	uring->cq_tail = (unsigned*) (memory + params.cq_off.tail);
+	uring->cq_mask = *(unsigned*) (memory + params.cq_off.ring_mask);
+	uring->cqes = (struct io_uring_cqe*) (memory + params.cq_off.cqes);
+
+	// Registering the socket saves a file table lookup per operation
+	if (knx_uring_register(uring->ring, IORING_REGISTER_FILES, &uring->sock, 1) < 0)
+		goto fail;
+
+	// The buffer ring is followed by the buffers themselves
+	size_t ring_bytes = KNX_URING_BUFFERS * sizeof(struct io_uring_buf);
+	uring->buffer_ring = mmap(NULL, ring_bytes + KNX_URING_BUFFERS * KNX_URING_BUFFER_SIZE,
+	                          PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+	if (uring->buffer_ring == MAP_FAILED)
+		goto fail;
+
+	uring->buffers = (uint8_t*) uring->buffer_ring + ring_bytes;
+
+	struct io_uring_buf_reg reg;
+	memset(&reg, 0, sizeof(reg));
+	reg.ring_addr = (uintptr_t) uring->buffer_ring;
+	reg.ring_entries = KNX_URING_BUFFERS;
+	reg.bgid = 0;
+
+	if (knx_uring_register(uring->ring, IORING_REGISTER_PBUF_RING, &reg, 1) < 0)
+		goto fail;
+
+	for (uint16_t i = 0; i < KNX_URING_BUFFERS; i++)
+		knx_uring_recycle(uring, i);
+
+	knx_uring_publish_buffers(uring);
+
+	uring->rx_msg.msg_namelen = sizeof(struct sockaddr_in);
+	uring->rx_msg.msg_controllen = 0;
+
+	for (size_t i = 0; i < KNX_URING_TX_SLOTS; i++)
+		uring->tx_free[i] = i;
+
+	uring->tx_count = 0;
+	uring->tx_dropped = 0;
+	uring->rx_truncated = 0;
+
+	knx_uring_arm_receive(uring);
+	return true;
+
+	fail: {
+		int error = errno;
+		knx_uring_destroy(uring);
+		errno = error;
+
+		return false;
+	}
+}
+
+void knx_uring_destroy(knx_uring* uring) {
+	// Closing the ring cancels all pending operations
+	if (uring->ring >= 0)
+		close(uring->ring);
+
+	if (uring->buffer_ring != MAP_FAILED)
+		munmap(uring->buffer_ring, KNX_URING_BUFFERS *
+		                           (sizeof(struct io_uring_buf) + KNX_URING_BUFFER_SIZE));
+
+	if (uring->sqes != MAP_FAILED)
+		munmap(uring->sqes, uring->sqes_size);
+
+	if (uring->ring_memory != MAP_FAILED)
+		munmap(uring->ring_memory, uring->ring_size);
+
+	if (uring->sock >= 0)
+		close(uring->sock);
+
+	uring->ring = -1;
+	uring->sock = -1;
+	uring->ring_memory = MAP_FAILED;
+	uring->sqes = MAP_FAILED;
+	uring->buffer_ring = MAP_FAILED;
+}
+
+bool knx_uring_join(knx_uring* uring, in_addr_t group, in_addr_t interface) {
+	struct ip_mreq request = {
+		.imr_multiaddr = {group},
+		.imr_interface = {interface}
+	};
+
+	return setsockopt(uring->sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, &request, sizeof(request)) == 0;
+}
+
+bool knx_uring_local_address(const knx_uring* uring, struct sockaddr_in* local) {
+	socklen_t length = sizeof(struct sockaddr_in);
+	return getsockname(uring->sock, (struct sockaddr*) local, &length) == 0;
+}
+
+bool knx_uring_queue(
+	knx_uring*                uring,
+	const struct sockaddr_in* target,
+	knx_service               service,
+	const void*               payload
+) {
+	if (uring->tx_count >= KNX_URING_TX_SLOTS)
+		return false;
+
+	size_t slot = uring->tx_free[KNX_URING_TX_SLOTS - uring->tx_count - 1];
+
+	ssize_t length = knx_generate_bounded(
+		uring->tx_buffers[slot],
+		KNX_TRANSPORT_FRAME_SIZE,
+		service,
+		payload
+	);
+
+	if (length < 0)
+		return false;
+
+	struct io_uring_sqe* sqe = knx_uring_get_sqe(uring);
+	if (!sqe)
+		return false;
+
+	uring->tx_targets[slot] = *target;
+
+	sqe->opcode = IORING_OP_SEND;
+	sqe->fd = 0;
+	sqe->flags = IOSQE_FIXED_FILE;
+	sqe->addr = (uintptr_t) uring->tx_buffers[slot];
+	sqe->len = length;
+	sqe->addr2 = (uintptr_t) &uring->tx_targets[slot];
+	sqe->addr_len = sizeof(struct sockaddr_in);
+	sqe->user_data = slot;
+
+	knx_uring_commit_sqe(uring);
+	uring->tx_count++;
+
+	return true;
+}
+
+ssize_t knx_uring_submit(knx_uring* uring) {
+	if (uring->sq_pending == 0)
+		return 0;
+
+	int submitted = knx_uring_enter(uring->ring, uring->sq_pending, 0, 0, NULL, 0);
+
+	if (submitted < 0)
+		return errno == EINTR || errno == EAGAIN || errno == EBUSY ? 0 : -1;
+
+	uring->sq_pending -= submitted;
+	return submitted;
+}
+
+static
+void knx_uring_harvest(knx_uring* uring) {
+	unsigned head = *uring->cq_head;
+	unsigned tail = __atomic_load_n(uring->cq_tail, __ATOMIC_ACQUIRE);
+
+	while (head != tail && uring->rx_count < KNX_BATCH_SIZE) {
+		const struct io_uring_cqe* cqe = &uring->cqes[head & uring->cq_mask];
+		head++;
+
+		if (cqe->user_data != KNX_URING_RECV) {
+			if (cqe->res < 0)
+				uring->tx_dropped++;
+
+			// Send slot is free again
+			uring->tx_count--;
+			uring->tx_free[KNX_URING_TX_SLOTS - uring->tx_count - 1] = cqe->user_data;
+			continue;
+		}
+
+		if (!(cqe->flags & IORING_CQE_F_MORE))
+			uring->receiving = false;
+
+		if (cqe->res < 0 || !(cqe->flags & IORING_CQE_F_BUFFER))
+			continue;
+
+		uint16_t id = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+		uint8_t* buffer = knx_uring_buffer(uring, id);
+
+		// Buffer layout: completion header, sender address (reserved size), datagram
+		const struct io_uring_recvmsg_out* out = (const struct io_uring_recvmsg_out*) buffer;
+
+		if (out->flags & MSG_TRUNC) {
+			uring->rx_truncated++;
+			knx_uring_recycle(uring, id);
+			continue;
+		}
+
+		if (out->namelen < sizeof(struct sockaddr_in)) {
+			knx_uring_recycle(uring, id);
+			continue;
+		}
+
+		size_t i = uring->rx_count++;
+		uint8_t* name = buffer + sizeof(struct io_uring_recvmsg_out);
+
+		memcpy(&uring->rx_senders[i], name, sizeof(struct sockaddr_in));
+		uring->rx_datagrams[i].frame = name + uring->rx_msg.msg_namelen;
+		uring->rx_datagrams[i].length = out->payloadlen;
+		uring->rx_buffer_ids[i] = id;
+	}
+
+	__atomic_store_n(uring->cq_head, head, __ATOMIC_RELEASE);
+}
+
+ssize_t knx_uring_poll(knx_uring* uring, int timeout) {
+	// The previous batch is done, hand its buffers back to the kernel
+	for (size_t i = 0; i < uring->rx_count; i++)
+		knx_uring_recycle(uring, uring->rx_buffer_ids[i]);
+
+	uring->rx_count = 0;
+	knx_uring_publish_buffers(uring);
+
+	if (!uring->receiving)
+		knx_uring_arm_receive(uring);
+
+	bool ready = *uring->cq_head != __atomic_load_n(uring->cq_tail, __ATOMIC_ACQUIRE);
+
+	if (!ready && timeout != 0) {
+		struct __kernel_timespec ts = {timeout / 1000, (timeout % 1000) * 1000000L};
+		struct io_uring_getevents_arg arg;
+		memset(&arg, 0, sizeof(arg));
+		arg.ts = timeout > 0 ? (uintptr_t) &ts : 0;
+
+		int submitted = knx_uring_enter(
+			uring->ring,
+			uring->sq_pending,
+			1,
+			IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+			&arg,
+			sizeof(arg)
+		);
+
+		if (submitted >= 0)
+			uring->sq_pending -= submitted;
+		else if (errno != ETIME && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+			return -1;
+	} else if (knx_uring_submit(uring) < 0) {
+		return -1;
+	}
+
+	knx_uring_harvest(uring);
+	knx_uring_publish_buffers(uring);
+
+	// Multishot receives terminate when they run out of buffers, rearm for the next round
+	if (!uring->receiving && uring->rx_count == 0)
+		knx_uring_arm_receive(uring);
+
+	return uring->rx_count;
+}
+
+ssize_t knx_uring_dispatch(
+	knx_uring*            uring,
+	knx_transport_handler handler,
+	void*                 data,
+	int                   timeout
+) {
+	ssize_t count = knx_uring_poll(uring, timeout);
+
+	for (ssize_t i = 0; i < count; i++) {
+		const knx_datagram* datagram = &uring->rx_datagrams[i];
+
+		knx_packet packet;
+		bool valid = knx_parse(datagram->frame, datagram->length, &packet) > 0;
+
+		handler(
+			data,
+			&uring->rx_senders[i],
+			datagram->frame,
+			datagram->length,
+			valid ? &packet : NULL
+		);
+
+		if (valid && packet.service == KNX_DESCRIPTION_RESPONSE)
+			knx_description_response_free_services(&packet.payload.description_res);
+		else if (valid && packet.service == KNX_SEARCH_RESPONSE)
+			knx_description_response_free_services(&packet.payload.search_res.description);
+	}
+
+	return count;
+}
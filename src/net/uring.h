@@ -0,0 +1,219 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_NET_URING_H_
+#define KNXPROTO_NET_URING_H_
+
+#include "transport.h"
+#include "../proto/proto.h"
+#include "../proto/batch.h"
+
+#include <linux/io_uring.h>
+#include <netinet/in.h>
+#include <sys/types.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Number of submission queue entries
+ */
+#define KNX_URING_ENTRIES 128
+
+/**
+ * Number of completion queue entries, multishot receives may produce many completions at once
+ */
+#define KNX_URING_COMPLETIONS 1024
+
+/**
+ * Number of receive buffers provided to the kernel (must be a power of 2)
+ */
+#define KNX_URING_BUFFERS 256
+
+/**
+ * Size of a receive buffer, it holds the completion header, the sender address and the datagram
+ */
+#define KNX_URING_BUFFER_SIZE \
+	(sizeof(struct io_uring_recvmsg_out) + sizeof(struct sockaddr_in) + KNX_TRANSPORT_FRAME_SIZE)
+
+/**
+ * Number of frames that can be in flight
+ */
+#define KNX_URING_TX_SLOTS 64
+
+/**
+ * io_uring Transport
+ *
+ * Same role as `knx_transport`, but the socket is driven by an io_uring instance. The socket is
+ * registered with the ring. A single multishot receive stays armed and lets the kernel pick
+ * buffers from a provided buffer ring, so receiving needs no system call at all while
+ * completions are pending. Outgoing frames are generated into send slots and submitted together
+ * with the next `knx_uring_submit` or `knx_uring_poll`.
+ *
+ * One instance can serve any number of gateways, because the socket is not connected.
+ */
+typedef struct {
+	int ring;
+	int sock;
+
+	// Submission queue
+	unsigned*            sq_head;
+	unsigned*            sq_tail;
+	unsigned*            sq_array;
+	unsigned             sq_mask;
+	unsigned             sq_pending;
+	struct io_uring_sqe* sqes;
+
+	// Completion queue
+	unsigned*            cq_head;
+	unsigned*            cq_tail;
+	unsigned             cq_mask;
+	struct io_uring_cqe* cqes;
+
+	void*  ring_memory;
+	size_t ring_size;
+	size_t sqes_size;
+
+	// Provided buffers
+	struct io_uring_buf_ring* buffer_ring;
+	uint8_t*                  buffers;
+	uint16_t                  buffer_tail;
+
+	/**
+	 * Whether the multishot receive is armed
+	 */
+	bool receiving;
+
+	/**
+	 * Message header template for the multishot receive
+	 */
+	struct msghdr rx_msg;
+
+	/**
+	 * Number of datagrams harvested by the last call to `knx_uring_poll`
+	 */
+	size_t rx_count;
+
+	/**
+	 * Received datagrams, they point into the provided buffers
+	 */
+	knx_datagram rx_datagrams[KNX_BATCH_SIZE];
+
+	/**
+	 * Sender of each received datagram
+	 */
+	struct sockaddr_in rx_senders[KNX_BATCH_SIZE];
+
+	uint16_t rx_buffer_ids[KNX_BATCH_SIZE];
+
+	/**
+	 * Number of incoming datagrams that have been dropped because they exceeded
+	 * `KNX_TRANSPORT_FRAME_SIZE`
+	 */
+	size_t rx_truncated;
+
+	/**
+	 * Number of send slots in use (queued or in flight)
+	 */
+	size_t tx_count;
+
+	/**
+	 * Number of outgoing datagrams that have been dropped because sending them failed
+	 */
+	size_t tx_dropped;
+
+	uint8_t            tx_free[KNX_URING_TX_SLOTS];
+	struct sockaddr_in tx_targets[KNX_URING_TX_SLOTS];
+	uint8_t            tx_buffers[KNX_URING_TX_SLOTS][KNX_TRANSPORT_FRAME_SIZE];
+} knx_uring;
+
+/**
+ * Create the socket and the io_uring instance.
+ *
+ * \param uring Instance to initialize
+ * \param local Local address to bind to (may be `NULL` to bind to an ephemeral port)
+ * \returns `true` on success, otherwise `false` (`errno` indicates the error)
+ */
+bool knx_uring_init(knx_uring* uring, const struct sockaddr_in* local);
+
+/**
+ * Close the socket and the io_uring instance.
+ */
+void knx_uring_destroy(knx_uring* uring);
+
+/**
+ * Join a multicast group.
+ *
+ * \see knx_transport_join
+ */
+bool knx_uring_join(knx_uring* uring, in_addr_t group, in_addr_t interface);
+
+/**
+ * Retrieve the local address of the socket.
+ */
+bool knx_uring_local_address(const knx_uring* uring, struct sockaddr_in* local);
+
+/**
+ * Generate a frame into a send slot and prepare its submission.
+ *
+ * \returns `true` if the frame has been queued, `false` if all send slots are in use (call
+ *          `knx_uring_poll` to reap completed sends) or generation failed
+ */
+bool knx_uring_queue(
+	knx_uring*                uring,
+	const struct sockaddr_in* target,
+	knx_service               service,
+	const void*               payload
+);
+
+/**
+ * Submit all prepared operations with a single system call.
+ *
+ * \returns Number of submitted operations or `-1` on error
+ */
+ssize_t knx_uring_submit(knx_uring* uring);
+
+/**
+ * Submit prepared operations, wait for completions and harvest received datagrams into
+ * `rx_datagrams` and `rx_senders`. Buffers handed out by the previous call are returned to the
+ * kernel first. Datagrams larger than `KNX_TRANSPORT_FRAME_SIZE` are dropped and counted in
+ * `rx_truncated`, failed sends are counted in `tx_dropped`.
+ *
+ * \param uring   Instance
+ * \param timeout Milliseconds to wait if nothing has completed yet (`-1` waits indefinitely,
+ *                `0` does not wait)
+ * \returns Number of received datagrams or `-1` on error
+ */
+ssize_t knx_uring_poll(knx_uring* uring, int timeout);
+
+/**
+ * Poll, parse each received datagram and invoke the handler for it.
+ *
+ * \see knx_transport_dispatch
+ */
+ssize_t knx_uring_dispatch(
+	knx_uring*            uring,
+	knx_transport_handler handler,
+	void*                 data,
+	int                   timeout
+);
+
+#endif
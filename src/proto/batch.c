@@ -0,0 +1,112 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "batch.h"
+#include "view.h"
+
+size_t knx_parse_batch(
+	const knx_datagram* datagrams,
+	size_t              count,
+	knx_batch_result*   result
+) {
+	if (count > KNX_BATCH_SIZE)
+		count = KNX_BATCH_SIZE;
+
+	result->count = count;
+
+	// First pass: Validate every header. This loop does not branch on the service, which keeps it
+	// cheap even when most datagrams are dropped later on.
+	for (size_t i = 0; i < count; i++) {
+		const uint8_t* frame = datagrams[i].frame;
+		size_t length = datagrams[i].length;
+
+		result->destination[i] = 0;
+		result->address_type[i] = 0;
+		result->apci[i] = 0;
+
+		if (frame == NULL || length < KNX_HEADER_SIZE) {
+			result->service[i] = 0;
+			result->status[i] = KNX_INVALID_BUFFER;
+			result->payload_offset[i] = 0;
+			result->payload_length[i] = 0;
+			continue;
+		}
+
+		uint16_t packet_length = frame[4] << 8 | frame[5];
+
+		result->service[i] = frame[2] << 8 | frame[3];
+		result->payload_offset[i] = KNX_HEADER_SIZE;
+
+		if (frame[0] != KNX_HEADER_SIZE || frame[1] != 16 || packet_length < KNX_HEADER_SIZE)
+			result->status[i] = KNX_INVALID_HEADER;
+		else if (packet_length > length)
+			result->status[i] = KNX_INVALID_BUFFER;
+		else
+			result->status[i] = 0;
+
+		result->payload_length[i] = result->status[i] == 0 ? packet_length - KNX_HEADER_SIZE : 0;
+	}
+
+	// Second pass: Dispatch on the service and extract L_Data details
+	for (size_t i = 0; i < count; i++) {
+		if (result->status[i] != 0)
+			continue;
+
+		uint16_t service = result->service[i];
+
+		if (service != KNX_TUNNEL_REQUEST && service != KNX_ROUTING_INDICATION) {
+			if (knx_find_service(service) == NULL)
+				result->status[i] = KNX_UNKNOWN_SERVICE;
+
+			continue;
+		}
+
+		knx_frame_view view = {
+			service,
+			datagrams[i].frame + KNX_HEADER_SIZE,
+			result->payload_length[i]
+		};
+
+		const uint8_t* ldata;
+		size_t ldata_length;
+
+		if (!knx_frame_view_ldata(&view, &ldata, &ldata_length)) {
+			result->status[i] = KNX_INVALID_PAYLOAD;
+			continue;
+		}
+
+		result->address_type[i] = ldata[1] >> 7 & 1;
+		result->destination[i] = ldata[4] << 8 | ldata[5];
+
+		// Data TPDU?
+		if (!(ldata[7] & 128) && ldata[6] >= 1) {
+			result->apci[i] = (ldata[7] << 2 & 12) | (ldata[8] >> 6 & 3);
+			result->payload_offset[i] = ldata + 8 - datagrams[i].frame;
+			result->payload_length[i] = ldata[6];
+		} else {
+			// Control TPDUs have no APDU
+			result->payload_offset[i] = 0;
+			result->payload_length[i] = 0;
+		}
+	}
+
+	return count;
+}
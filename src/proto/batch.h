@@ -0,0 +1,117 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_PROTO_BATCH_H_
+#define KNXPROTO_PROTO_BATCH_H_
+
+#include "proto.h"
+
+#include "../util/address.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Maximum number of datagrams processed by one call to `knx_parse_batch`
+ */
+#define KNX_BATCH_SIZE 64
+
+/**
+ * Received datagram
+ */
+typedef struct {
+	/**
+	 * Datagram contents
+	 */
+	const uint8_t* frame;
+
+	/**
+	 * Number of bytes in `frame`
+	 */
+	size_t length;
+} knx_datagram;
+
+/**
+ * Result of a batch parse, stored as a structure of arrays. Index `i` of each array describes
+ * the `i`-th datagram.
+ */
+typedef struct {
+	/**
+	 * Number of valid entries in each array
+	 */
+	size_t count;
+
+	/**
+	 * Service identifier
+	 */
+	uint16_t service[KNX_BATCH_SIZE];
+
+	/**
+	 * `0` if the datagram is valid, otherwise a `knx_parse_error`
+	 */
+	uint8_t status[KNX_BATCH_SIZE];
+
+	/**
+	 * Destination address type (only tunnel requests and routing indications)
+	 */
+	uint8_t address_type[KNX_BATCH_SIZE];
+
+	/**
+	 * Destination address (only tunnel requests and routing indications)
+	 */
+	knx_addr destination[KNX_BATCH_SIZE];
+
+	/**
+	 * Application protocol control information (only data TPDUs)
+	 */
+	uint8_t apci[KNX_BATCH_SIZE];
+
+	/**
+	 * Offset of the payload within the datagram. This points to the APDU in case of tunnel requests
+	 * and routing indications that carry data, otherwise to the service payload after the header.
+	 * Tunnel requests and routing indications with a control TPDU have no payload (`0`).
+	 */
+	uint16_t payload_offset[KNX_BATCH_SIZE];
+
+	/**
+	 * Number of bytes in the payload
+	 */
+	uint16_t payload_length[KNX_BATCH_SIZE];
+} knx_batch_result;
+
+/**
+ * Parse multiple datagrams at once. Headers of all datagrams are validated in a first pass,
+ * frames carrying CEMI data are inspected in a second one. Other services are only checked for a
+ * valid header, use `knx_parse` on the datagram if you need their contents.
+ *
+ * \param datagrams Datagrams to parse
+ * \param count     Number of entries in `datagrams`
+ * \param result    Output structure (must be non-`NULL`)
+ * \returns Number of datagrams that have been processed (at most `KNX_BATCH_SIZE`)
+ */
+size_t knx_parse_batch(
+	const knx_datagram* datagrams,
+	size_t              count,
+	knx_batch_result*   result
+);
+
+#endif
@@ -47,7 +47,43 @@ typedef enum {
 	/**
 	 * L_Data.con
 	 */
-	KNX_CEMI_LDATA_CON = 0x2E
+	KNX_CEMI_LDATA_CON = 0x2E,
+
+	/**
+	 * M_PropRead.req
+	 * \see knx_device_configuration_request
+	 */
+	KNX_CEMI_MPROPREAD_REQ = 0xFC,
+
+	/**
+	 * M_PropRead.con
+	 */
+	KNX_CEMI_MPROPREAD_CON = 0xFB,
+
+	/**
+	 * M_PropWrite.req
+	 */
+	KNX_CEMI_MPROPWRITE_REQ = 0xF6,
+
+	/**
+	 * M_PropWrite.con
+	 */
+	KNX_CEMI_MPROPWRITE_CON = 0xF5,
+
+	/**
+	 * M_PropInfo.ind
+	 */
+	KNX_CEMI_MPROPINFO_IND = 0xF7,
+
+	/**
+	 * M_Reset.req
+	 */
+	KNX_CEMI_MRESET_REQ = 0xF1,
+
+	/**
+	 * M_Reset.ind
+	 */
+	KNX_CEMI_MRESET_IND = 0xF0
 } knx_cemi_service;
 
 /**
@@ -0,0 +1,59 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "classify.h"
+#include "view.h"
+
+knx_class knx_classify(const uint8_t* frame, size_t frame_length) {
+	knx_frame_view view;
+	if (knx_frame_view_init(&view, frame, frame_length) < 0)
+		return 0;
+
+	const uint8_t* ldata;
+	size_t ldata_length;
+
+	// Fails for every service except tunnel requests and routing indications
+	if (!knx_frame_view_ldata(&view, &ldata, &ldata_length))
+		return 0;
+
+	// The CEMI message code precedes the L_Data frame by its additional information
+	uint8_t cemi_service = view.service == KNX_TUNNEL_REQUEST ? view.payload[4] : view.payload[0];
+
+	uint8_t flags = ldata[1] >> 7 & 1;
+	uint8_t apci = 0;
+	uint8_t apdu_length = 0;
+
+	// Data TPDU?
+	if (!(ldata[7] & 128) && ldata[6] >= 1) {
+		flags |= KNX_CLASS_DATA;
+		apci = (ldata[7] << 2 & 12) | (ldata[8] >> 6 & 3);
+		apdu_length = ldata[6];
+	}
+
+	return knx_class_make(
+		view.service,
+		cemi_service,
+		flags,
+		apci,
+		ldata[4] << 8 | ldata[5],
+		apdu_length
+	);
+}
@@ -0,0 +1,118 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_PROTO_CLASSIFY_H_
+#define KNXPROTO_PROTO_CLASSIFY_H_
+
+#include "proto.h"
+
+#include "../util/address.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Packed frame classification
+ *
+ *   +--------+--------+--------+--------+--------+--------+--------+--------+
+ *   | 63..56 | 55..48 | 47..40 | 39..32 | 31..24 | 23..16 | 15..8  | 7..0   |
+ *   +--------+--------+--------+--------+--------+--------+--------+--------+
+ *   | Service         | CEMI   | Flags  | APCI   | Destination     | APDU   |
+ *   |                 | code   |        |        |                 | length |
+ *   +-----------------+--------+--------+--------+-----------------+--------+
+ *
+ * `0` indicates that the frame could not be classified.
+ */
+typedef uint64_t knx_class;
+
+/**
+ * Destination is a group address
+ */
+#define KNX_CLASS_GROUP 1
+
+/**
+ * TPDU carries data, the APCI and APDU length are valid
+ */
+#define KNX_CLASS_DATA  2
+
+/**
+ * Classify a raw tunnel request or routing indication in a single forward pass. Neither
+ * `knx_packet` nor any of its nested structures are populated.
+ *
+ * \param frame        Contains the frame
+ * \param frame_length Length of `frame` in bytes
+ * \returns Packed classification or `0` if the frame is invalid or carries no L_Data frame
+ */
+knx_class knx_classify(const uint8_t* frame, size_t frame_length);
+
+/**
+ * Assemble a classification from its parts.
+ */
+inline static
+knx_class knx_class_make(
+	knx_service service,
+	uint8_t     cemi_service,
+	uint8_t     flags,
+	uint8_t     apci,
+	knx_addr    destination,
+	uint8_t     apdu_length
+) {
+	return
+		(knx_class) (service & 0xFFFF) << 48 |
+		(knx_class) cemi_service << 40 |
+		(knx_class) flags << 32 |
+		(knx_class) apci << 24 |
+		(knx_class) destination << 8 |
+		(knx_class) apdu_length;
+}
+
+/**
+ * Service identifier
+ */
+#define knx_class_service(c)      ((knx_service) ((c) >> 48 & 0xFFFF))
+
+/**
+ * CEMI message code
+ */
+#define knx_class_cemi_service(c) ((knx_cemi_service) ((c) >> 40 & 0xFF))
+
+/**
+ * Combination of `KNX_CLASS_GROUP` and `KNX_CLASS_DATA`
+ */
+#define knx_class_flags(c)        ((uint8_t) ((c) >> 32 & 0xFF))
+
+/**
+ * Application protocol control information
+ */
+#define knx_class_apci(c)         ((knx_apci) ((c) >> 24 & 0xFF))
+
+/**
+ * Destination address
+ */
+#define knx_class_destination(c)  ((knx_addr) ((c) >> 8 & 0xFFFF))
+
+/**
+ * Number of bytes in the APDU
+ */
+#define knx_class_apdu_length(c)  ((size_t) ((c) & 0xFF))
+
+#endif
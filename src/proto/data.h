@@ -223,6 +223,26 @@ typedef int32_t knx_signed32;
  */
 typedef float knx_float32;
 
+/**
+ * Storage for a value of any datapoint type
+ */
+typedef union {
+	knx_bool       bool_value;
+	knx_cvalue     cvalue;
+	knx_cstep      cstep;
+	knx_char       char_value;
+	knx_unsigned8  unsigned8;
+	knx_signed8    signed8;
+	knx_unsigned16 unsigned16;
+	knx_signed16   signed16;
+	knx_float16    float16;
+	knx_timeofday  timeofday;
+	knx_date       date;
+	knx_unsigned32 unsigned32;
+	knx_signed32   signed32;
+	knx_float32    float32;
+} knx_value;
+
 /**
  * Interpret APDU in the given way to produce an instance of a C type.
  */
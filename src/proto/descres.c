@@ -24,41 +24,182 @@
 
 #include <string.h>
 
-bool knx_description_response_parse(
+// Description Response:
+//   Octet 0:     Structure length (54)
+//   Octet 1:     Description type (1 = Device information)
+//   Octet 2:     KNX medium
+//   Octet 3:     Device status
+//   Octet 4-5:   Individual address
+//   Octet 6-7:   Installation ID
+//   Octet 8-13:  Serial number
+//   Octet 14-17: Multicast address
+//   Octet 18-23: MAC address
+//   Octet 24-53: Name
+//   Octet 54:    Structure length (including octets 54 and 55)
+//   Octet 55:    Description type (2 = Supported service families)
+//   Octet 56-n:  Pairs of service family and version
+
+bool knx_description_view_parse(
+	const uint8_t*        buffer,
+	size_t                length,
+	knx_description_view* view
+) {
+	if (length < 56 || buffer[0] != 54 || buffer[1] != 1 || buffer[54] < 2 || buffer[54] % 2 != 0 ||
+	    buffer[55] != 2)
+		return false;
+
+	// The structure length includes its own header
+	view->num_services = (buffer[54] - 2) / 2;
+
+	if (length < 56 + 2 * view->num_services)
+		return false;
+
+	view->medium = buffer[2];
+	view->status = buffer[3];
+	view->address = buffer[4] << 8 | buffer[5];
+	view->id = buffer[6] << 8 | buffer[7];
+
+	memcpy(&view->serial, buffer + 8, 6);
+	memcpy(&view->multicast_address, buffer + 14, 4);
+	memcpy(&view->mac_address, buffer + 18, 6);
+
+	memcpy(&view->name, buffer + 24, 29);
+	view->name[29] = 0;
+
+	view->services = buffer + 56;
+
+	return true;
+}
+
+// Generate everything but the service family pairs
+static
+bool knx_description_view_generate_device(uint8_t* buffer, const knx_description_view* view) {
+	// Service families must fit into a structure with 8-bit length
+	if (view->num_services > (UINT8_MAX - 2) / 2)
+		return false;
+
+	buffer[0] = 54;
+	buffer[1] = 1;
+	buffer[2] = view->medium;
+	buffer[3] = view->status;
+	buffer[4] = view->address >> 8 & 0xFF;
+	buffer[5] = view->address & 0xFF;
+	buffer[6] = view->id >> 8 & 0xFF;
+	buffer[7] = view->id & 0xFF;
+
+	memcpy(buffer + 8, view->serial, 6);
+	memcpy(buffer + 14, &view->multicast_address, 4);
+	memcpy(buffer + 18, view->mac_address, 6);
+
+	// Name is padded with zeros
+	memset(buffer + 24, 0, 30);
+	memcpy(buffer + 24, view->name, strnlen(view->name, 29));
+
+	buffer[54] = 2 + 2 * view->num_services;
+	buffer[55] = 2;
+
+	return true;
+}
+
+bool knx_description_view_generate(uint8_t* buffer, const knx_description_view* view) {
+	if (!knx_description_view_generate_device(buffer, view))
+		return false;
+
+	if (view->num_services > 0)
+		memcpy(buffer + 56, view->services, 2 * view->num_services);
+
+	return true;
+}
+
+// Services are allocated using `malloc` if no arena is given
+static
+bool knx_description_response_parse_into(
 	const uint8_t*            buffer,
 	size_t                    length,
-	knx_description_response* res
+	knx_description_response* res,
+	knx_arena*                arena
 ) {
-	if (length < 56 || buffer[0] != 54 || buffer[1] != 1 || buffer[54] % 2 != 0 || buffer[55] != 2)
-		return false;
+	knx_description_view view;
 
-	res->medium = buffer[2];
-	res->status = buffer[3];
-	res->address = buffer[4] << 8 | buffer[5];
-	res->id = buffer[6] << 8 | buffer[7];
+	if (!knx_description_view_parse(buffer, length, &view))
+		return false;
 
-	memcpy(&res->serial, buffer + 8, 6);
-	memcpy(&res->multicast_address, buffer + 14, 4);
-	memcpy(&res->mac_address, buffer + 18, 6);
+	res->medium = view.medium;
+	res->status = view.status;
+	res->address = view.address;
+	res->id = view.id;
+	res->multicast_address = view.multicast_address;
 
-	memcpy(&res->name, buffer + 24, 29);
-	res->name[29] = 0;
+	memcpy(res->serial, view.serial, 6);
+	memcpy(res->mac_address, view.mac_address, 6);
+	memcpy(res->name, view.name, 30);
 
-	res->num_services = buffer[54] / 2;
+	res->num_services = view.num_services;
 
 	if (res->num_services == 0) {
 		res->services = NULL;
 		return true;
 	}
 
-	buffer += 56;
-	length -= 56;
+	if (arena)
+		res->services = knx_arena_newa(arena, knx_description_service, res->num_services);
+	else
+		res->services = newa(knx_description_service, res->num_services);
+
+	if (!res->services)
+		return false;
+
+	knx_description_service_iter iter;
+	knx_description_service_iter_init(&iter, &view);
 
-	res->services = newa(knx_description_service, res->num_services);
+	for (size_t i = 0; knx_description_service_iter_next(&iter, &res->services[i]); i++);
+
+	return true;
+}
+
+bool knx_description_response_parse(
+	const uint8_t*            buffer,
+	size_t                    length,
+	knx_description_response* res
+) {
+	return knx_description_response_parse_into(buffer, length, res, NULL);
+}
+
+bool knx_description_response_parse_arena(
+	const uint8_t*            buffer,
+	size_t                    length,
+	knx_description_response* res,
+	knx_arena*                arena
+) {
+	return knx_description_response_parse_into(buffer, length, res, arena);
+}
+
+bool knx_description_response_generate(uint8_t* buffer, const knx_description_response* res) {
+	knx_description_view view = {
+		res->medium,
+		res->status,
+		res->address,
+		res->id,
+		{0},
+		res->multicast_address,
+		{0},
+		{0},
+		NULL,
+		res->num_services
+	};
+
+	memcpy(view.serial, res->serial, 6);
+	memcpy(view.mac_address, res->mac_address, 6);
+	memcpy(view.name, res->name, 30);
+
+	if (!knx_description_view_generate_device(buffer, &view))
+		return false;
+
+	buffer += 56;
 
-	for (size_t i = 0; i < res->num_services && length >= 2; length -= 2, buffer += 2, i++) {
-		res->services[i].family = buffer[0];
-		res->services[i].version = buffer[1];
+	for (size_t i = 0; i < res->num_services; i++) {
+		*buffer++ = res->services[i].family;
+		*buffer++ = res->services[i].version;
 	}
 
 	return true;
@@ -23,6 +23,7 @@
 #define KNXPROTO_PROTO_DESCRES_H_
 
 #include "../util/address.h"
+#include "../util/arena.h"
 
 #include <arpa/inet.h>
 #include <stdint.h>
@@ -110,6 +111,133 @@ bool knx_description_response_parse(
 	knx_description_response* res
 );
 
+/**
+ * Parse a raw description response. The `services` array is allocated in the given arena and
+ * must not be freed using `knx_description_response_free_services`.
+ *
+ * \param message        Raw description response
+ * \param message_length Number of bytes in `message`
+ * \param res            Output description response
+ * \param arena          Arena which holds the `services` array
+ */
+bool knx_description_response_parse_arena(
+	const uint8_t*            message,
+	size_t                    message_length,
+	knx_description_response* res,
+	knx_arena*                arena
+);
+
+/**
+ * Generate a raw description response.
+ *
+ * \see knx_description_response_size
+ * \param buffer Output buffer, you have to make sure there is enough space
+ * \param res    Input description response
+ * \returns `true` if the response has been generated successfully, otherwise `false`
+ */
+bool knx_description_response_generate(uint8_t* buffer, const knx_description_response* res);
+
+/**
+ * Description Response View
+ *
+ * Carries the same information as `knx_description_response`, but the supported service families
+ * remain in the raw buffer, so parsing does not allocate. The buffer must outlive the view.
+ * Service families are enumerated using `knx_description_service_iter`.
+ */
+typedef struct {
+	uint8_t   medium;
+	uint8_t   status;
+	knx_addr  address;
+	uint16_t  id;
+	uint8_t   serial[6];
+	in_addr_t multicast_address;
+	uint8_t   mac_address[6];
+	char      name[30];
+
+	/**
+	 * Raw pairs of service family and version
+	 */
+	const uint8_t* services;
+
+	/**
+	 * Number of pairs in `services`
+	 */
+	size_t num_services;
+} knx_description_view;
+
+/**
+ * Iterator over the service families of a `knx_description_view`
+ */
+typedef struct {
+	const uint8_t* next;
+	const uint8_t* end;
+} knx_description_service_iter;
+
+/**
+ * Parse a raw description response without allocating.
+ *
+ * \param message        Raw description response
+ * \param message_length Number of bytes in `message`
+ * \param view           Output view, `services` points into `message`
+ * \returns `true` if parsing was successful, `false` if the response is malformed or truncated
+ */
+bool knx_description_view_parse(
+	const uint8_t*        message,
+	size_t                message_length,
+	knx_description_view* view
+);
+
+/**
+ * Generate a raw description response from a view. `services` may point to any array of
+ * `2 * num_services` bytes.
+ *
+ * \see knx_description_view_size
+ * \param buffer Output buffer, you have to make sure there is enough space
+ * \param view   Input view
+ * \returns `true` if the response has been generated successfully, otherwise `false`
+ */
+bool knx_description_view_generate(uint8_t* buffer, const knx_description_view* view);
+
+/**
+ * Description response size
+ */
+inline static
+size_t knx_description_view_size(const knx_description_view* view) {
+	return 56 + 2 * view->num_services;
+}
+
+/**
+ * Start iterating over the service families of a view.
+ */
+inline static
+void knx_description_service_iter_init(
+	knx_description_service_iter* iter,
+	const knx_description_view*   view
+) {
+	iter->next = view->services;
+	iter->end = view->services + 2 * view->num_services;
+}
+
+/**
+ * Retrieve the next service family.
+ *
+ * \returns `true` if `service` has been filled in, `false` at the end
+ */
+inline static
+bool knx_description_service_iter_next(
+	knx_description_service_iter* iter,
+	knx_description_service*      service
+) {
+	if (iter->next >= iter->end)
+		return false;
+
+	service->family = iter->next[0];
+	service->version = iter->next[1];
+	iter->next += 2;
+
+	return true;
+}
+
 /**
  * Free the dynamically allocated `services` array.
  */
@@ -0,0 +1,60 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "devconfreq.h"
+
+#include <string.h>
+
+// Device Configuration Request:
+//   Octet 0:   Structure length
+//   Octet 1:   Channel
+//   Octet 2:   Sequence number
+//   Octet 3:   Reserved
+//   Octet 4-n: CEMI frame
+
+void knx_device_configuration_request_generate(
+	uint8_t*                                buffer,
+	const knx_device_configuration_request* req
+) {
+	*buffer++ = 4;
+	*buffer++ = req->channel;
+	*buffer++ = req->seq_number;
+	*buffer++ = 0;
+
+	memcpy(buffer, req->cemi, req->cemi_length);
+}
+
+bool knx_device_configuration_request_parse(
+	const uint8_t*                    message,
+	size_t                            message_length,
+	knx_device_configuration_request* req
+) {
+	// At least the message code must be present
+	if (message_length < 5 || message[0] != 4)
+		return false;
+
+	req->channel = message[1];
+	req->seq_number = message[2];
+	req->cemi = message + 4;
+	req->cemi_length = message_length - 4;
+
+	return true;
+}
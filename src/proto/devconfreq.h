@@ -0,0 +1,92 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_PROTO_DEVCONFREQ_H_
+#define KNXPROTO_PROTO_DEVCONFREQ_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Device Configuration Request
+ *
+ * Unlike tunnel requests, device configuration requests carry device management messages
+ * (M_PropRead, M_PropWrite, M_Reset, ...) instead of L_Data frames. The CEMI frame is therefore
+ * kept raw.
+ */
+typedef struct {
+	/**
+	 * Communication channel
+	 */
+	uint8_t channel;
+
+	/**
+	 * Sequence number
+	 */
+	uint8_t seq_number;
+
+	/**
+	 * Raw CEMI frame, starting with the message code
+	 */
+	const uint8_t* cemi;
+
+	/**
+	 * Number of bytes in `cemi`
+	 */
+	size_t cemi_length;
+} knx_device_configuration_request;
+
+/**
+ * Generate a raw device configuration request.
+ *
+ * \see knx_device_configuration_request_size
+ * \param buffer Output buffer, you have to make sure there is enough space
+ * \param req    Input device configuration request
+ */
+void knx_device_configuration_request_generate(
+	uint8_t*                                buffer,
+	const knx_device_configuration_request* req
+);
+
+/**
+ * Parse a raw device configuration request. `cemi` will point into `message`.
+ *
+ * \param message        Raw device configuration request
+ * \param message_length Number of bytes in `message`
+ * \param req            Output device configuration request
+ * \returns `true` if parsing was successful, otherwise `false`
+ */
+bool knx_device_configuration_request_parse(
+	const uint8_t*                    message,
+	size_t                            message_length,
+	knx_device_configuration_request* req
+);
+
+/**
+ * Device configuration request size
+ */
+inline static
+size_t knx_device_configuration_request_size(const knx_device_configuration_request* req) {
+	return 4 + req->cemi_length;
+}
+
+#endif
@@ -33,7 +33,7 @@ typedef enum {
 	KNX_PROTO_UDP = 1,
 
 	/**
-	 * \note For reference only
+	 * \note Frames received via TCP have to be split using `knx_stream`
 	 */
 	KNX_PROTO_TCP = 2
 } knx_proto;
@@ -0,0 +1,168 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "iov.h"
+
+#include <string.h>
+
+inline static
+void knx_frame_iov_append(knx_frame_iov* frame, const void* base, size_t length) {
+	if (length == 0)
+		return;
+
+	frame->iov[frame->iov_count].iov_base = (void*) base;
+	frame->iov[frame->iov_count].iov_len = length;
+	frame->iov_count++;
+}
+
+// Scatter layout:
+//   Scratch:    KNXnet/IP header, connection header (if any), CEMI header
+//   In-place:   CEMI additional information
+//   Scratch:    L_Data header, TPDU header and first APDU octet (shares bits with the APCI)
+//   In-place:   Remaining APDU octets
+
+static
+size_t knx_generate_iov_cemi(
+	knx_frame_iov*     frame,
+	knx_service        service,
+	const uint8_t*     connection_header,
+	const knx_cemi*    cemi
+) {
+	switch (cemi->service) {
+		case KNX_CEMI_LDATA_IND:
+		case KNX_CEMI_LDATA_REQ:
+		case KNX_CEMI_LDATA_CON:
+			break;
+
+		default:
+			return 0;
+	}
+
+	const knx_ldata* ldata = &cemi->payload.ldata;
+	size_t add_info_length = cemi->add_info ? cemi->add_info_length : 0;
+	size_t connection_header_length = connection_header ? 4 : 0;
+
+	size_t tpdu_length = knx_tpdu_size(&ldata->tpdu);
+	size_t payload_length =
+		connection_header_length +
+		KNX_CEMI_HEADER_SIZE + add_info_length +
+		KNX_LDATA_HEADER_SIZE + tpdu_length;
+
+	uint8_t* scratch = frame->scratch;
+
+	if (!knx_header_generate(scratch, service, payload_length))
+		return 0;
+
+	scratch += KNX_HEADER_SIZE;
+
+	if (connection_header) {
+		memcpy(scratch, connection_header, 4);
+		scratch += 4;
+	}
+
+	*scratch++ = cemi->service;
+	*scratch++ = add_info_length;
+
+	knx_frame_iov_append(frame, frame->scratch, scratch - frame->scratch);
+	knx_frame_iov_append(frame, cemi->add_info, add_info_length);
+
+	uint8_t* ldata_header = scratch;
+
+	if (!knx_ldata_header_generate(scratch, ldata, tpdu_length))
+		return 0;
+
+	scratch += KNX_LDATA_HEADER_SIZE;
+
+	if (ldata->tpdu.tpci == KNX_TPCI_UNNUMBERED_DATA || ldata->tpdu.tpci == KNX_TPCI_NUMBERED_DATA) {
+		// Generate the TPDU header including the first APDU octet only
+		knx_tpdu head = ldata->tpdu;
+		if (head.info.data.length > 1)
+			head.info.data.length = 1;
+
+		memset(scratch, 0, 2);
+		knx_tpdu_generate(scratch, &head);
+		scratch += 2;
+
+		knx_frame_iov_append(frame, ldata_header, scratch - ldata_header);
+
+		if (ldata->tpdu.info.data.length > 1)
+			knx_frame_iov_append(
+				frame,
+				ldata->tpdu.info.data.payload + 1,
+				ldata->tpdu.info.data.length - 1
+			);
+	} else {
+		knx_tpdu_generate(scratch++, &ldata->tpdu);
+		knx_frame_iov_append(frame, ldata_header, scratch - ldata_header);
+	}
+
+	return frame->iov_count;
+}
+
+size_t knx_generate_iov(knx_frame_iov* frame, knx_service service, const void* payload) {
+	frame->iov_count = 0;
+
+	switch (service) {
+		case KNX_TUNNEL_REQUEST: {
+			const knx_tunnel_request* req = payload;
+			const uint8_t connection_header[4] = {4, req->channel, req->seq_number, 0};
+
+			return knx_generate_iov_cemi(frame, service, connection_header, &req->data);
+		}
+
+		case KNX_DEVICE_CONFIGURATION_REQUEST: {
+			const knx_device_configuration_request* req = payload;
+			size_t length = knx_device_configuration_request_size(req);
+
+			if (!knx_header_generate(frame->scratch, service, length))
+				return 0;
+
+			// Headers in scratch, the raw CEMI frame in-place
+			uint8_t* connection_header = frame->scratch + KNX_HEADER_SIZE;
+			connection_header[0] = 4;
+			connection_header[1] = req->channel;
+			connection_header[2] = req->seq_number;
+			connection_header[3] = 0;
+
+			knx_frame_iov_append(frame, frame->scratch, KNX_HEADER_SIZE + 4);
+			knx_frame_iov_append(frame, req->cemi, req->cemi_length);
+
+			return frame->iov_count;
+		}
+
+		case KNX_ROUTING_INDICATION: {
+			const knx_routing_indication* ind = payload;
+			return knx_generate_iov_cemi(frame, service, NULL, &ind->data);
+		}
+
+		default: {
+			// Small services fit into the scratch area entirely
+			size_t length = knx_size(service, payload);
+
+			if (length <= KNX_HEADER_SIZE || length > KNX_IOV_SCRATCH_SIZE ||
+			    !knx_generate(frame->scratch, service, payload))
+				return 0;
+
+			knx_frame_iov_append(frame, frame->scratch, length);
+			return frame->iov_count;
+		}
+	}
+}
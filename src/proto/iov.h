@@ -0,0 +1,79 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_PROTO_IOV_H_
+#define KNXPROTO_PROTO_IOV_H_
+
+#include "proto.h"
+
+#include <sys/uio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Size of the scratch area used for the generated parts of a frame
+ */
+#define KNX_IOV_SCRATCH_SIZE 32
+
+/**
+ * Maximum number of I/O vectors needed to describe a frame
+ */
+#define KNX_IOV_MAX 4
+
+/**
+ * Frame that is scattered over multiple buffers.
+ *
+ * Small generated pieces (headers and control fields) reside within `scratch`, bulk data like the
+ * APDU payload and CEMI additional information is referenced in-place. Therefore the frame is
+ * only valid as long as the payload structure used to generate it refers to valid memory.
+ */
+typedef struct {
+	/**
+	 * Storage for generated pieces
+	 */
+	uint8_t scratch[KNX_IOV_SCRATCH_SIZE];
+
+	/**
+	 * I/O vectors (e.g. for `sendmsg`)
+	 */
+	struct iovec iov[KNX_IOV_MAX];
+
+	/**
+	 * Number of valid entries in `iov`
+	 */
+	size_t iov_count;
+} knx_frame_iov;
+
+/**
+ * Generate a message without copying its bulk payload. Tunnel requests and routing indications
+ * refer to the APDU and additional information of the given payload structure, device
+ * configuration requests refer to their raw CEMI frame. Other services are generated into the
+ * scratch area entirely, if they fit.
+ *
+ * \note Do not move `frame` after generation, `iov` may point into `scratch`.
+ * \param frame   Output frame
+ * \param service Service identifier
+ * \param payload Pointer to a payload structure
+ * \returns Number of I/O vectors (stored in `frame->iov_count`) or `0` on failure
+ */
+size_t knx_generate_iov(knx_frame_iov* frame, knx_service service, const void* payload);
+
+#endif
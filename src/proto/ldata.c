@@ -24,9 +24,7 @@
 
 #include <string.h>
 
-bool knx_ldata_generate(uint8_t* buffer, const knx_ldata* req) {
-	size_t tpdu_length = knx_tpdu_size(&req->tpdu);
-
+bool knx_ldata_header_generate(uint8_t* buffer, const knx_ldata* req, size_t tpdu_length) {
 	if (tpdu_length == 0 || tpdu_length > UINT8_MAX + 1)
 		return false;
 
@@ -47,7 +45,15 @@ bool knx_ldata_generate(uint8_t* buffer, const knx_ldata* req) {
 	*buffer++ = req->destination & 0xFF;
 
 	*buffer++ = tpdu_length - 1;
-	knx_tpdu_generate(buffer, &req->tpdu);
+
+	return true;
+}
+
+bool knx_ldata_generate(uint8_t* buffer, const knx_ldata* req) {
+	if (!knx_ldata_header_generate(buffer, req, knx_tpdu_size(&req->tpdu)))
+		return false;
+
+	knx_tpdu_generate(buffer + KNX_LDATA_HEADER_SIZE, &req->tpdu);
 
 	return true;
 }
@@ -76,14 +82,89 @@ bool knx_ldata_parse(const uint8_t* buffer, size_t buffer_length, knx_ldata* out
 }
 
 size_t knx_ldata_size(const knx_ldata* req) {
-	return 7 + knx_tpdu_size(&req->tpdu);
+	return KNX_LDATA_HEADER_SIZE + knx_tpdu_size(&req->tpdu);
 }
 
-knx_ldata* knx_ldata_duplicate(const knx_ldata* data) {
+bool knx_ldata_pack(knx_ldata_packed* packed, const knx_ldata* ldata) {
+	uint8_t header[KNX_LDATA_HEADER_SIZE];
+	size_t tpdu_length = knx_tpdu_size(&ldata->tpdu);
+
+	if (tpdu_length > KNX_LDATA_PACKED_TPDU_SIZE ||
+	    !knx_ldata_header_generate(header, ldata, tpdu_length))
+		return false;
+
+	packed->control1 = header[0];
+	packed->control2 = header[1];
+	packed->source = ldata->source;
+	packed->destination = ldata->destination;
+	packed->tpdu_length = tpdu_length;
+
+	// Generating the TPDU merges the APCI into the second byte
+	packed->tpdu[1] = 0;
+	knx_tpdu_generate(packed->tpdu, &ldata->tpdu);
+
+	return true;
+}
+
+bool knx_ldata_unpack(const knx_ldata_packed* packed, knx_ldata* ldata) {
+	ldata->control1.repeat = knx_ldata_packed_repeat(packed);
+	ldata->control1.system_broadcast = knx_ldata_packed_system_broadcast(packed);
+	ldata->control1.priority = knx_ldata_packed_priority(packed);
+	ldata->control1.request_ack = knx_ldata_packed_request_ack(packed);
+	ldata->control1.error = knx_ldata_packed_error(packed);
+
+	ldata->control2.address_type = knx_ldata_packed_address_type(packed);
+	ldata->control2.hops = knx_ldata_packed_hops(packed);
+
+	ldata->source = packed->source;
+	ldata->destination = packed->destination;
+
+	return knx_tpdu_parse(packed->tpdu, packed->tpdu_length, &ldata->tpdu);
+}
+
+bool knx_ldata_packed_parse(const uint8_t* buffer, size_t buffer_length, knx_ldata_packed* packed) {
+	// Same checks as `knx_ldata_parse`, the TPDU length must fit a standard frame
+	if (buffer_length < 8 || (buffer[1] & 15) || buffer[6] >= KNX_LDATA_PACKED_TPDU_SIZE ||
+	    ((size_t) buffer[6]) + 8 > buffer_length)
+		return false;
+
+	packed->control1 = buffer[0];
+	packed->control2 = buffer[1];
+	packed->source = buffer[2] << 8 | buffer[3];
+	packed->destination = buffer[4] << 8 | buffer[5];
+	packed->tpdu_length = buffer[6] + 1;
+
+	memcpy(packed->tpdu, buffer + 7, packed->tpdu_length);
+
+	// Data TPDUs need the APCI byte
+	knx_tpci tpci = knx_ldata_packed_tpci(packed);
+	return packed->tpdu_length >= 2 ||
+	       tpci == KNX_TPCI_UNNUMBERED_CONTROL || tpci == KNX_TPCI_NUMBERED_CONTROL;
+}
+
+void knx_ldata_packed_generate(uint8_t* buffer, const knx_ldata_packed* packed) {
+	*buffer++ = packed->control1;
+	*buffer++ = packed->control2;
+
+	*buffer++ = packed->source >> 8 & 0xFF;
+	*buffer++ = packed->source & 0xFF;
+
+	*buffer++ = packed->destination >> 8 & 0xFF;
+	*buffer++ = packed->destination & 0xFF;
+
+	*buffer++ = packed->tpdu_length - 1;
+
+	memcpy(buffer, packed->tpdu, packed->tpdu_length);
+}
+
+// Memory is obtained using `malloc` if no arena is given
+static
+knx_ldata* knx_ldata_duplicate_into(const knx_ldata* data, knx_arena* arena) {
 	switch (data->tpdu.tpci) {
 		case KNX_TPCI_UNNUMBERED_DATA:
 		case KNX_TPCI_NUMBERED_DATA: {
-			knx_ldata* copy = malloc(sizeof(knx_ldata) + data->tpdu.info.data.length);
+			size_t size = sizeof(knx_ldata) + data->tpdu.info.data.length;
+			knx_ldata* copy = arena ? knx_arena_alloc(arena, size) : malloc(size);
 
 			if (copy) {
 				memcpy(copy, data, sizeof(knx_ldata));
@@ -99,7 +180,7 @@ knx_ldata* knx_ldata_duplicate(const knx_ldata* data) {
 
 		case KNX_TPCI_UNNUMBERED_CONTROL:
 		case KNX_TPCI_NUMBERED_CONTROL: {
-			knx_ldata* copy = new(knx_ldata);
+			knx_ldata* copy = arena ? knx_arena_new(arena, knx_ldata) : new(knx_ldata);
 
 			if (copy) {
 				memcpy(copy, data, sizeof(knx_ldata));
@@ -112,3 +193,11 @@ knx_ldata* knx_ldata_duplicate(const knx_ldata* data) {
 			return NULL;
 	}
 }
+
+knx_ldata* knx_ldata_duplicate(const knx_ldata* data) {
+	return knx_ldata_duplicate_into(data, NULL);
+}
+
+knx_ldata* knx_ldata_duplicate_arena(const knx_ldata* data, knx_arena* arena) {
+	return knx_ldata_duplicate_into(data, arena);
+}
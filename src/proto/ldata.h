@@ -25,6 +25,7 @@
 #include "tpdu.h"
 
 #include "../util/address.h"
+#include "../util/arena.h"
 
 #include <stdbool.h>
 
@@ -120,6 +121,22 @@ typedef struct {
  */
 bool knx_ldata_generate(uint8_t* buffer, const knx_ldata* ldata);
 
+/**
+ * L_Data header size (control fields, addresses and TPDU length)
+ */
+#define KNX_LDATA_HEADER_SIZE 7
+
+/**
+ * Generate the header of a raw L_Data frame. The TPDU has to be generated separately.
+ *
+ * \see KNX_LDATA_HEADER_SIZE
+ * \param buffer      Output buffer, you have to make sure there is enough space
+ * \param ldata       Input L_Data frame
+ * \param tpdu_length Result of `knx_tpdu_size` for the TPDU of `ldata`
+ * \returns `true` if the header has been generated successfully, otherwise `false`
+ */
+bool knx_ldata_header_generate(uint8_t* buffer, const knx_ldata* ldata, size_t tpdu_length);
+
 /**
  * Parse a raw L_Data frame.
  *
@@ -140,4 +157,159 @@ size_t knx_ldata_size(const knx_ldata* req);
  */
 knx_ldata* knx_ldata_duplicate(const knx_ldata* data);
 
+/**
+ * Duplicate the L_Data structure including the data it might refer to. The copy lives in the
+ * given arena and is released together with it.
+ */
+knx_ldata* knx_ldata_duplicate_arena(const knx_ldata* data, knx_arena* arena);
+
+/**
+ * Maximum TPDU length of a standard frame
+ */
+#define KNX_LDATA_PACKED_TPDU_SIZE 16
+
+/**
+ * Packed L_Data Frame
+ *
+ * Compact representation of a standard frame (24 bytes) for history buffers, queues and caches.
+ * The control fields and the TPDU are kept in their wire format and decoded by the accessors
+ * below. Values are self-contained and can be copied by assignment.
+ */
+typedef struct {
+	/**
+	 * Raw control field 1
+	 */
+	uint8_t control1;
+
+	/**
+	 * Raw control field 2
+	 */
+	uint8_t control2;
+
+	knx_addr source;
+	knx_addr destination;
+
+	/**
+	 * Number of bytes in `tpdu`
+	 */
+	uint8_t tpdu_length;
+
+	/**
+	 * Raw TPDU, the first two bytes contain TPCI and APCI
+	 */
+	uint8_t tpdu[KNX_LDATA_PACKED_TPDU_SIZE];
+} knx_ldata_packed;
+
+/**
+ * Pack an L_Data frame.
+ *
+ * \returns `true` on success, `false` if it is not a standard frame
+ */
+bool knx_ldata_pack(knx_ldata_packed* packed, const knx_ldata* ldata);
+
+/**
+ * Unpack an L_Data frame. `ldata.tpdu.info.data.payload` points into `packed`.
+ *
+ * \returns `true` on success, `false` if the TPDU is malformed
+ */
+bool knx_ldata_unpack(const knx_ldata_packed* packed, knx_ldata* ldata);
+
+/**
+ * Parse a raw L_Data frame straight into its packed representation.
+ *
+ * \param buffer        Raw frame
+ * \param buffer_length Number of bytes in `buffer`
+ * \param packed        Output frame
+ * \returns `true` if parsing was successful, `false` if the frame is malformed or not a standard
+ *          frame
+ */
+bool knx_ldata_packed_parse(const uint8_t* buffer, size_t buffer_length, knx_ldata_packed* packed);
+
+/**
+ * Generate a raw L_Data frame from its packed representation.
+ *
+ * \see knx_ldata_packed_size
+ * \param buffer Output buffer, you have to make sure there is enough space
+ * \param packed Input frame
+ */
+void knx_ldata_packed_generate(uint8_t* buffer, const knx_ldata_packed* packed);
+
+/**
+ * Calculate the required space for the given packed L_Data frame.
+ */
+inline static
+size_t knx_ldata_packed_size(const knx_ldata_packed* packed) {
+	return KNX_LDATA_HEADER_SIZE + packed->tpdu_length;
+}
+
+inline static
+knx_ldata_prio knx_ldata_packed_priority(const knx_ldata_packed* packed) {
+	return packed->control1 >> 2 & 3;
+}
+
+inline static
+bool knx_ldata_packed_repeat(const knx_ldata_packed* packed) {
+	return !(packed->control1 >> 5 & 1);
+}
+
+inline static
+bool knx_ldata_packed_system_broadcast(const knx_ldata_packed* packed) {
+	return !(packed->control1 >> 4 & 1);
+}
+
+inline static
+bool knx_ldata_packed_request_ack(const knx_ldata_packed* packed) {
+	return packed->control1 >> 1 & 1;
+}
+
+inline static
+bool knx_ldata_packed_error(const knx_ldata_packed* packed) {
+	return packed->control1 & 1;
+}
+
+inline static
+knx_ldata_addr_type knx_ldata_packed_address_type(const knx_ldata_packed* packed) {
+	return packed->control2 >> 7 & 1;
+}
+
+inline static
+unsigned knx_ldata_packed_hops(const knx_ldata_packed* packed) {
+	return packed->control2 >> 4 & 7;
+}
+
+inline static
+knx_tpci knx_ldata_packed_tpci(const knx_ldata_packed* packed) {
+	return packed->tpdu[0] >> 6 & 3;
+}
+
+inline static
+uint8_t knx_ldata_packed_seq_number(const knx_ldata_packed* packed) {
+	return packed->tpdu[0] >> 2 & 15;
+}
+
+/**
+ * APCI of a data TPDU.
+ */
+inline static
+knx_apci knx_ldata_packed_apci(const knx_ldata_packed* packed) {
+	return (packed->tpdu[0] << 2 & 12) | (packed->tpdu[1] >> 6 & 3);
+}
+
+/**
+ * APDU of a data TPDU.
+ * \note The two most significant bits of the first byte are part of the APCI
+ */
+inline static
+const uint8_t* knx_ldata_packed_apdu(const knx_ldata_packed* packed) {
+	return packed->tpdu + 1;
+}
+
+/**
+ * Number of bytes in the APDU.
+ */
+inline static
+size_t knx_ldata_packed_apdu_length(const knx_ldata_packed* packed) {
+	return packed->tpdu_length - 1;
+}
+
 #endif
@@ -74,190 +74,479 @@ ssize_t knx_unpack_header(
 	return packet_length;
 }
 
-ssize_t knx_parse(
-	const uint8_t* frame,
-	size_t         frame_length,
-	knx_packet*    output
-) {
-	// Unpack (and validate) header
-	ssize_t unpack_result = knx_unpack_header(frame, frame_length, &output->service);
-	if (unpack_result < 0)
-		return unpack_result;
+// Adapters which erase the payload type of each individual codec
 
-	// Packet length must not exceed the frame length
-	if ((unsigned) unpack_result > frame_length)
-		return -KNX_INVALID_BUFFER;
+#define knx_codec_parser(name)                                                            \
+	static                                                                                \
+	bool knx_codec_parse_##name(const uint8_t* message, size_t length, void* payload) {  \
+		return knx_##name##_parse(message, length, payload);                              \
+	}
 
-	// Determine payload bounds
-	const uint8_t* payload = frame + KNX_HEADER_SIZE;
-	size_t payload_length = unpack_result - KNX_HEADER_SIZE;
+#define knx_codec_generator(name)                                                         \
+	static                                                                                \
+	bool knx_codec_generate_##name(uint8_t* buffer, const void* payload) {               \
+		return knx_##name##_generate(buffer, payload);                                    \
+	}
+
+#define knx_codec_void_generator(name)                                                    \
+	static                                                                                \
+	bool knx_codec_generate_##name(uint8_t* buffer, const void* payload) {               \
+		knx_##name##_generate(buffer, payload);                                           \
+		return true;                                                                      \
+	}
+
+#define knx_codec_sizer(name)                                                             \
+	static                                                                                \
+	size_t knx_codec_size_##name(const void* payload) {                                   \
+		return knx_##name##_size(payload);                                                \
+	}
+
+knx_codec_parser(connection_request)
+knx_codec_void_generator(connection_request)
+
+knx_codec_parser(connection_response)
+knx_codec_void_generator(connection_response)
+knx_codec_sizer(connection_response)
+
+knx_codec_parser(connection_state_request)
+knx_codec_void_generator(connection_state_request)
+
+knx_codec_parser(connection_state_response)
+knx_codec_void_generator(connection_state_response)
+
+knx_codec_parser(disconnect_request)
+knx_codec_void_generator(disconnect_request)
+
+knx_codec_parser(disconnect_response)
+knx_codec_void_generator(disconnect_response)
+
+knx_codec_parser(tunnel_request)
+knx_codec_generator(tunnel_request)
+knx_codec_sizer(tunnel_request)
+
+knx_codec_parser(device_configuration_request)
+knx_codec_void_generator(device_configuration_request)
+knx_codec_sizer(device_configuration_request)
+
+knx_codec_parser(tunnel_response)
+knx_codec_void_generator(tunnel_response)
 
-	switch (output->service) {
-		case KNX_CONNECTION_REQUEST:
-			return knx_connection_request_parse(
-				payload,
-				payload_length,
-				&output->payload.conn_req
-			) ? unpack_result : -KNX_INVALID_PAYLOAD;
-
-		case KNX_CONNECTION_RESPONSE:
-			return knx_connection_response_parse(
-				payload,
-				payload_length,
-				&output->payload.conn_res
-			) ? unpack_result : -KNX_INVALID_PAYLOAD;
-
-		case KNX_CONNECTION_STATE_REQUEST:
-			return knx_connection_state_request_parse(
-				payload,
-				payload_length,
-				&output->payload.conn_state_req
-			) ? unpack_result : -KNX_INVALID_PAYLOAD;
-
-		case KNX_CONNECTION_STATE_RESPONSE:
-			return knx_connection_state_response_parse(
-				payload,
-				payload_length,
-				&output->payload.conn_state_res
-			) ? unpack_result : -KNX_INVALID_PAYLOAD;
-
-		case KNX_DISCONNECT_REQUEST:
-			return knx_disconnect_request_parse(
-				payload,
-				payload_length,
-				&output->payload.dc_req
-			) ? unpack_result : -KNX_INVALID_PAYLOAD;
-
-		case KNX_DISCONNECT_RESPONSE:
-			return knx_disconnect_response_parse(
-				payload,
-				payload_length,
-				&output->payload.dc_res
-			) ? unpack_result : -KNX_INVALID_PAYLOAD;
-
-		case KNX_TUNNEL_REQUEST:
-			return knx_tunnel_request_parse(
-				payload,
-				payload_length,
-				&output->payload.tunnel_req
-			) ? unpack_result : -KNX_INVALID_PAYLOAD;
-
-		case KNX_TUNNEL_RESPONSE:
-			return knx_tunnel_response_parse(
-				payload,
-				payload_length,
-				&output->payload.tunnel_res
-			) ? unpack_result : -KNX_INVALID_PAYLOAD;
-
-		case KNX_ROUTING_INDICATION:
-			return knx_routing_indication_parse(
-				payload,
-				payload_length,
-				&output->payload.routing_ind
-			) ? unpack_result : -KNX_INVALID_PAYLOAD;
-
-		case KNX_DESCRIPTION_REQUEST:
-			return knx_description_request_parse(
-				payload,
-				payload_length,
-				&output->payload.description_req
-			) ? unpack_result : -KNX_INVALID_PAYLOAD;
-
-		case KNX_DESCRIPTION_RESPONSE:
-			return knx_description_response_parse(
-				payload,
-				payload_length,
-				&output->payload.description_res
-			) ? unpack_result : -KNX_INVALID_PAYLOAD;
+knx_codec_parser(routing_indication)
+knx_codec_generator(routing_indication)
+knx_codec_sizer(routing_indication)
+
+knx_codec_parser(routing_lost_message)
+knx_codec_void_generator(routing_lost_message)
+
+knx_codec_parser(routing_busy)
+knx_codec_void_generator(routing_busy)
+
+knx_codec_parser(description_request)
+knx_codec_void_generator(description_request)
+
+knx_codec_parser(description_response)
+knx_codec_generator(description_response)
+knx_codec_sizer(description_response)
+
+knx_codec_parser(search_response)
+knx_codec_generator(search_response)
+knx_codec_sizer(search_response)
+
+// Single-pass generators for services which carry a CEMI frame. Each nested length is computed
+// exactly once and checked against the remaining capacity before anything is written.
+
+static
+ssize_t knx_cemi_generate_bounded(uint8_t* buffer, size_t capacity, const knx_cemi* cemi) {
+	switch (cemi->service) {
+		case KNX_CEMI_LDATA_IND:
+		case KNX_CEMI_LDATA_REQ:
+		case KNX_CEMI_LDATA_CON:
+			break;
 
 		default:
-			return -KNX_UNKNOWN_SERVICE;
+			return -KNX_INVALID_PAYLOAD;
 	}
+
+	const knx_ldata* ldata = &cemi->payload.ldata;
+
+	size_t add_info_length = cemi->add_info ? cemi->add_info_length : 0;
+	size_t tpdu_length = knx_tpdu_size(&ldata->tpdu);
+	size_t length = KNX_CEMI_HEADER_SIZE + add_info_length + KNX_LDATA_HEADER_SIZE + tpdu_length;
+
+	if (length > capacity)
+		return -KNX_INVALID_BUFFER;
+
+	*buffer++ = cemi->service;
+	*buffer++ = add_info_length;
+
+	memcpy(buffer, cemi->add_info, add_info_length);
+	buffer += add_info_length;
+
+	if (!knx_ldata_header_generate(buffer, ldata, tpdu_length))
+		return -KNX_INVALID_PAYLOAD;
+
+	knx_tpdu_generate(buffer + KNX_LDATA_HEADER_SIZE, &ldata->tpdu);
+
+	return length;
 }
 
-bool knx_generate(uint8_t* buffer, knx_service service, const void* payload) {
-	if (!knx_header_generate(buffer, service, knx_payload_size(service, payload)))
+static
+ssize_t knx_codec_generate_bounded_tunnel_request(
+	uint8_t*    buffer,
+	size_t      capacity,
+	const void* payload
+) {
+	const knx_tunnel_request* req = payload;
+
+	if (capacity < 4)
+		return -KNX_INVALID_BUFFER;
+
+	*buffer++ = 4;
+	*buffer++ = req->channel;
+	*buffer++ = req->seq_number;
+	*buffer++ = 0;
+
+	ssize_t cemi_length = knx_cemi_generate_bounded(buffer, capacity - 4, &req->data);
+	return cemi_length < 0 ? cemi_length : cemi_length + 4;
+}
+
+static
+ssize_t knx_codec_generate_bounded_routing_indication(
+	uint8_t*    buffer,
+	size_t      capacity,
+	const void* payload
+) {
+	const knx_routing_indication* ind = payload;
+	return knx_cemi_generate_bounded(buffer, capacity, &ind->data);
+}
+
+// Service identifiers are grouped into families by their high octet. Each family numbers its
+// services densely starting at a family-specific low octet, which lets us map every built-in
+// service to a slot in `knx_codecs` without branching on the identifier itself.
+static
+const struct {
+	uint8_t first;
+	uint8_t count;
+	uint8_t slot;
+} knx_service_families[6] = {
+	[2] = {0x01, 10, 0},  // Core
+	[3] = {0x10, 2,  10}, // Device management
+	[4] = {0x20, 2,  12}, // Tunnelling
+	[5] = {0x30, 3,  14}  // Routing
+};
+
+#define KNX_SERVICE_SLOTS 17
+
+inline static
+int knx_service_slot(knx_service service) {
+	unsigned family = (unsigned) service >> 8;
+
+	if (family >= sizeof(knx_service_families) / sizeof(knx_service_families[0]))
+		return -1;
+
+	unsigned offset = (uint8_t) ((service & 0xFF) - knx_service_families[family].first);
+
+	if (offset >= knx_service_families[family].count)
+		return -1;
+
+	return knx_service_families[family].slot + offset;
+}
+
+static
+knx_service_codec knx_codecs[KNX_SERVICE_SLOTS] = {
+	// KNX_SEARCH_REQUEST
+	[0] = {
+		knx_codec_parse_description_request,
+		knx_codec_generate_description_request,
+		NULL,
+		KNX_DESCRIPTION_REQUEST_SIZE
+	},
+
+	// KNX_SEARCH_RESPONSE
+	[1] = {
+		knx_codec_parse_search_response,
+		knx_codec_generate_search_response,
+		knx_codec_size_search_response,
+		0
+	},
+
+	// KNX_DESCRIPTION_REQUEST
+	[2] = {
+		knx_codec_parse_description_request,
+		knx_codec_generate_description_request,
+		NULL,
+		KNX_DESCRIPTION_REQUEST_SIZE
+	},
+
+	// KNX_DESCRIPTION_RESPONSE
+	[3] = {
+		knx_codec_parse_description_response,
+		knx_codec_generate_description_response,
+		knx_codec_size_description_response,
+		0
+	},
+
+	// KNX_CONNECTION_REQUEST
+	[4] = {
+		knx_codec_parse_connection_request,
+		knx_codec_generate_connection_request,
+		NULL,
+		KNX_CONNECTION_REQUEST_SIZE
+	},
+
+	// KNX_CONNECTION_RESPONSE
+	[5] = {
+		knx_codec_parse_connection_response,
+		knx_codec_generate_connection_response,
+		knx_codec_size_connection_response,
+		0
+	},
+
+	// KNX_CONNECTION_STATE_REQUEST
+	[6] = {
+		knx_codec_parse_connection_state_request,
+		knx_codec_generate_connection_state_request,
+		NULL,
+		KNX_CONNECTION_STATE_REQUEST_SIZE
+	},
+
+	// KNX_CONNECTION_STATE_RESPONSE
+	[7] = {
+		knx_codec_parse_connection_state_response,
+		knx_codec_generate_connection_state_response,
+		NULL,
+		KNX_CONNECTION_STATE_RESPONSE_SIZE
+	},
+
+	// KNX_DISCONNECT_REQUEST
+	[8] = {
+		knx_codec_parse_disconnect_request,
+		knx_codec_generate_disconnect_request,
+		NULL,
+		KNX_DISCONNECT_REQUEST_SIZE
+	},
+
+	// KNX_DISCONNECT_RESPONSE
+	[9] = {
+		knx_codec_parse_disconnect_response,
+		knx_codec_generate_disconnect_response,
+		NULL,
+		KNX_DISCONNECT_RESPONSE_SIZE
+	},
+
+	// KNX_DEVICE_CONFIGURATION_REQUEST
+	[10] = {
+		knx_codec_parse_device_configuration_request,
+		knx_codec_generate_device_configuration_request,
+		knx_codec_size_device_configuration_request
+	},
+
+	// KNX_DEVICE_CONFIGURATION_ACK (same layout as a tunnel response)
+	[11] = {
+		knx_codec_parse_tunnel_response,
+		knx_codec_generate_tunnel_response,
+		NULL,
+		KNX_TUNNEL_RESPONSE_SIZE
+	},
+
+	// KNX_TUNNEL_REQUEST
+	[12] = {
+		knx_codec_parse_tunnel_request,
+		knx_codec_generate_tunnel_request,
+		knx_codec_size_tunnel_request,
+		0,
+		knx_codec_generate_bounded_tunnel_request
+	},
+
+	// KNX_TUNNEL_RESPONSE
+	[13] = {
+		knx_codec_parse_tunnel_response,
+		knx_codec_generate_tunnel_response,
+		NULL,
+		KNX_TUNNEL_RESPONSE_SIZE
+	},
+
+	// KNX_ROUTING_INDICATION
+	[14] = {
+		knx_codec_parse_routing_indication,
+		knx_codec_generate_routing_indication,
+		knx_codec_size_routing_indication,
+		0,
+		knx_codec_generate_bounded_routing_indication
+	},
+
+	// KNX_ROUTING_LOST_MESSAGE
+	[15] = {
+		knx_codec_parse_routing_lost_message,
+		knx_codec_generate_routing_lost_message,
+		NULL,
+		KNX_ROUTING_LOST_MESSAGE_SIZE
+	},
+
+	// KNX_ROUTING_BUSY
+	[16] = {
+		knx_codec_parse_routing_busy,
+		knx_codec_generate_routing_busy,
+		NULL,
+		KNX_ROUTING_BUSY_SIZE
+	}
+};
+
+// Services registered in addition to the built-in ones
+static
+struct {
+	knx_service service;
+	knx_service_codec codec;
+} knx_extra_codecs[KNX_MAX_EXTRA_SERVICES];
+
+static
+size_t knx_num_extra_codecs = 0;
+
+bool knx_register_service(knx_service service, const knx_service_codec* codec) {
+	// Every codec must be usable by `knx_generate_bounded` and `knx_payload_size`
+	if (codec == NULL ||
+	    (codec->fixed_size == 0 && codec->size == NULL) ||
+	    (codec->generate == NULL && codec->generate_bounded == NULL))
 		return false;
 
-	switch (service) {
-		case KNX_CONNECTION_REQUEST:
-			knx_connection_request_generate(buffer + KNX_HEADER_SIZE, payload);
-			return true;
+	int slot = knx_service_slot(service);
 
-		case KNX_CONNECTION_RESPONSE:
-			knx_connection_response_generate(buffer + KNX_HEADER_SIZE, payload);
-			return true;
+	if (slot >= 0) {
+		knx_codecs[slot] = *codec;
+		return true;
+	}
 
-		case KNX_CONNECTION_STATE_REQUEST:
-			knx_connection_state_request_generate(buffer + KNX_HEADER_SIZE, payload);
+	for (size_t i = 0; i < knx_num_extra_codecs; i++) {
+		if (knx_extra_codecs[i].service == service) {
+			knx_extra_codecs[i].codec = *codec;
 			return true;
+		}
+	}
 
-		case KNX_CONNECTION_STATE_RESPONSE:
-			knx_connection_state_response_generate(buffer + KNX_HEADER_SIZE, payload);
-			return true;
+	if (knx_num_extra_codecs >= KNX_MAX_EXTRA_SERVICES)
+		return false;
 
-		case KNX_DISCONNECT_REQUEST:
-			knx_disconnect_request_generate(buffer + KNX_HEADER_SIZE, payload);
-			return true;
+	knx_extra_codecs[knx_num_extra_codecs].service = service;
+	knx_extra_codecs[knx_num_extra_codecs].codec = *codec;
+	knx_num_extra_codecs++;
 
-		case KNX_DISCONNECT_RESPONSE:
-			knx_disconnect_response_generate(buffer + KNX_HEADER_SIZE, payload);
-			return true;
+	return true;
+}
 
-		case KNX_TUNNEL_REQUEST:
-			knx_tunnel_request_generate(buffer + KNX_HEADER_SIZE, payload);
-			return true;
+bool knx_unregister_service(knx_service service) {
+	if (knx_service_slot(service) >= 0)
+		return false;
 
-		case KNX_TUNNEL_RESPONSE:
-			knx_tunnel_response_generate(buffer + KNX_HEADER_SIZE, payload);
+	for (size_t i = 0; i < knx_num_extra_codecs; i++) {
+		if (knx_extra_codecs[i].service == service) {
+			// Keep the table dense by moving the last entry into the gap
+			knx_extra_codecs[i] = knx_extra_codecs[--knx_num_extra_codecs];
 			return true;
+		}
+	}
 
-		case KNX_ROUTING_INDICATION:
-			knx_routing_indication_generate(buffer + KNX_HEADER_SIZE, payload);
-			return true;
+	return false;
+}
 
-		case KNX_DESCRIPTION_REQUEST:
-			knx_description_request_generate(buffer + KNX_HEADER_SIZE, payload);
-			return true;
+const knx_service_codec* knx_find_service(knx_service service) {
+	int slot = knx_service_slot(service);
 
-		default:
-			return false;
+	if (slot >= 0)
+		return knx_codecs[slot].parse || knx_codecs[slot].generate ? &knx_codecs[slot] : NULL;
+
+	for (size_t i = 0; i < knx_num_extra_codecs; i++) {
+		if (knx_extra_codecs[i].service == service)
+			return &knx_extra_codecs[i].codec;
 	}
+
+	return NULL;
 }
 
-size_t knx_payload_size(knx_service service, const void* payload) {
-	switch (service) {
-		case KNX_CONNECTION_REQUEST:
-			return KNX_CONNECTION_REQUEST_SIZE;
+ssize_t knx_parse(
+	const uint8_t* frame,
+	size_t         frame_length,
+	knx_packet*    output
+) {
+	// Unpack (and validate) header
+	ssize_t unpack_result = knx_unpack_header(frame, frame_length, &output->service);
+	if (unpack_result < 0)
+		return unpack_result;
 
-		case KNX_CONNECTION_RESPONSE:
-			return knx_connection_response_size(payload);
+	// Packet length must not exceed the frame length
+	if ((unsigned) unpack_result > frame_length)
+		return -KNX_INVALID_BUFFER;
 
-		case KNX_CONNECTION_STATE_REQUEST:
-			return KNX_CONNECTION_STATE_REQUEST_SIZE;
+	const knx_service_codec* codec = knx_find_service(output->service);
+	if (codec == NULL || codec->parse == NULL)
+		return -KNX_UNKNOWN_SERVICE;
 
-		case KNX_CONNECTION_STATE_RESPONSE:
-			return KNX_CONNECTION_STATE_RESPONSE_SIZE;
+	// Determine payload bounds
+	const uint8_t* payload = frame + KNX_HEADER_SIZE;
+	size_t payload_length = unpack_result - KNX_HEADER_SIZE;
 
-		case KNX_DISCONNECT_REQUEST:
-			return KNX_DISCONNECT_REQUEST_SIZE;
+	return
+		codec->parse(payload, payload_length, &output->payload)
+			? unpack_result
+			: -KNX_INVALID_PAYLOAD;
+}
 
-		case KNX_DISCONNECT_RESPONSE:
-			return KNX_DISCONNECT_RESPONSE_SIZE;
+inline static
+size_t knx_codec_size(const knx_service_codec* codec, const void* payload) {
+	return codec->fixed_size > 0 ? codec->fixed_size : codec->size(payload);
+}
 
-		case KNX_TUNNEL_REQUEST:
-			return knx_tunnel_request_size(payload);
+ssize_t knx_generate_bounded(
+	uint8_t*    buffer,
+	size_t      capacity,
+	knx_service service,
+	const void* payload
+) {
+	const knx_service_codec* codec = knx_find_service(service);
+	if (codec == NULL || (codec->generate == NULL && codec->generate_bounded == NULL))
+		return -KNX_UNKNOWN_SERVICE;
 
-		case KNX_TUNNEL_RESPONSE:
-			return KNX_TUNNEL_RESPONSE_SIZE;
+	if (buffer == NULL || capacity < KNX_HEADER_SIZE)
+		return -KNX_INVALID_BUFFER;
 
-		case KNX_ROUTING_INDICATION:
-			return knx_routing_indication_size(payload);
+	// The protocol limits the entire frame length to 16 bits
+	if (capacity > UINT16_MAX)
+		capacity = UINT16_MAX;
 
-		case KNX_DESCRIPTION_REQUEST:
-			return KNX_DESCRIPTION_REQUEST_SIZE;
+	uint8_t* payload_buffer = buffer + KNX_HEADER_SIZE;
+	size_t payload_capacity = capacity - KNX_HEADER_SIZE;
+	ssize_t payload_length;
 
-		default:
-			return 0;
+	if (codec->generate_bounded) {
+		payload_length = codec->generate_bounded(payload_buffer, payload_capacity, payload);
+
+		if (payload_length < 0)
+			return payload_length;
+	} else {
+		size_t size = knx_codec_size(codec, payload);
+
+		if (size > payload_capacity)
+			return -KNX_INVALID_BUFFER;
+
+		if (!codec->generate(payload_buffer, payload))
+			return -KNX_INVALID_PAYLOAD;
+
+		payload_length = size;
 	}
+
+	// The header comes last, because only now we know the payload length
+	knx_header_generate(buffer, service, payload_length);
+
+	return payload_length + KNX_HEADER_SIZE;
+}
+
+bool knx_generate(uint8_t* buffer, knx_service service, const void* payload) {
+	return knx_generate_bounded(buffer, UINT16_MAX, service, payload) > 0;
+}
+
+size_t knx_payload_size(knx_service service, const void* payload) {
+	const knx_service_codec* codec = knx_find_service(service);
+	if (codec == NULL)
+		return 0;
+
+	return knx_codec_size(codec, payload);
 }
@@ -30,13 +30,18 @@
 #include "dcres.h"
 #include "descreq.h"
 #include "descres.h"
+#include "devconfreq.h"
+#include "searchres.h"
 #include "tunnelreq.h"
 #include "tunnelres.h"
 #include "routingind.h"
+#include "routinglost.h"
+#include "routingbusy.h"
 
 #include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
+#include <sys/types.h>
 
 /**
  * KNXnet/IP Service Type
@@ -56,7 +61,9 @@ typedef enum {
 	KNX_DEVICE_CONFIGURATION_ACK     = 0x0311,
 	KNX_TUNNEL_REQUEST               = 0x0420,
 	KNX_TUNNEL_RESPONSE              = 0x0421,
-	KNX_ROUTING_INDICATION           = 0x0530
+	KNX_ROUTING_INDICATION           = 0x0530,
+	KNX_ROUTING_LOST_MESSAGE         = 0x0531,
+	KNX_ROUTING_BUSY                 = 0x0532
 } knx_service;
 
 /**
@@ -111,11 +118,97 @@ typedef struct {
 		knx_tunnel_request tunnel_req;
 		knx_tunnel_response tunnel_res;
 		knx_routing_indication routing_ind;
+		knx_routing_lost_message routing_lost;
+		knx_routing_busy routing_busy;
 		knx_description_request description_req;
 		knx_description_response description_res;
+		knx_description_request search_req;
+		knx_search_response search_res;
+		knx_device_configuration_request config_req;
+		knx_tunnel_response config_ack;
 	} payload;
 } knx_packet;
 
+/**
+ * Service Codec
+ */
+typedef struct {
+	/**
+	 * Parse the payload of a frame. The output points into the `payload` member of a `knx_packet`,
+	 * therefore the payload structure must not be larger than that.
+	 */
+	bool (* parse)(const uint8_t* message, size_t message_length, void* payload);
+
+	/**
+	 * Generate the raw payload. `buffer` is large enough to fit the result of `size`.
+	 */
+	bool (* generate)(uint8_t* buffer, const void* payload);
+
+	/**
+	 * Calculate the space needed to generate the payload (unused if `fixed_size` is non-zero).
+	 */
+	size_t (* size)(const void* payload);
+
+	/**
+	 * Size of the raw payload if it is constant, otherwise `0`
+	 */
+	size_t fixed_size;
+
+	/**
+	 * Generate the raw payload into a buffer of the given capacity in a single pass (optional).
+	 * Returns the number of bytes written or a negative integer indicating a `knx_parse_error`.
+	 * Codecs without it are generated using `size` (or `fixed_size`) followed by `generate`.
+	 */
+	ssize_t (* generate_bounded)(uint8_t* buffer, size_t capacity, const void* payload);
+} knx_service_codec;
+
+/**
+ * Maximum number of services that can be registered in addition to the built-in ones
+ */
+#define KNX_MAX_EXTRA_SERVICES 16
+
+/**
+ * Register a codec for the given service. This can replace a built-in codec or add a new
+ * (e.g. vendor-specific) service.
+ *
+ * A codec must be able to determine the payload size (`fixed_size` or `size`) and to generate
+ * the payload (`generate` or `generate_bounded`).
+ *
+ * \note Registration is not thread-safe, do it before processing frames.
+ * \param service Service identifier
+ * \param codec   Codec for the service (will be copied)
+ * \returns `true` if the codec has been registered, `false` if the codec is incomplete or there
+ *          is no space left
+ */
+bool knx_register_service(knx_service service, const knx_service_codec* codec);
+
+/**
+ * Remove a codec which has been registered for a service that is not built-in. A replaced
+ * built-in codec can be restored by registering a copy of the codec that `knx_find_service`
+ * returned before it has been replaced.
+ *
+ * \note Like registration, this is not thread-safe.
+ * \returns `true` if the codec has been removed, `false` if the service is built-in or unknown
+ */
+bool knx_unregister_service(knx_service service);
+
+/**
+ * Find the codec associated with a service.
+ *
+ * \returns Codec or `NULL` if the service is unknown
+ */
+const knx_service_codec* knx_find_service(knx_service service);
+
+/**
+ * Generate a KNXnet/IP header.
+ *
+ * \param buffer  Output buffer, you have to make sure there is enough space
+ * \param service Service identifier
+ * \param length  Payload length (excluding the header)
+ * \returns `true` if the header has been generated successfully, otherwise `false`
+ */
+bool knx_header_generate(uint8_t* buffer, knx_service service, size_t length);
+
 /**
  * Unpack a KNXnet/IP header.
  *
@@ -154,6 +247,24 @@ ssize_t knx_parse(
  */
 bool knx_generate(uint8_t* buffer, knx_service service, const void* payload);
 
+/**
+ * Generate a message into a buffer of limited size. Nested lengths are computed only once and
+ * nothing is written beyond `capacity` bytes.
+ *
+ * \param buffer   Output buffer
+ * \param capacity Number of bytes available in `buffer`
+ * \param service  Service identifier
+ * \param payload  Pointer to a payload structure
+ * \returns Entire frame length or negative integer indicating a `knx_parse_error`
+ *          (`KNX_INVALID_BUFFER` if the frame does not fit)
+ */
+ssize_t knx_generate_bounded(
+	uint8_t*    buffer,
+	size_t      capacity,
+	knx_service service,
+	const void* payload
+);
+
 /**
  * Calculate the space needed to generate a message. This excludes the space needed for a header.
  *
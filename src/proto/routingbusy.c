@@ -0,0 +1,52 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "routingbusy.h"
+
+// Routing Busy:
+//   Octet 0:   Structure length
+//   Octet 1:   Device state
+//   Octet 2-3: Wait time
+//   Octet 4-5: Control field
+
+void knx_routing_busy_generate(uint8_t* buffer, const knx_routing_busy* busy) {
+	*buffer++ = KNX_ROUTING_BUSY_SIZE;
+	*buffer++ = busy->device_state;
+	*buffer++ = busy->wait_time >> 8 & 0xFF;
+	*buffer++ = busy->wait_time & 0xFF;
+	*buffer++ = busy->control >> 8 & 0xFF;
+	*buffer++ = busy->control & 0xFF;
+}
+
+bool knx_routing_busy_parse(
+	const uint8_t*    message,
+	size_t            message_length,
+	knx_routing_busy* busy
+) {
+	if (message_length < KNX_ROUTING_BUSY_SIZE || message[0] != KNX_ROUTING_BUSY_SIZE)
+		return false;
+
+	busy->device_state = message[1];
+	busy->wait_time = message[2] << 8 | message[3];
+	busy->control = message[4] << 8 | message[5];
+
+	return true;
+}
@@ -0,0 +1,77 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_PROTO_ROUTINGBUSY_H_
+#define KNXPROTO_PROTO_ROUTINGBUSY_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/**
+ * Routing Busy
+ */
+typedef struct {
+	/**
+	 * Device state
+	 */
+	uint8_t device_state;
+
+	/**
+	 * Time in milliseconds for which routing participants shall stop sending
+	 */
+	uint16_t wait_time;
+
+	/**
+	 * Control field (`0` addresses all routing participants)
+	 */
+	uint16_t control;
+} knx_routing_busy;
+
+/**
+ * Generate a raw routing busy.
+ *
+ * \see KNX_ROUTING_BUSY_SIZE
+ * \param buffer Output buffer, you have to make sure there is enough space
+ * \param busy   Input routing busy
+ */
+void knx_routing_busy_generate(uint8_t* buffer, const knx_routing_busy* busy);
+
+/**
+ * Parse a raw routing busy.
+ *
+ * \param message        Raw routing busy
+ * \param message_length Number of bytes in `message`
+ * \param busy           Output routing busy
+ * \returns `true` if parsing was successful, otherwise `false`
+ */
+bool knx_routing_busy_parse(
+	const uint8_t*    message,
+	size_t            message_length,
+	knx_routing_busy* busy
+);
+
+/**
+ * Routing busy size
+ */
+#define KNX_ROUTING_BUSY_SIZE 6
+
+#endif
@@ -0,0 +1,49 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "routinglost.h"
+
+// Routing Lost Message:
+//   Octet 0:   Structure length
+//   Octet 1:   Device state
+//   Octet 2-3: Number of lost messages
+
+void knx_routing_lost_message_generate(uint8_t* buffer, const knx_routing_lost_message* lost) {
+	*buffer++ = KNX_ROUTING_LOST_MESSAGE_SIZE;
+	*buffer++ = lost->device_state;
+	*buffer++ = lost->lost_messages >> 8 & 0xFF;
+	*buffer++ = lost->lost_messages & 0xFF;
+}
+
+bool knx_routing_lost_message_parse(
+	const uint8_t*            message,
+	size_t                    message_length,
+	knx_routing_lost_message* lost
+) {
+	if (message_length < KNX_ROUTING_LOST_MESSAGE_SIZE ||
+	    message[0] != KNX_ROUTING_LOST_MESSAGE_SIZE)
+		return false;
+
+	lost->device_state = message[1];
+	lost->lost_messages = message[2] << 8 | message[3];
+
+	return true;
+}
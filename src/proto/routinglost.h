@@ -0,0 +1,72 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_PROTO_ROUTINGLOST_H_
+#define KNXPROTO_PROTO_ROUTINGLOST_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/**
+ * Routing Lost Message
+ */
+typedef struct {
+	/**
+	 * Device state
+	 */
+	uint8_t device_state;
+
+	/**
+	 * Number of routing indications the sender had to drop
+	 */
+	uint16_t lost_messages;
+} knx_routing_lost_message;
+
+/**
+ * Generate a raw routing lost message.
+ *
+ * \see KNX_ROUTING_LOST_MESSAGE_SIZE
+ * \param buffer Output buffer, you have to make sure there is enough space
+ * \param lost   Input routing lost message
+ */
+void knx_routing_lost_message_generate(uint8_t* buffer, const knx_routing_lost_message* lost);
+
+/**
+ * Parse a raw routing lost message.
+ *
+ * \param message        Raw routing lost message
+ * \param message_length Number of bytes in `message`
+ * \param lost           Output routing lost message
+ * \returns `true` if parsing was successful, otherwise `false`
+ */
+bool knx_routing_lost_message_parse(
+	const uint8_t*            message,
+	size_t                    message_length,
+	knx_routing_lost_message* lost
+);
+
+/**
+ * Routing lost message size
+ */
+#define KNX_ROUTING_LOST_MESSAGE_SIZE 4
+
+#endif
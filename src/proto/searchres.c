@@ -0,0 +1,45 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "searchres.h"
+
+// Search Response:
+//   Octet 0-7: Control host information
+//   Octet 8-n: Description response
+
+bool knx_search_response_parse(
+	const uint8_t*       message,
+	size_t               message_length,
+	knx_search_response* res
+) {
+	return
+		knx_host_info_parse(message, message_length, &res->control_host) &&
+		knx_description_response_parse(
+			message + KNX_HOST_INFO_SIZE,
+			message_length - KNX_HOST_INFO_SIZE,
+			&res->description
+		);
+}
+
+bool knx_search_response_generate(uint8_t* buffer, const knx_search_response* res) {
+	knx_host_info_generate(buffer, &res->control_host);
+	return knx_description_response_generate(buffer + KNX_HOST_INFO_SIZE, &res->description);
+}
@@ -0,0 +1,81 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_PROTO_SEARCHRES_H_
+#define KNXPROTO_PROTO_SEARCHRES_H_
+
+#include "hostinfo.h"
+#include "descres.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/**
+ * Search Response
+ */
+typedef struct {
+	/**
+	 * Control endpoint of the responding server
+	 */
+	knx_host_info control_host;
+
+	/**
+	 * Device information and supported service families
+	 */
+	knx_description_response description;
+} knx_search_response;
+
+/**
+ * Parse a raw search response.
+ *
+ * \note You have to free the `description.services` array using
+ *       `knx_description_response_free_services`.
+ * \param message        Raw search response
+ * \param message_length Number of bytes in `message`
+ * \param res            Output search response
+ * \returns `true` if parsing was successful, otherwise `false`
+ */
+bool knx_search_response_parse(
+	const uint8_t*       message,
+	size_t               message_length,
+	knx_search_response* res
+);
+
+/**
+ * Generate a raw search response.
+ *
+ * \see knx_search_response_size
+ * \param buffer Output buffer, you have to make sure there is enough space
+ * \param res    Input search response
+ * \returns `true` if the response has been generated successfully, otherwise `false`
+ */
+bool knx_search_response_generate(uint8_t* buffer, const knx_search_response* res);
+
+/**
+ * Search response size
+ */
+inline static
+size_t knx_search_response_size(const knx_search_response* res) {
+	return KNX_HOST_INFO_SIZE + knx_description_response_size(&res->description);
+}
+
+#endif
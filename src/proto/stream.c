@@ -0,0 +1,135 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "stream.h"
+#include "../util/alloc.h"
+
+#include <string.h>
+
+bool knx_stream_init(knx_stream* stream, size_t capacity) {
+	// Frames are at most UINT16_MAX bytes long, we need at least that much space to make sure
+	// every frame fits.
+	size_t actual_capacity = 1;
+	while (actual_capacity < capacity || actual_capacity <= UINT16_MAX)
+		actual_capacity <<= 1;
+
+	stream->buffer = newa(uint8_t, actual_capacity);
+	stream->scratch = newa(uint8_t, UINT16_MAX);
+
+	if (stream->buffer == NULL || stream->scratch == NULL) {
+		free(stream->buffer);
+		free(stream->scratch);
+		return false;
+	}
+
+	stream->capacity = actual_capacity;
+	stream->head = 0;
+	stream->tail = 0;
+
+	return true;
+}
+
+void knx_stream_destroy(knx_stream* stream) {
+	free(stream->buffer);
+	free(stream->scratch);
+
+	stream->buffer = NULL;
+	stream->scratch = NULL;
+}
+
+size_t knx_stream_reserve(knx_stream* stream, uint8_t** space) {
+	// Rewind an empty ring, this maximizes the contiguous space
+	if (stream->head == stream->tail)
+		stream->head = stream->tail = 0;
+
+	size_t offset = stream->tail & (stream->capacity - 1);
+	size_t free_space = stream->capacity - (stream->tail - stream->head);
+	size_t contiguous = stream->capacity - offset;
+
+	*space = stream->buffer + offset;
+	return free_space < contiguous ? free_space : contiguous;
+}
+
+size_t knx_stream_push(knx_stream* stream, const uint8_t* data, size_t length) {
+	size_t written = 0;
+
+	// Two iterations at most, the second one handles the wrap-around
+	while (written < length) {
+		uint8_t* space;
+		size_t space_length = knx_stream_reserve(stream, &space);
+
+		if (space_length == 0)
+			break;
+
+		if (space_length > length - written)
+			space_length = length - written;
+
+		memcpy(space, data + written, space_length);
+		knx_stream_commit(stream, space_length);
+		written += space_length;
+	}
+
+	return written;
+}
+
+// Copy bytes from the ring, starting at the read position.
+inline static
+void knx_stream_copy(const knx_stream* stream, uint8_t* output, size_t length) {
+	size_t offset = stream->head & (stream->capacity - 1);
+	size_t first = stream->capacity - offset;
+
+	if (first >= length) {
+		memcpy(output, stream->buffer + offset, length);
+	} else {
+		memcpy(output, stream->buffer + offset, first);
+		memcpy(output + first, stream->buffer, length - first);
+	}
+}
+
+ssize_t knx_stream_next(knx_stream* stream, const uint8_t** frame) {
+	size_t available = knx_stream_pending(stream);
+
+	if (available < KNX_HEADER_SIZE)
+		return 0;
+
+	// The header itself might wrap around
+	uint8_t header[KNX_HEADER_SIZE];
+	knx_stream_copy(stream, header, KNX_HEADER_SIZE);
+
+	ssize_t frame_length = knx_unpack_header(header, KNX_HEADER_SIZE, NULL);
+	if (frame_length < 0)
+		return frame_length;
+
+	if ((size_t) frame_length > available)
+		return 0;
+
+	size_t offset = stream->head & (stream->capacity - 1);
+
+	if (offset + frame_length <= stream->capacity) {
+		*frame = stream->buffer + offset;
+	} else {
+		knx_stream_copy(stream, stream->scratch, frame_length);
+		*frame = stream->scratch;
+	}
+
+	stream->head += frame_length;
+	return frame_length;
+}
@@ -0,0 +1,122 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_PROTO_STREAM_H_
+#define KNXPROTO_PROTO_STREAM_H_
+
+#include "proto.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Incremental framer for KNXnet/IP over stream-oriented transports (e.g. TCP). Received data is
+ * accumulated in a ring buffer, complete frames are extracted one at a time. Frames which lie
+ * contiguously within the ring are returned in-place, only frames that wrap around the end of the
+ * ring are copied into a scratch buffer.
+ */
+typedef struct {
+	/**
+	 * Ring buffer
+	 */
+	uint8_t* buffer;
+
+	/**
+	 * Capacity of `buffer` (power of two)
+	 */
+	size_t capacity;
+
+	/**
+	 * Read position (not masked)
+	 */
+	size_t head;
+
+	/**
+	 * Write position (not masked)
+	 */
+	size_t tail;
+
+	/**
+	 * Reassembly space for frames that wrap around
+	 */
+	uint8_t* scratch;
+} knx_stream;
+
+/**
+ * Initialize the framer.
+ *
+ * \param stream   Framer to initialize
+ * \param capacity Ring buffer capacity, will be rounded up to the next power of two
+ * \returns `true` on success, `false` if allocating the buffers failed
+ */
+bool knx_stream_init(knx_stream* stream, size_t capacity);
+
+/**
+ * Free the buffers associated with the framer.
+ */
+void knx_stream_destroy(knx_stream* stream);
+
+/**
+ * Retrieve the contiguous free space within the ring. Use this to receive data directly into the
+ * ring, followed by `knx_stream_commit`.
+ *
+ * \param stream Framer
+ * \param space  Start of the free space will be stored here
+ * \returns Number of bytes that may be written to `*space`
+ */
+size_t knx_stream_reserve(knx_stream* stream, uint8_t** space);
+
+/**
+ * Mark `length` bytes of the space obtained through `knx_stream_reserve` as written.
+ */
+inline static
+void knx_stream_commit(knx_stream* stream, size_t length) {
+	stream->tail += length;
+}
+
+/**
+ * Copy a chunk of data into the ring.
+ *
+ * \returns Number of bytes that have been copied
+ */
+size_t knx_stream_push(knx_stream* stream, const uint8_t* data, size_t length);
+
+/**
+ * Extract the next complete frame.
+ *
+ * \note `*frame` remains valid until data is written into the ring again.
+ * \param stream Framer
+ * \param frame  Start of the frame will be stored here
+ * \returns Frame length, `0` if no complete frame is available or a negative integer indicating
+ *          a `knx_parse_error` (the stream can not be recovered in that case)
+ */
+ssize_t knx_stream_next(knx_stream* stream, const uint8_t** frame);
+
+/**
+ * Number of buffered bytes which have not been extracted yet.
+ */
+inline static
+size_t knx_stream_pending(const knx_stream* stream) {
+	return stream->tail - stream->head;
+}
+
+#endif
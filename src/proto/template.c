@@ -0,0 +1,57 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "template.h"
+#include "view.h"
+
+bool knx_frame_template_init(knx_frame_template* tmpl, knx_service service, const void* payload) {
+	if (service != KNX_TUNNEL_REQUEST && service != KNX_ROUTING_INDICATION)
+		return false;
+
+	ssize_t length = knx_generate_bounded(tmpl->frame, sizeof(tmpl->frame), service, payload);
+	if (length < 0)
+		return false;
+
+	tmpl->length = length;
+
+	// Find the patch offsets the same way a receiver would
+	knx_frame_view view;
+	if (knx_frame_view_init(&view, tmpl->frame, tmpl->length) < 0)
+		return false;
+
+	tmpl->seq_offset = 0;
+	uint8_t seq_number;
+	if (knx_frame_view_seq_number(&view, &seq_number))
+		tmpl->seq_offset = KNX_HEADER_SIZE + 2;
+
+	const uint8_t* apdu;
+	size_t apdu_length;
+
+	if (knx_frame_view_apdu(&view, &apdu, &apdu_length)) {
+		tmpl->apdu_offset = apdu - tmpl->frame;
+		tmpl->apdu_length = apdu_length;
+	} else {
+		tmpl->apdu_offset = 0;
+		tmpl->apdu_length = 0;
+	}
+
+	return true;
+}
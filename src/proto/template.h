@@ -0,0 +1,114 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_PROTO_TEMPLATE_H_
+#define KNXPROTO_PROTO_TEMPLATE_H_
+
+#include "proto.h"
+#include "data.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Maximum size of a frame template
+ */
+#define KNX_FRAME_TEMPLATE_SIZE 64
+
+/**
+ * Preformatted frame with known positions for the parts that change between transmissions.
+ * Use this to send many frames that share channel, CEMI service, control fields, addresses and
+ * APDU length, e.g. repeated group value writes.
+ */
+typedef struct {
+	/**
+	 * Preformatted frame
+	 */
+	uint8_t frame[KNX_FRAME_TEMPLATE_SIZE];
+
+	/**
+	 * Number of bytes in `frame`
+	 */
+	size_t length;
+
+	/**
+	 * Offset of the sequence number (`0` if the service has none)
+	 */
+	size_t seq_offset;
+
+	/**
+	 * Offset of the APDU (`0` if the frame carries no data)
+	 * \note The two most significant bits of the first APDU octet are part of the APCI
+	 */
+	size_t apdu_offset;
+
+	/**
+	 * Number of bytes in the APDU
+	 */
+	size_t apdu_length;
+} knx_frame_template;
+
+/**
+ * Generate the template. This runs through `knx_generate` once and records the patch offsets.
+ *
+ * \param tmpl    Output template
+ * \param service Service identifier (`KNX_TUNNEL_REQUEST` or `KNX_ROUTING_INDICATION`)
+ * \param payload Pointer to a payload structure, the APDU determines the length of all values
+ * \returns `true` if the template has been generated successfully, otherwise `false`
+ */
+bool knx_frame_template_init(knx_frame_template* tmpl, knx_service service, const void* payload);
+
+/**
+ * Patch the tunnel sequence number.
+ */
+inline static
+void knx_frame_template_set_seq(knx_frame_template* tmpl, uint8_t seq_number) {
+	if (tmpl->seq_offset > 0)
+		tmpl->frame[tmpl->seq_offset] = seq_number;
+}
+
+/**
+ * Retrieve the APDU within the template. It can be modified using `knx_dpt_to_apdu`.
+ */
+inline static
+uint8_t* knx_frame_template_apdu(knx_frame_template* tmpl) {
+	return tmpl->apdu_offset > 0 ? tmpl->frame + tmpl->apdu_offset : NULL;
+}
+
+/**
+ * Patch the value contained in the APDU.
+ *
+ * \param tmpl  Template
+ * \param type  Datapoint type of `value`
+ * \param value Pointer to an instance of the C type associated with `type`
+ * \returns `true` if the value fits the APDU of the template, otherwise `false`
+ */
+inline static
+bool knx_frame_template_set_value(knx_frame_template* tmpl, knx_dpt type, const void* value) {
+	if (tmpl->apdu_offset == 0 || knx_dpt_size(type) != tmpl->apdu_length)
+		return false;
+
+	knx_dpt_to_apdu(tmpl->frame + tmpl->apdu_offset, type, value);
+	return true;
+}
+
+#endif
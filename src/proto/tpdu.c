@@ -66,3 +66,57 @@ void knx_tpdu_generate(uint8_t* tpdu, const knx_tpdu* info) {
 			break;
 	}
 }
+
+bool knx_tpdu_value_set(knx_tpdu_value* value, const knx_tpdu* info) {
+	value->tpci = info->tpci;
+	value->seq_number = info->seq_number;
+
+	switch (info->tpci) {
+		case KNX_TPCI_UNNUMBERED_DATA:
+		case KNX_TPCI_NUMBERED_DATA:
+			if (info->info.data.length > KNX_TPDU_INLINE_SIZE)
+				return false;
+
+			value->code = info->info.data.apci;
+			value->length = info->info.data.length;
+			memcpy(value->apdu, info->info.data.payload, value->length);
+
+			if (value->length > 0)
+				value->apdu[0] &= 63;
+
+			return true;
+
+		case KNX_TPCI_UNNUMBERED_CONTROL:
+		case KNX_TPCI_NUMBERED_CONTROL:
+			value->code = info->info.control;
+			value->length = 0;
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+bool knx_tpdu_value_parse(const uint8_t* message, size_t message_length, knx_tpdu_value* value) {
+	knx_tpdu info;
+	return knx_tpdu_parse(message, message_length, &info) && knx_tpdu_value_set(value, &info);
+}
+
+void knx_tpdu_value_view(const knx_tpdu_value* value, knx_tpdu* info) {
+	info->tpci = value->tpci;
+	info->seq_number = value->seq_number;
+
+	if (value->tpci == KNX_TPCI_UNNUMBERED_CONTROL || value->tpci == KNX_TPCI_NUMBERED_CONTROL) {
+		info->info.control = value->code;
+	} else {
+		info->info.data.apci = value->code;
+		info->info.data.payload = value->apdu;
+		info->info.data.length = value->length;
+	}
+}
+
+void knx_tpdu_value_generate(uint8_t* buffer, const knx_tpdu_value* value) {
+	knx_tpdu info;
+	knx_tpdu_value_view(value, &info);
+	knx_tpdu_generate(buffer, &info);
+}
@@ -157,4 +157,87 @@ size_t knx_tpdu_size(const knx_tpdu* info) {
 	}
 }
 
+/**
+ * APDU capacity of `knx_tpdu_value`, enough for any standard frame
+ */
+#define KNX_TPDU_INLINE_SIZE 16
+
+/**
+ * Self-contained Transport Protocol Data Unit
+ *
+ * Unlike `knx_tpdu`, the APDU is stored inline. Values can therefore be copied with plain
+ * assignment and outlive the buffer they have been parsed from. APDUs larger than
+ * `KNX_TPDU_INLINE_SIZE` (extended frames) cannot be represented.
+ */
+typedef struct {
+	/**
+	 * Transport protocol control information (`knx_tpci`)
+	 */
+	uint8_t tpci;
+
+	/**
+	 * Sequence number
+	 */
+	uint8_t seq_number;
+
+	/**
+	 * Control code (`knx_tpci_control`) for control TPDUs, APCI (`knx_apci`) otherwise
+	 */
+	uint8_t code;
+
+	/**
+	 * Number of bytes in `apdu`
+	 */
+	uint8_t length;
+
+	/**
+	 * APDU, the APCI bits are cleared from the first byte
+	 */
+	uint8_t apdu[KNX_TPDU_INLINE_SIZE];
+} knx_tpdu_value;
+
+/**
+ * Parse a raw transport protocol data unit into a value.
+ *
+ * \param message        Raw TPDU
+ * \param message_length Number of bytes in `message`
+ * \param value          Output value
+ * \returns `true` if parsing was successful, `false` if the TPDU is malformed or too large
+ */
+bool knx_tpdu_value_parse(const uint8_t* message, size_t message_length, knx_tpdu_value* value);
+
+/**
+ * Copy a TPDU into a value.
+ *
+ * \returns `true` on success, `false` if the APDU does not fit
+ */
+bool knx_tpdu_value_set(knx_tpdu_value* value, const knx_tpdu* info);
+
+/**
+ * Fill in a `knx_tpdu` which refers to the APDU stored in the value, e.g. to pass it to
+ * `knx_ldata_generate`. It is valid as long as the value is not moved.
+ */
+void knx_tpdu_value_view(const knx_tpdu_value* value, knx_tpdu* info);
+
+/**
+ * Generate a raw transport protocol data unit from a value.
+ *
+ * \see knx_tpdu_value_size
+ * \param buffer Output buffer, you have to make sure there is enough space
+ * \param value  Input value
+ */
+void knx_tpdu_value_generate(uint8_t* buffer, const knx_tpdu_value* value);
+
+/**
+ * Space required to fit the given value.
+ */
+inline static
+size_t knx_tpdu_value_size(const knx_tpdu_value* value) {
+	if (value->tpci == KNX_TPCI_UNNUMBERED_CONTROL || value->tpci == KNX_TPCI_NUMBERED_CONTROL)
+		return 1;
+
+	size_t s = value->length + 1;
+	return s > 2 ? s : 2;
+}
+
 #endif
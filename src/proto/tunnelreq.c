@@ -32,13 +32,13 @@
 //   Octet 3:   Reserved
 //   Octet 4-n: Payload
 
-void knx_tunnel_request_generate(uint8_t* buffer, const knx_tunnel_request* req) {
+bool knx_tunnel_request_generate(uint8_t* buffer, const knx_tunnel_request* req) {
 	*buffer++ = 4;
 	*buffer++ = req->channel;
 	*buffer++ = req->seq_number;
 	*buffer++ = 0;
 
-	knx_cemi_generate(buffer, &req->data);
+	return knx_cemi_generate(buffer, &req->data);
 }
 
 bool knx_tunnel_request_parse(
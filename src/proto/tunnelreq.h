@@ -54,8 +54,9 @@ typedef struct {
  * \see knx_tunnel_request_size
  * \param buffer Output buffer, you have to make sure there is enough space
  * \param req    Input tunnel request
+ * \returns `true` if the request has been generated successfully, otherwise `false`
  */
-void knx_tunnel_request_generate(uint8_t* buffer, const knx_tunnel_request* req);
+bool knx_tunnel_request_generate(uint8_t* buffer, const knx_tunnel_request* req);
 
 /**
  * Parse a raw tunnel request.
@@ -0,0 +1,41 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "view.h"
+
+ssize_t knx_frame_view_init(
+	knx_frame_view* view,
+	const uint8_t*  frame,
+	size_t          frame_length
+) {
+	ssize_t unpack_result = knx_unpack_header(frame, frame_length, &view->service);
+	if (unpack_result < 0)
+		return unpack_result;
+
+	// Packet length must not exceed the frame length
+	if ((size_t) unpack_result > frame_length)
+		return -KNX_INVALID_BUFFER;
+
+	view->payload = frame + KNX_HEADER_SIZE;
+	view->payload_length = unpack_result - KNX_HEADER_SIZE;
+
+	return unpack_result;
+}
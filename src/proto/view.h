@@ -0,0 +1,284 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_PROTO_VIEW_H_
+#define KNXPROTO_PROTO_VIEW_H_
+
+#include "proto.h"
+
+#include "../util/address.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Read-only view onto a raw KNXnet/IP frame. Unlike `knx_parse`, which populates an entire
+ * `knx_packet`, the view only validates the header. Individual fields are extracted on demand
+ * straight from the underlying buffer, which must outlive the view.
+ */
+typedef struct {
+	/**
+	 * Service identifier
+	 */
+	knx_service service;
+
+	/**
+	 * Frame payload (excluding the header)
+	 */
+	const uint8_t* payload;
+
+	/**
+	 * Number of bytes in `payload`
+	 */
+	size_t payload_length;
+} knx_frame_view;
+
+/**
+ * Initialize a view onto the given frame.
+ *
+ * \param view         Output view
+ * \param frame        Contains the frame
+ * \param frame_length Length of `frame` in bytes
+ * \returns Actual frame length or negative integer indicating a `knx_parse_error`
+ */
+ssize_t knx_frame_view_init(
+	knx_frame_view* view,
+	const uint8_t*  frame,
+	size_t          frame_length
+);
+
+/**
+ * Retrieve the communication channel.
+ *
+ * \returns `true` if the service carries a channel and the payload is large enough
+ */
+inline static
+bool knx_frame_view_channel(const knx_frame_view* view, uint8_t* channel) {
+	switch (view->service) {
+		case KNX_TUNNEL_REQUEST:
+		case KNX_TUNNEL_RESPONSE:
+			// Octet 0 is the structure length
+			if (view->payload_length < 4 || view->payload[0] != 4)
+				return false;
+
+			*channel = view->payload[1];
+			return true;
+
+		case KNX_CONNECTION_RESPONSE:
+		case KNX_CONNECTION_STATE_REQUEST:
+		case KNX_CONNECTION_STATE_RESPONSE:
+		case KNX_DISCONNECT_REQUEST:
+		case KNX_DISCONNECT_RESPONSE:
+			if (view->payload_length < 2)
+				return false;
+
+			*channel = view->payload[0];
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+/**
+ * Retrieve the sequence number of a tunnel request or response.
+ */
+inline static
+bool knx_frame_view_seq_number(const knx_frame_view* view, uint8_t* seq_number) {
+	if ((view->service != KNX_TUNNEL_REQUEST && view->service != KNX_TUNNEL_RESPONSE) ||
+	    view->payload_length < 4 || view->payload[0] != 4)
+		return false;
+
+	*seq_number = view->payload[2];
+	return true;
+}
+
+/**
+ * Locate the raw CEMI frame within a tunnel request or routing indication.
+ *
+ * \param view   View onto the frame
+ * \param cemi   Start of the CEMI frame will be stored here
+ * \param length Number of bytes in the CEMI frame will be stored here
+ */
+inline static
+bool knx_frame_view_cemi(const knx_frame_view* view, const uint8_t** cemi, size_t* length) {
+	switch (view->service) {
+		case KNX_TUNNEL_REQUEST:
+			if (view->payload_length < 4 + KNX_CEMI_HEADER_SIZE || view->payload[0] != 4)
+				return false;
+
+			*cemi = view->payload + 4;
+			*length = view->payload_length - 4;
+			return true;
+
+		case KNX_ROUTING_INDICATION:
+			if (view->payload_length < KNX_CEMI_HEADER_SIZE)
+				return false;
+
+			*cemi = view->payload;
+			*length = view->payload_length;
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+/**
+ * Retrieve the CEMI message code.
+ */
+inline static
+bool knx_frame_view_cemi_service(const knx_frame_view* view, knx_cemi_service* service) {
+	const uint8_t* cemi;
+	size_t length;
+
+	if (!knx_frame_view_cemi(view, &cemi, &length))
+		return false;
+
+	*service = cemi[0];
+	return true;
+}
+
+/**
+ * Locate the raw L_Data frame within a tunnel request or routing indication. This performs the
+ * same validation as `knx_cemi_parse` and `knx_ldata_parse` without populating any structures.
+ *
+ * \param view   View onto the frame
+ * \param ldata  Start of the L_Data frame will be stored here
+ * \param length Number of bytes in the L_Data frame will be stored here
+ */
+inline static
+bool knx_frame_view_ldata(const knx_frame_view* view, const uint8_t** ldata, size_t* length) {
+	const uint8_t* cemi;
+	size_t cemi_length;
+
+	if (!knx_frame_view_cemi(view, &cemi, &cemi_length))
+		return false;
+
+	switch (cemi[0]) {
+		case KNX_CEMI_LDATA_IND:
+		case KNX_CEMI_LDATA_REQ:
+		case KNX_CEMI_LDATA_CON:
+			break;
+
+		default:
+			return false;
+	}
+
+	size_t offset = KNX_CEMI_HEADER_SIZE + (size_t) cemi[1];
+
+	// Need at least the L_Data header, one TPDU octet and a valid standard frame
+	if (offset + 8 > cemi_length || (cemi[offset + 1] & 15) ||
+	    offset + 8 + (size_t) cemi[offset + 6] > cemi_length)
+		return false;
+
+	*ldata = cemi + offset;
+	*length = cemi_length - offset;
+	return true;
+}
+
+/**
+ * Retrieve the source address.
+ */
+inline static
+bool knx_frame_view_source(const knx_frame_view* view, knx_addr* source) {
+	const uint8_t* ldata;
+	size_t length;
+
+	if (!knx_frame_view_ldata(view, &ldata, &length))
+		return false;
+
+	*source = ldata[2] << 8 | ldata[3];
+	return true;
+}
+
+/**
+ * Retrieve the destination address and (optionally) its type.
+ *
+ * \param view         View onto the frame
+ * \param destination  Destination address will be stored here
+ * \param address_type Type of the destination address will be stored here (may be `NULL`)
+ */
+inline static
+bool knx_frame_view_destination(
+	const knx_frame_view* view,
+	knx_addr*             destination,
+	knx_ldata_addr_type*  address_type
+) {
+	const uint8_t* ldata;
+	size_t length;
+
+	if (!knx_frame_view_ldata(view, &ldata, &length))
+		return false;
+
+	*destination = ldata[4] << 8 | ldata[5];
+
+	if (address_type)
+		*address_type = ldata[1] >> 7 & 1;
+
+	return true;
+}
+
+/**
+ * Retrieve the APCI. Fails if the TPDU contains control information instead of data.
+ */
+inline static
+bool knx_frame_view_apci(const knx_frame_view* view, knx_apci* apci) {
+	const uint8_t* ldata;
+	size_t length;
+
+	if (!knx_frame_view_ldata(view, &ldata, &length))
+		return false;
+
+	// Control TPDUs carry no APCI, data TPDUs consist of at least 2 octets
+	if ((ldata[7] & 128) || ldata[6] < 1)
+		return false;
+
+	*apci = (ldata[7] << 2 & 12) | (ldata[8] >> 6 & 3);
+	return true;
+}
+
+/**
+ * Retrieve the APDU slice. It is laid out like `knx_tpdu.info.data.payload`.
+ *
+ * \note The two most significant bits of `apdu[0]` are part of the APCI
+ * \param view   View onto the frame
+ * \param apdu   Start of the APDU will be stored here
+ * \param length Number of bytes in the APDU will be stored here
+ */
+inline static
+bool knx_frame_view_apdu(const knx_frame_view* view, const uint8_t** apdu, size_t* length) {
+	const uint8_t* ldata;
+	size_t ldata_length;
+
+	if (!knx_frame_view_ldata(view, &ldata, &ldata_length))
+		return false;
+
+	if ((ldata[7] & 128) || ldata[6] < 1)
+		return false;
+
+	*apdu = ldata + 8;
+	*length = ldata[6];
+	return true;
+}
+
+#endif
@@ -22,6 +22,7 @@
 #ifndef KNXPROTO_UTIL_ADDRESS_H_
 #define KNXPROTO_UTIL_ADDRESS_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
 /**
@@ -60,4 +61,14 @@ typedef uint16_t knx_addr;
 #define knx_group_addr(main, sub, group) \
 	((((main) & 15) << 11) | (((sub) & 7) << 8) | ((group) & 255))
 
+/**
+ * Map an address to one of `buckets` buckets. Fibonacci hashing spreads consecutive addresses
+ * evenly.
+ */
+inline static
+size_t knx_addr_bucket(knx_addr address, size_t buckets) {
+	uint32_t hash = (uint32_t) address * 2654435761u;
+	return ((uint64_t) hash * buckets) >> 32;
+}
+
 #endif
@@ -0,0 +1,117 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "arena.h"
+
+#include <stdlib.h>
+
+inline static
+size_t knx_arena_align(size_t size) {
+	return (size + KNX_ARENA_ALIGNMENT - 1) & ~((size_t) KNX_ARENA_ALIGNMENT - 1);
+}
+
+// Block header is padded so the data starts aligned
+static
+knx_arena_block* knx_arena_block_new(size_t size) {
+	knx_arena_block* block;
+
+	if (posix_memalign((void**) &block, KNX_ARENA_ALIGNMENT, sizeof(knx_arena_block) + size) != 0)
+		return NULL;
+
+	block->next = NULL;
+	block->size = size;
+	block->used = knx_arena_align(sizeof(knx_arena_block)) - sizeof(knx_arena_block);
+
+	return block;
+}
+
+void knx_arena_init(knx_arena* arena, size_t block_size) {
+	arena->head = NULL;
+	arena->block_size = block_size > 0 ? knx_arena_align(block_size) : KNX_ARENA_BLOCK_SIZE;
+}
+
+void knx_arena_destroy(knx_arena* arena) {
+	knx_arena_block* block = arena->head;
+
+	while (block) {
+		knx_arena_block* next = block->next;
+		free(block);
+		block = next;
+	}
+
+	arena->head = NULL;
+}
+
+void knx_arena_reset(knx_arena* arena) {
+	if (!arena->head)
+		return;
+
+	knx_arena_block* head = arena->head;
+	arena->head = head->next;
+	knx_arena_destroy(arena);
+
+	head->next = NULL;
+	head->used = knx_arena_align(sizeof(knx_arena_block)) - sizeof(knx_arena_block);
+	arena->head = head;
+}
+
+void* knx_arena_alloc(knx_arena* arena, size_t size) {
+	size_t padding = knx_arena_align(sizeof(knx_arena_block)) - sizeof(knx_arena_block);
+	size = knx_arena_align(size > 0 ? size : 1);
+
+	knx_arena_block* head = arena->head;
+
+	if (head && head->size - head->used >= size) {
+		void* result = head->data + head->used;
+		head->used += size;
+		return result;
+	}
+
+	// Large allocations are placed behind the head, which keeps serving small ones
+	if (size > arena->block_size / 4) {
+		knx_arena_block* block = knx_arena_block_new(padding + size);
+		if (!block)
+			return NULL;
+
+		block->used += size;
+
+		if (head) {
+			block->next = head->next;
+			head->next = block;
+		} else {
+			arena->head = block;
+		}
+
+		return block->data + padding;
+	}
+
+	knx_arena_block* block = knx_arena_block_new(arena->block_size);
+	if (!block)
+		return NULL;
+
+	block->next = head;
+	arena->head = block;
+
+	void* result = block->data + block->used;
+	block->used += size;
+
+	return result;
+}
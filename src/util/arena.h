@@ -0,0 +1,108 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_UTIL_ARENA_H_
+#define KNXPROTO_UTIL_ARENA_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Default block size
+ */
+#define KNX_ARENA_BLOCK_SIZE 4096
+
+/**
+ * Alignment of every allocation
+ */
+#define KNX_ARENA_ALIGNMENT 16
+
+typedef struct _knx_arena_block knx_arena_block;
+
+/**
+ * Arena Block
+ */
+struct _knx_arena_block {
+	knx_arena_block* next;
+	size_t           size;
+	size_t           used;
+	uint8_t          data[];
+};
+
+/**
+ * Bump Allocator
+ *
+ * Hands out memory from large blocks by advancing an offset. Individual allocations cannot be
+ * freed, instead `knx_arena_reset` releases everything at once. This suits batches of parsed
+ * frames which share a lifetime.
+ *
+ * Allocations that exceed a quarter of the block size get a block of their own, so they do not
+ * waste the remainder of the current block.
+ */
+typedef struct {
+	/**
+	 * Block which serves allocations, followed by the exhausted and the dedicated blocks
+	 */
+	knx_arena_block* head;
+
+	/**
+	 * Size of regular blocks
+	 */
+	size_t block_size;
+} knx_arena;
+
+/**
+ * Initialize the arena. No memory is allocated until the first call to `knx_arena_alloc`.
+ *
+ * \param arena      Arena
+ * \param block_size Size of regular blocks (`0` selects `KNX_ARENA_BLOCK_SIZE`)
+ */
+void knx_arena_init(knx_arena* arena, size_t block_size);
+
+/**
+ * Free all blocks.
+ */
+void knx_arena_destroy(knx_arena* arena);
+
+/**
+ * Release all allocations. The current block is kept for reuse.
+ */
+void knx_arena_reset(knx_arena* arena);
+
+/**
+ * Allocate `size` bytes aligned to `KNX_ARENA_ALIGNMENT`.
+ *
+ * \returns Pointer to the memory or `NULL` if a new block could not be allocated
+ */
+void* knx_arena_alloc(knx_arena* arena, size_t size);
+
+/**
+ * Allocate a new instance of `t` in an arena.
+ */
+#define knx_arena_new(a, t) ((t*) knx_arena_alloc(a, sizeof(t)))
+
+/**
+ * Allocate an array of `n` instances of `t` in an arena.
+ */
+#define knx_arena_newa(a, t, n) ((t*) knx_arena_alloc(a, sizeof(t) * (n)))
+
+#endif
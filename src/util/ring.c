@@ -0,0 +1,197 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "ring.h"
+#include "alloc.h"
+
+#include <string.h>
+
+inline static
+bool knx_event_fits(const knx_ldata* ldata) {
+	return
+		(ldata->tpdu.tpci != KNX_TPCI_UNNUMBERED_DATA && ldata->tpdu.tpci != KNX_TPCI_NUMBERED_DATA) ||
+		ldata->tpdu.info.data.length <= KNX_EVENT_APDU_SIZE;
+}
+
+bool knx_event_set(knx_event* event, knx_cemi_service service, const knx_ldata* ldata) {
+	if (!knx_event_fits(ldata))
+		return false;
+
+	event->service = service;
+	event->ldata = *ldata;
+
+	switch (ldata->tpdu.tpci) {
+		case KNX_TPCI_UNNUMBERED_DATA:
+		case KNX_TPCI_NUMBERED_DATA: {
+			size_t length = ldata->tpdu.info.data.length;
+
+			memcpy(event->apdu, ldata->tpdu.info.data.payload, length);
+			event->ldata.tpdu.info.data.payload = event->apdu;
+
+			if (length > 0)
+				event->apdu[0] &= 63;
+
+			return true;
+		}
+
+		default:
+			return true;
+	}
+}
+
+static
+size_t knx_ring_capacity(size_t capacity) {
+	size_t result = 2;
+
+	while (result < capacity)
+		result <<= 1;
+
+	return result;
+}
+
+size_t knx_spsc_index_init(knx_spsc_index* index, size_t capacity) {
+	capacity = knx_ring_capacity(capacity);
+
+	index->mask = capacity - 1;
+	index->head = 0;
+	index->cached_tail = 0;
+	index->tail = 0;
+
+	return capacity;
+}
+
+bool knx_spsc_ring_init(knx_spsc_ring* ring, size_t capacity) {
+	ring->slots = newa(knx_event, knx_spsc_index_init(&ring->index, capacity));
+	return ring->slots != NULL;
+}
+
+void knx_spsc_ring_destroy(knx_spsc_ring* ring) {
+	free(ring->slots);
+	ring->slots = NULL;
+}
+
+knx_event* knx_spsc_ring_reserve(knx_spsc_ring* ring) {
+	size_t slot;
+	return knx_spsc_index_reserve(&ring->index, &slot) ? &ring->slots[slot] : NULL;
+}
+
+void knx_spsc_ring_commit(knx_spsc_ring* ring) {
+	knx_spsc_index_commit(&ring->index);
+}
+
+bool knx_spsc_ring_publish(knx_spsc_ring* ring, knx_cemi_service service, const knx_ldata* ldata) {
+	knx_event* event = knx_spsc_ring_reserve(ring);
+
+	if (!event || !knx_event_set(event, service, ldata))
+		return false;
+
+	knx_spsc_ring_commit(ring);
+	return true;
+}
+
+size_t knx_spsc_ring_drain(knx_spsc_ring* ring, knx_event_handler handler, void* data, size_t max) {
+	// One synchronization per batch on either index
+	size_t count = knx_spsc_index_peek(&ring->index);
+	if (count > max)
+		count = max;
+
+	for (size_t i = 0; i < count; i++)
+		handler(data, &ring->slots[(ring->index.tail + i) & ring->index.mask]);
+
+	// Slots are handed back to the producer all at once
+	knx_spsc_index_release(&ring->index, count);
+	return count;
+}
+
+bool knx_mpsc_ring_init(knx_mpsc_ring* ring, size_t capacity) {
+	capacity = knx_ring_capacity(capacity);
+
+	ring->cells = newa(knx_mpsc_cell, capacity);
+	if (!ring->cells)
+		return false;
+
+	for (size_t i = 0; i < capacity; i++)
+		ring->cells[i].sequence = i;
+
+	ring->mask = capacity - 1;
+	ring->head = 0;
+	ring->tail = 0;
+
+	return true;
+}
+
+void knx_mpsc_ring_destroy(knx_mpsc_ring* ring) {
+	free(ring->cells);
+	ring->cells = NULL;
+}
+
+// A cell whose sequence equals the position is free, one that equals the position + 1 is
+// readable. The consumer advances the sequence by the capacity when it releases a cell.
+
+bool knx_mpsc_ring_publish(knx_mpsc_ring* ring, knx_cemi_service service, const knx_ldata* ldata) {
+	// Once claimed, a cell has to be published, so the frame is checked beforehand
+	if (!knx_event_fits(ldata))
+		return false;
+
+	size_t position = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+	knx_mpsc_cell* cell;
+
+	while (true) {
+		cell = &ring->cells[position & ring->mask];
+
+		size_t sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+		intptr_t difference = (intptr_t) sequence - (intptr_t) position;
+
+		if (difference == 0) {
+			if (__atomic_compare_exchange_n(&ring->head, &position, position + 1, true,
+			                                __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+				break;
+		} else if (difference < 0) {
+			return false;
+		} else {
+			position = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+		}
+	}
+
+	knx_event_set(&cell->event, service, ldata);
+
+	__atomic_store_n(&cell->sequence, position + 1, __ATOMIC_RELEASE);
+	return true;
+}
+
+size_t knx_mpsc_ring_drain(knx_mpsc_ring* ring, knx_event_handler handler, void* data, size_t max) {
+	size_t count = 0;
+
+	while (count < max) {
+		knx_mpsc_cell* cell = &ring->cells[ring->tail & ring->mask];
+
+		if (__atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE) != ring->tail + 1)
+			break;
+
+		handler(data, &cell->event);
+		count++;
+
+		__atomic_store_n(&cell->sequence, ring->tail + ring->mask + 1, __ATOMIC_RELEASE);
+		ring->tail++;
+	}
+
+	return count;
+}
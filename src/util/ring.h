@@ -0,0 +1,250 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_UTIL_RING_H_
+#define KNXPROTO_UTIL_RING_H_
+
+#include "../proto/cemi.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Maximum APDU length stored inline in an event
+ */
+#define KNX_EVENT_APDU_SIZE 64
+
+/**
+ * Keeps members written by different threads on separate cache lines
+ */
+#define KNX_CACHE_ALIGNED __attribute__((aligned(64)))
+
+/**
+ * Decoded L_Data Event
+ *
+ * Fixed-size slot which carries the APDU inline. `ldata.tpdu.info.data.payload` points into
+ * `apdu`, hence events have to be consumed in place and must not be copied by value.
+ */
+typedef struct {
+	/**
+	 * cEMI message code the frame arrived with
+	 */
+	knx_cemi_service service;
+
+	/**
+	 * L_Data frame
+	 */
+	knx_ldata ldata;
+
+	/**
+	 * APDU storage
+	 */
+	uint8_t apdu[KNX_EVENT_APDU_SIZE];
+} knx_event;
+
+/**
+ * Store an L_Data frame in an event. Like `knx_ldata_duplicate`, the APCI bits are cleared from
+ * the first APDU byte.
+ *
+ * \returns `true` on success, `false` if the APDU does not fit
+ */
+bool knx_event_set(knx_event* event, knx_cemi_service service, const knx_ldata* ldata);
+
+/**
+ * Event handler used to drain rings
+ */
+typedef void (* knx_event_handler)(void* data, const knx_event* event);
+
+/**
+ * Single-Producer Single-Consumer Ring Indices
+ *
+ * Index handling for rings with any kind of slot storage. The producer keeps a cached copy of
+ * the consumer index and only reads the shared one when the cache says the ring is full. The
+ * consumer reads the producer index and publishes its own index once per batch.
+ */
+typedef struct {
+	size_t mask;
+
+	/**
+	 * Producer side
+	 */
+	size_t head KNX_CACHE_ALIGNED;
+	size_t cached_tail;
+
+	/**
+	 * Consumer side
+	 */
+	size_t tail KNX_CACHE_ALIGNED;
+} knx_spsc_index;
+
+/**
+ * Reset the indices.
+ *
+ * \param index    Indices
+ * \param capacity Minimum number of slots
+ * \returns Number of slots the storage must provide (`capacity` rounded up to a power of 2)
+ */
+size_t knx_spsc_index_init(knx_spsc_index* index, size_t capacity);
+
+/**
+ * Find the next free slot (producer only).
+ *
+ * \param index Indices
+ * \param slot  Output slot number
+ * \returns `true` on success, `false` if the ring is full
+ */
+inline static
+bool knx_spsc_index_reserve(knx_spsc_index* index, size_t* slot) {
+	if (index->head - index->cached_tail > index->mask) {
+		index->cached_tail = __atomic_load_n(&index->tail, __ATOMIC_ACQUIRE);
+
+		if (index->head - index->cached_tail > index->mask)
+			return false;
+	}
+
+	*slot = index->head & index->mask;
+	return true;
+}
+
+/**
+ * Make the reserved slot visible to the consumer (producer only).
+ */
+inline static
+void knx_spsc_index_commit(knx_spsc_index* index) {
+	__atomic_store_n(&index->head, index->head + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Count the committed slots which have not been released yet (consumer only). The `n`-th of
+ * them is `(index->tail + n) & index->mask`.
+ */
+inline static
+size_t knx_spsc_index_peek(const knx_spsc_index* index) {
+	return __atomic_load_n(&index->head, __ATOMIC_ACQUIRE) - index->tail;
+}
+
+/**
+ * Hand the first `count` pending slots back to the producer (consumer only).
+ */
+inline static
+void knx_spsc_index_release(knx_spsc_index* index, size_t count) {
+	__atomic_store_n(&index->tail, index->tail + count, __ATOMIC_RELEASE);
+}
+
+/**
+ * Single-Producer Single-Consumer Ring
+ *
+ * Event slots managed by a `knx_spsc_index`.
+ */
+typedef struct {
+	knx_event*     slots;
+	knx_spsc_index index;
+} knx_spsc_ring;
+
+/**
+ * Allocate the slots. This is the only allocation the ring performs.
+ *
+ * \param ring     Ring
+ * \param capacity Number of slots (rounded up to a power of 2)
+ */
+bool knx_spsc_ring_init(knx_spsc_ring* ring, size_t capacity);
+
+/**
+ * Free the slots.
+ */
+void knx_spsc_ring_destroy(knx_spsc_ring* ring);
+
+/**
+ * Reserve the next slot, e.g. to decode straight into it (producer only).
+ *
+ * \returns Slot or `NULL` if the ring is full
+ */
+knx_event* knx_spsc_ring_reserve(knx_spsc_ring* ring);
+
+/**
+ * Make the reserved slot visible to the consumer (producer only).
+ */
+void knx_spsc_ring_commit(knx_spsc_ring* ring);
+
+/**
+ * Copy an L_Data frame into the next slot and make it visible (producer only).
+ *
+ * \returns `true` on success, `false` if the ring is full or the APDU does not fit
+ */
+bool knx_spsc_ring_publish(knx_spsc_ring* ring, knx_cemi_service service, const knx_ldata* ldata);
+
+/**
+ * Invoke the handler for up to `max` pending events and release their slots (consumer only).
+ *
+ * \returns Number of handled events
+ */
+size_t knx_spsc_ring_drain(knx_spsc_ring* ring, knx_event_handler handler, void* data, size_t max);
+
+/**
+ * Multi-Producer Single-Consumer Ring Slot
+ */
+typedef struct {
+	size_t    sequence;
+	knx_event event;
+} knx_mpsc_cell;
+
+/**
+ * Multi-Producer Single-Consumer Ring
+ *
+ * Producers claim slots with a compare-and-swap on `head` and publish them through a
+ * per-slot sequence number, so a slow producer never blocks the others from claiming.
+ */
+typedef struct {
+	knx_mpsc_cell* cells;
+	size_t         mask;
+
+	size_t head KNX_CACHE_ALIGNED;
+	size_t tail KNX_CACHE_ALIGNED;
+} knx_mpsc_ring;
+
+/**
+ * Allocate the slots.
+ *
+ * \see knx_spsc_ring_init
+ */
+bool knx_mpsc_ring_init(knx_mpsc_ring* ring, size_t capacity);
+
+/**
+ * Free the slots.
+ */
+void knx_mpsc_ring_destroy(knx_mpsc_ring* ring);
+
+/**
+ * Copy an L_Data frame into the next slot and make it visible (any thread).
+ *
+ * \returns `true` on success, `false` if the ring is full or the APDU does not fit
+ */
+bool knx_mpsc_ring_publish(knx_mpsc_ring* ring, knx_cemi_service service, const knx_ldata* ldata);
+
+/**
+ * Invoke the handler for up to `max` pending events and release their slots (consumer only).
+ *
+ * \returns Number of handled events
+ */
+size_t knx_mpsc_ring_drain(knx_mpsc_ring* ring, knx_event_handler handler, void* data, size_t max);
+
+#endif
@@ -0,0 +1,172 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "slab.h"
+#include "alloc.h"
+
+#include <string.h>
+
+bool knx_ldata_slab_init(knx_ldata_slab* slab, size_t capacity) {
+	slab->slots = newa(knx_ldata_shared, capacity);
+	if (!slab->slots)
+		return false;
+
+	if (pthread_mutex_init(&slab->lock, NULL) != 0) {
+		free(slab->slots);
+		return false;
+	}
+
+	slab->capacity = capacity;
+	slab->free = NULL;
+
+	for (size_t i = capacity; i > 0; i--) {
+		slab->slots[i - 1].next = slab->free;
+		slab->free = &slab->slots[i - 1];
+	}
+
+	return true;
+}
+
+void knx_ldata_slab_destroy(knx_ldata_slab* slab) {
+	pthread_mutex_destroy(&slab->lock);
+	free(slab->slots);
+
+	slab->slots = NULL;
+	slab->free = NULL;
+}
+
+void knx_ldata_slab_cache_init(knx_ldata_slab_cache* cache, knx_ldata_slab* slab) {
+	cache->slab = slab;
+	cache->free = NULL;
+	cache->count = 0;
+}
+
+// Keep the `keep` most recently released slots, they are likely still in the CPU cache, and hand
+// the rest back to the slab
+static
+void knx_ldata_slab_cache_trim(knx_ldata_slab_cache* cache, size_t keep) {
+	if (cache->count <= keep)
+		return;
+
+	knx_ldata_shared** link = &cache->free;
+
+	for (size_t i = 0; i < keep; i++)
+		link = &(*link)->next;
+
+	knx_ldata_shared* first = *link;
+	knx_ldata_shared* last = first;
+
+	while (last->next)
+		last = last->next;
+
+	*link = NULL;
+	cache->count = keep;
+
+	pthread_mutex_lock(&cache->slab->lock);
+	last->next = cache->slab->free;
+	cache->slab->free = first;
+	pthread_mutex_unlock(&cache->slab->lock);
+}
+
+static
+void knx_ldata_slab_cache_refill(knx_ldata_slab_cache* cache) {
+	knx_ldata_slab* slab = cache->slab;
+
+	pthread_mutex_lock(&slab->lock);
+
+	while (slab->free && cache->count < KNX_LDATA_SLAB_BATCH) {
+		knx_ldata_shared* slot = slab->free;
+		slab->free = slot->next;
+
+		slot->next = cache->free;
+		cache->free = slot;
+		cache->count++;
+	}
+
+	pthread_mutex_unlock(&slab->lock);
+}
+
+void knx_ldata_slab_cache_destroy(knx_ldata_slab_cache* cache) {
+	knx_ldata_slab_cache_trim(cache, 0);
+}
+
+knx_ldata_shared* knx_ldata_slab_duplicate(knx_ldata_slab_cache* cache, const knx_ldata* ldata) {
+	bool data =
+		ldata->tpdu.tpci == KNX_TPCI_UNNUMBERED_DATA || ldata->tpdu.tpci == KNX_TPCI_NUMBERED_DATA;
+	size_t length = data ? ldata->tpdu.info.data.length : 0;
+
+	knx_ldata_shared* shared;
+	uint8_t* apdu;
+
+	if (length > KNX_LDATA_SLAB_APDU_SIZE) {
+		shared = malloc(sizeof(knx_ldata_shared) + length);
+		if (!shared)
+			return NULL;
+
+		shared->heap = true;
+		apdu = (uint8_t*) (shared + 1);
+	} else {
+		if (cache->count == 0)
+			knx_ldata_slab_cache_refill(cache);
+
+		if (cache->count == 0)
+			return NULL;
+
+		shared = cache->free;
+		cache->free = shared->next;
+		cache->count--;
+
+		shared->heap = false;
+		apdu = shared->apdu;
+	}
+
+	shared->ldata = *ldata;
+	shared->refs = 1;
+	shared->next = NULL;
+
+	if (data) {
+		memcpy(apdu, ldata->tpdu.info.data.payload, length);
+		shared->ldata.tpdu.info.data.payload = apdu;
+
+		if (length > 0)
+			apdu[0] &= 63;
+	}
+
+	return shared;
+}
+
+void knx_ldata_shared_release(knx_ldata_slab_cache* cache, knx_ldata_shared* shared) {
+	if (__atomic_fetch_sub(&shared->refs, 1, __ATOMIC_ACQ_REL) != 1)
+		return;
+
+	if (shared->heap) {
+		free(shared);
+		return;
+	}
+
+	shared->next = cache->free;
+	cache->free = shared;
+	cache->count++;
+
+	// Keep a batch for the next allocations
+	if (cache->count >= 2 * KNX_LDATA_SLAB_BATCH)
+		knx_ldata_slab_cache_trim(cache, KNX_LDATA_SLAB_BATCH);
+}
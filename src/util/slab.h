@@ -0,0 +1,143 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_UTIL_SLAB_H_
+#define KNXPROTO_UTIL_SLAB_H_
+
+#include "../proto/ldata.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * APDU capacity of a slot, enough for any standard frame
+ */
+#define KNX_LDATA_SLAB_APDU_SIZE 16
+
+/**
+ * Number of slots moved between a cache and its slab at once
+ */
+#define KNX_LDATA_SLAB_BATCH 32
+
+typedef struct _knx_ldata_shared knx_ldata_shared;
+
+/**
+ * Reference-counted L_Data Copy
+ *
+ * `ldata.tpdu.info.data.payload` points into the copy itself. The copy is immutable while it is
+ * shared.
+ */
+struct _knx_ldata_shared {
+	knx_ldata ldata;
+
+	/**
+	 * Number of references, modified atomically
+	 */
+	uint32_t refs;
+
+	/**
+	 * Set if the APDU did not fit into a slot and the copy lives on the heap
+	 */
+	bool heap;
+
+	/**
+	 * Next free slot
+	 */
+	knx_ldata_shared* next;
+
+	uint8_t apdu[KNX_LDATA_SLAB_APDU_SIZE];
+};
+
+/**
+ * Fixed-size Pool of L_Data Copies
+ *
+ * All slots are allocated up front. Threads do not take slots from the slab directly but through
+ * a `knx_ldata_slab_cache` each, which exchanges slots with the shared free list in batches. The
+ * lock protecting the shared list is therefore taken once every `KNX_LDATA_SLAB_BATCH`
+ * allocations or releases.
+ */
+typedef struct {
+	knx_ldata_shared* slots;
+	size_t            capacity;
+
+	pthread_mutex_t   lock;
+	knx_ldata_shared* free;
+} knx_ldata_slab;
+
+/**
+ * Per-thread Free List
+ */
+typedef struct {
+	knx_ldata_slab*   slab;
+	knx_ldata_shared* free;
+	size_t            count;
+} knx_ldata_slab_cache;
+
+/**
+ * Allocate the slots.
+ *
+ * \param slab     Slab
+ * \param capacity Number of slots
+ */
+bool knx_ldata_slab_init(knx_ldata_slab* slab, size_t capacity);
+
+/**
+ * Free the slots. All caches must have been destroyed and all copies released.
+ */
+void knx_ldata_slab_destroy(knx_ldata_slab* slab);
+
+/**
+ * Initialize a cache. A cache must only be used by one thread at a time.
+ */
+void knx_ldata_slab_cache_init(knx_ldata_slab_cache* cache, knx_ldata_slab* slab);
+
+/**
+ * Return all cached slots to the slab.
+ */
+void knx_ldata_slab_cache_destroy(knx_ldata_slab_cache* cache);
+
+/**
+ * Duplicate an L_Data frame with a reference count of 1. Like `knx_ldata_duplicate`, the APCI
+ * bits are cleared from the first APDU byte. APDUs larger than `KNX_LDATA_SLAB_APDU_SIZE` are
+ * copied to the heap.
+ *
+ * \returns Copy or `NULL` if the slab is exhausted
+ */
+knx_ldata_shared* knx_ldata_slab_duplicate(knx_ldata_slab_cache* cache, const knx_ldata* ldata);
+
+/**
+ * Add a reference (any thread).
+ */
+inline static
+knx_ldata_shared* knx_ldata_shared_retain(knx_ldata_shared* shared) {
+	__atomic_fetch_add(&shared->refs, 1, __ATOMIC_RELAXED);
+	return shared;
+}
+
+/**
+ * Drop a reference. The last reference returns the slot to the given cache, which may belong to
+ * a different thread than the one which made the copy.
+ */
+void knx_ldata_shared_release(knx_ldata_slab_cache* cache, knx_ldata_shared* shared);
+
+#endif
@@ -0,0 +1,148 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "timerwheel.h"
+
+#include <string.h>
+#include <time.h>
+
+#define KNX_TIMER_WHEEL_MASK (KNX_TIMER_WHEEL_SLOTS - 1)
+
+void knx_timer_wheel_init(knx_timer_wheel* wheel, uint64_t now, uint32_t resolution) {
+	wheel->now = now;
+	wheel->resolution = resolution > 0 ? resolution : 1;
+	wheel->tick = now / wheel->resolution;
+
+	memset(wheel->slots, 0, sizeof(wheel->slots));
+}
+
+void knx_timer_init(knx_timer* timer, knx_timer_callback callback, void* data) {
+	timer->next = NULL;
+	timer->prev_next = NULL;
+	timer->deadline = 0;
+	timer->callback = callback;
+	timer->data = data;
+}
+
+inline static
+void knx_timer_link(knx_timer** head, knx_timer* timer) {
+	timer->next = *head;
+	timer->prev_next = head;
+
+	if (*head)
+		(*head)->prev_next = &timer->next;
+
+	*head = timer;
+}
+
+void knx_timer_cancel(knx_timer* timer) {
+	if (!timer->prev_next)
+		return;
+
+	*timer->prev_next = timer->next;
+
+	if (timer->next)
+		timer->next->prev_next = timer->prev_next;
+
+	timer->next = NULL;
+	timer->prev_next = NULL;
+}
+
+inline static
+void knx_timer_wheel_insert(knx_timer_wheel* wheel, knx_timer* timer) {
+	// Round up, so a timer never fires before its deadline
+	uint64_t tick = (timer->deadline + wheel->resolution - 1) / wheel->resolution;
+
+	// Timers that are already due are picked up by the next tick
+	if (tick <= wheel->tick)
+		tick = wheel->tick + 1;
+
+	knx_timer_link(&wheel->slots[tick & KNX_TIMER_WHEEL_MASK], timer);
+}
+
+void knx_timer_schedule(knx_timer_wheel* wheel, knx_timer* timer, uint64_t delay) {
+	knx_timer_cancel(timer);
+
+	timer->deadline = wheel->now + delay;
+	knx_timer_wheel_insert(wheel, timer);
+}
+
+size_t knx_timer_wheel_advance(knx_timer_wheel* wheel, uint64_t now) {
+	if (now < wheel->now)
+		return 0;
+
+	wheel->now = now;
+
+	uint64_t target = now / wheel->resolution;
+	size_t fired = 0;
+
+	// Visiting each slot once suffices to process every armed timer
+	if (target - wheel->tick > KNX_TIMER_WHEEL_SLOTS)
+		wheel->tick = target - KNX_TIMER_WHEEL_SLOTS;
+
+	while (wheel->tick < target) {
+		wheel->tick++;
+
+		// Move the slot contents aside, because callbacks may schedule timers into this slot
+		knx_timer* pending = NULL;
+		knx_timer** slot = &wheel->slots[wheel->tick & KNX_TIMER_WHEEL_MASK];
+
+		if (!*slot)
+			continue;
+
+		pending = *slot;
+		pending->prev_next = &pending;
+		*slot = NULL;
+
+		while (pending) {
+			knx_timer* timer = pending;
+			knx_timer_cancel(timer);
+
+			if (timer->deadline <= now) {
+				fired++;
+				timer->callback(timer, timer->data);
+			} else {
+				// Deadline lies in a later revolution of the wheel
+				knx_timer_link(slot, timer);
+			}
+		}
+	}
+
+	return fired;
+}
+
+int knx_timer_wheel_timeout(const knx_timer_wheel* wheel) {
+	for (uint64_t i = 1; i <= KNX_TIMER_WHEEL_SLOTS; i++) {
+		if (wheel->slots[(wheel->tick + i) & KNX_TIMER_WHEEL_MASK]) {
+			uint64_t due = (wheel->tick + i) * wheel->resolution;
+			return due > wheel->now ? (int) (due - wheel->now) : 0;
+		}
+	}
+
+	return -1;
+}
+
+uint64_t knx_timer_now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
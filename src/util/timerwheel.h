@@ -0,0 +1,147 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_UTIL_TIMERWHEEL_H_
+#define KNXPROTO_UTIL_TIMERWHEEL_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Number of slots in a timer wheel (must be a power of 2)
+ */
+#define KNX_TIMER_WHEEL_SLOTS 256
+
+typedef struct _knx_timer knx_timer;
+
+/**
+ * Timer callback
+ *
+ * \param timer Expired timer, it may be rescheduled from within the callback
+ * \param data  User data given to `knx_timer_init`
+ */
+typedef void (* knx_timer_callback)(knx_timer* timer, void* data);
+
+/**
+ * Intrusive Timer
+ *
+ * Timers are embedded in the structures that use them. The wheel never allocates, so a timer
+ * cannot leak; it only has to be cancelled before its storage goes away.
+ */
+struct _knx_timer {
+	knx_timer*  next;
+	knx_timer** prev_next;
+
+	/**
+	 * Absolute expiry time in milliseconds
+	 */
+	uint64_t deadline;
+
+	knx_timer_callback callback;
+	void*              data;
+};
+
+/**
+ * Hashed Timer Wheel
+ *
+ * Timers are hashed into slots by their deadline tick. Scheduling and cancelling are O(1),
+ * advancing visits only the slots whose ticks have passed. Time is supplied by the user, hence
+ * there is no system call per timer.
+ */
+typedef struct {
+	/**
+	 * Time given to the last call to `knx_timer_wheel_advance` in milliseconds
+	 */
+	uint64_t now;
+
+	/**
+	 * Last processed tick
+	 */
+	uint64_t tick;
+
+	/**
+	 * Tick length in milliseconds
+	 */
+	uint32_t resolution;
+
+	knx_timer* slots[KNX_TIMER_WHEEL_SLOTS];
+} knx_timer_wheel;
+
+/**
+ * Initialize the timer wheel.
+ *
+ * \param wheel      Timer wheel
+ * \param now        Current time in milliseconds
+ * \param resolution Tick length in milliseconds
+ */
+void knx_timer_wheel_init(knx_timer_wheel* wheel, uint64_t now, uint32_t resolution);
+
+/**
+ * Initialize a timer.
+ */
+void knx_timer_init(knx_timer* timer, knx_timer_callback callback, void* data);
+
+/**
+ * Check whether the timer is scheduled.
+ */
+inline static
+bool knx_timer_armed(const knx_timer* timer) {
+	return timer->prev_next != NULL;
+}
+
+/**
+ * Schedule a timer. If the timer is already armed, it will be rescheduled.
+ *
+ * \param wheel Timer wheel
+ * \param timer Timer
+ * \param delay Delay in milliseconds relative to `wheel->now`
+ */
+void knx_timer_schedule(knx_timer_wheel* wheel, knx_timer* timer, uint64_t delay);
+
+/**
+ * Cancel a timer. Nothing happens if it is not armed.
+ */
+void knx_timer_cancel(knx_timer* timer);
+
+/**
+ * Fire all timers that have expired until `now`.
+ *
+ * \param wheel Timer wheel
+ * \param now   Current time in milliseconds
+ * \returns Number of fired timers
+ */
+size_t knx_timer_wheel_advance(knx_timer_wheel* wheel, uint64_t now);
+
+/**
+ * Determine how long one may wait until the next call to `knx_timer_wheel_advance` is due.
+ * The result is suitable as a timeout for `poll` or `epoll_wait`.
+ *
+ * \returns Milliseconds until the earliest occupied slot or `-1` if no timer is armed
+ */
+int knx_timer_wheel_timeout(const knx_timer_wheel* wheel);
+
+/**
+ * Current time of the monotonic clock in milliseconds
+ */
+uint64_t knx_timer_now(void);
+
+#endif
@@ -2,10 +2,22 @@
 
 externtest(knxnetip)
 externtest(cemi)
+externtest(view)
+externtest(stream)
+externtest(transport)
+externtest(tunnel)
+externtest(ring)
+externtest(arena)
 
 deftest(all, {
 	runsubtest(knxnetip);
 	runsubtest(cemi);
+	runsubtest(view);
+	runsubtest(stream);
+	runsubtest(transport);
+	runsubtest(tunnel);
+	runsubtest(ring);
+	runsubtest(arena);
 })
 
 int main(void) {
@@ -0,0 +1,261 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "testfw.h"
+
+#include "../src/util/arena.h"
+#include "../src/proto/descres.h"
+#include "../src/proto/ldata.h"
+#include "../src/util/slab.h"
+
+#include <pthread.h>
+#include <string.h>
+
+deftest(knx_arena, {
+	knx_arena arena;
+	knx_arena_init(&arena, 256);
+	assert(arena.head == NULL);
+
+	// Allocations are aligned and share a block
+	uint8_t* a = knx_arena_alloc(&arena, 3);
+	uint8_t* b = knx_arena_alloc(&arena, 5);
+
+	assert(a != NULL && b != NULL);
+	assert((uintptr_t) a % KNX_ARENA_ALIGNMENT == 0);
+	assert((uintptr_t) b % KNX_ARENA_ALIGNMENT == 0);
+	assert(b == a + KNX_ARENA_ALIGNMENT);
+
+	knx_arena_block* head = arena.head;
+
+	// Large allocations get a dedicated block behind the head
+	uint8_t* large = knx_arena_alloc(&arena, 1000);
+	assert(large != NULL);
+	assert((uintptr_t) large % KNX_ARENA_ALIGNMENT == 0);
+	assert(arena.head == head);
+	assert(head->next != NULL && head->next->size >= 1000);
+
+	memset(large, 0xFF, 1000);
+	assert(knx_arena_alloc(&arena, 16) == b + KNX_ARENA_ALIGNMENT);
+
+	// Exhausting the head starts a new block
+	for (size_t i = 0; i < 32; i++)
+		assert(knx_arena_alloc(&arena, 32) != NULL);
+
+	assert(arena.head != head);
+
+	// Reset keeps the current block only
+	head = arena.head;
+	knx_arena_reset(&arena);
+
+	assert(arena.head == head);
+	assert(head->next == NULL);
+	assert(knx_arena_alloc(&arena, 1) == head->data + head->used - KNX_ARENA_ALIGNMENT);
+
+	knx_arena_destroy(&arena);
+	assert(arena.head == NULL);
+})
+
+deftest(knx_description_response_parse_arena, {
+	knx_description_service services[3] = {{2, 1}, {3, 1}, {4, 1}};
+
+	knx_description_response res = {
+		.medium = 2,
+		.address = knx_individual_addr(1, 1, 0),
+		.name = "Gateway",
+		.num_services = 3,
+		.services = services
+	};
+
+	uint8_t buffer[knx_description_response_size(&res)];
+	assert(knx_description_response_generate(buffer, &res));
+
+	knx_arena arena;
+	knx_arena_init(&arena, 0);
+
+	// Many responses share the arena and are released at once
+	knx_description_response parsed[8];
+
+	for (size_t i = 0; i < 8; i++) {
+		assert(knx_description_response_parse_arena(buffer, sizeof(buffer), &parsed[i], &arena));
+		assert(parsed[i].num_services == 3);
+		assert(parsed[i].services[2].family == 4);
+		assert(strcmp(parsed[i].name, "Gateway") == 0);
+	}
+
+	assert(arena.head != NULL && arena.head->next == NULL);
+	assert(parsed[1].services != parsed[0].services);
+
+	knx_arena_destroy(&arena);
+})
+
+deftest(knx_ldata_duplicate_arena, {
+	const uint8_t apdu[] = {0x81, 0x12, 0x34};
+
+	knx_ldata ldata;
+	memset(&ldata, 0, sizeof(ldata));
+
+	ldata.control2.address_type = KNX_LDATA_ADDR_GROUP;
+	ldata.destination = knx_group_addr(1, 2, 3);
+	ldata.tpdu.tpci = KNX_TPCI_UNNUMBERED_DATA;
+	ldata.tpdu.info.data.apci = KNX_APCI_GROUPVALUEWRITE;
+	ldata.tpdu.info.data.payload = apdu;
+	ldata.tpdu.info.data.length = sizeof(apdu);
+
+	knx_arena arena;
+	knx_arena_init(&arena, 0);
+
+	knx_ldata* copy = knx_ldata_duplicate_arena(&ldata, &arena);
+	assert(copy != NULL);
+	assert(copy->destination == ldata.destination);
+	assert(copy->tpdu.info.data.payload != apdu);
+	assert(copy->tpdu.info.data.length == sizeof(apdu));
+
+	// APCI bits are cleared like in the heap variant
+	assert(copy->tpdu.info.data.payload[0] == 0x01);
+	assert(copy->tpdu.info.data.payload[2] == 0x34);
+
+	ldata.tpdu.tpci = KNX_TPCI_UNNUMBERED_CONTROL;
+	ldata.tpdu.info.control = KNX_TPCI_CONTROL_ACK;
+
+	copy = knx_ldata_duplicate_arena(&ldata, &arena);
+	assert(copy != NULL);
+	assert(copy->tpdu.info.control == KNX_TPCI_CONTROL_ACK);
+
+	knx_arena_destroy(&arena);
+})
+
+static
+size_t slab_test_free_slots(knx_ldata_slab* slab) {
+	size_t count = 0;
+
+	for (knx_ldata_shared* slot = slab->free; slot; slot = slot->next)
+		count++;
+
+	return count;
+}
+
+typedef struct {
+	knx_ldata_slab*    slab;
+	knx_ldata_shared** copies;
+	size_t             count;
+} slab_test_consumer;
+
+static
+void* slab_test_release(void* data) {
+	slab_test_consumer* consumer = data;
+
+	knx_ldata_slab_cache cache;
+	knx_ldata_slab_cache_init(&cache, consumer->slab);
+
+	for (size_t i = 0; i < consumer->count; i++)
+		knx_ldata_shared_release(&cache, consumer->copies[i]);
+
+	knx_ldata_slab_cache_destroy(&cache);
+	return NULL;
+}
+
+deftest(knx_ldata_slab, {
+	const uint8_t apdu[KNX_LDATA_SLAB_APDU_SIZE + 1] = {0x80, 0x12};
+
+	knx_ldata ldata;
+	memset(&ldata, 0, sizeof(ldata));
+
+	ldata.control2.address_type = KNX_LDATA_ADDR_GROUP;
+	ldata.destination = knx_group_addr(1, 2, 3);
+	ldata.tpdu.tpci = KNX_TPCI_UNNUMBERED_DATA;
+	ldata.tpdu.info.data.apci = KNX_APCI_GROUPVALUEWRITE;
+	ldata.tpdu.info.data.payload = apdu;
+	ldata.tpdu.info.data.length = 2;
+
+	knx_ldata_slab slab;
+	assert(knx_ldata_slab_init(&slab, 256));
+	assert(slab_test_free_slots(&slab) == 256);
+
+	knx_ldata_slab_cache cache;
+	knx_ldata_slab_cache_init(&cache, &slab);
+
+	// The first copy moves a batch into the cache
+	knx_ldata_shared* copy = knx_ldata_slab_duplicate(&cache, &ldata);
+	assert(copy != NULL && !copy->heap);
+	assert(copy->ldata.tpdu.info.data.payload == copy->apdu);
+	assert(copy->apdu[0] == 0 && copy->apdu[1] == 0x12);
+	assert(cache.count == KNX_LDATA_SLAB_BATCH - 1);
+	assert(slab_test_free_slots(&slab) == 256 - KNX_LDATA_SLAB_BATCH);
+
+	// Shared copies are recycled once the last reference is gone
+	knx_ldata_shared_retain(copy);
+	knx_ldata_shared_release(&cache, copy);
+	assert(cache.count == KNX_LDATA_SLAB_BATCH - 1);
+
+	knx_ldata_shared_release(&cache, copy);
+	assert(cache.count == KNX_LDATA_SLAB_BATCH);
+	assert(cache.free == copy);
+
+	// Oversized APDUs are copied to the heap
+	ldata.tpdu.info.data.length = sizeof(apdu);
+
+	knx_ldata_shared* large = knx_ldata_slab_duplicate(&cache, &ldata);
+	assert(large != NULL && large->heap);
+	assert(large->ldata.tpdu.info.data.length == sizeof(apdu));
+
+	knx_ldata_shared_release(&cache, large);
+	assert(cache.count == KNX_LDATA_SLAB_BATCH);
+
+	// Exhaustion
+	ldata.tpdu.info.data.length = 2;
+
+	static knx_ldata_shared* copies[256];
+
+	for (size_t i = 0; i < 256; i++) {
+		copies[i] = knx_ldata_slab_duplicate(&cache, &ldata);
+		assert(copies[i] != NULL);
+
+		// Two further references for the consumers
+		knx_ldata_shared_retain(copies[i]);
+		knx_ldata_shared_retain(copies[i]);
+	}
+
+	assert(knx_ldata_slab_duplicate(&cache, &ldata) == NULL);
+
+	// References are dropped by several threads, the last one recycles the slot
+	slab_test_consumer consumer = {&slab, copies, 256};
+	pthread_t threads[2];
+
+	for (size_t i = 0; i < 2; i++)
+		assert(pthread_create(&threads[i], NULL, slab_test_release, &consumer) == 0);
+
+	slab_test_release(&consumer);
+
+	for (size_t i = 0; i < 2; i++)
+		pthread_join(threads[i], NULL);
+
+	knx_ldata_slab_cache_destroy(&cache);
+	assert(slab_test_free_slots(&slab) == 256);
+
+	knx_ldata_slab_destroy(&slab);
+})
+
+deftest(arena, {
+	runsubtest(knx_arena);
+	runsubtest(knx_description_response_parse_arena);
+	runsubtest(knx_ldata_duplicate_arena);
+	runsubtest(knx_ldata_slab);
+})
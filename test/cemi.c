@@ -24,9 +24,123 @@
 #include "../src/proto/cemi.h"
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <string.h>
 
+deftest(knx_tpdu_value, {
+	// GroupValueWrite with two bytes of data
+	const uint8_t raw[] = {0x00, 0x80, 0x0C, 0x1A};
+
+	knx_tpdu_value value;
+	assert(knx_tpdu_value_parse(raw, sizeof(raw), &value));
+	assert(value.tpci == KNX_TPCI_UNNUMBERED_DATA);
+	assert(value.code == KNX_APCI_GROUPVALUEWRITE);
+	assert(value.length == 3);
+	assert(value.apdu[0] == 0 && value.apdu[1] == 0x0C && value.apdu[2] == 0x1A);
+
+	// Copies do not refer to the original buffer
+	knx_tpdu_value copy = value;
+	memset(&value, 0, sizeof(value));
+
+	uint8_t buffer[KNX_TPDU_INLINE_SIZE + 1];
+	assert(knx_tpdu_value_size(&copy) == sizeof(raw));
+
+	knx_tpdu_value_generate(buffer, &copy);
+	assert(memcmp(buffer, raw, sizeof(raw)) == 0);
+
+	// Views can be passed to functions expecting `knx_tpdu`
+	knx_tpdu info;
+	knx_tpdu_value_view(&copy, &info);
+	assert(info.info.data.payload == copy.apdu);
+	assert(knx_tpdu_size(&info) == sizeof(raw));
+
+	// Control TPDUs
+	const uint8_t ack = 0xC2 | 5 << 2;
+	assert(knx_tpdu_value_parse(&ack, 1, &value));
+	assert(value.tpci == KNX_TPCI_NUMBERED_CONTROL);
+	assert(value.seq_number == 5);
+	assert(value.code == KNX_TPCI_CONTROL_ACK);
+	assert(knx_tpdu_value_size(&value) == 1);
+
+	// Extended frames do not fit
+	uint8_t large[KNX_TPDU_INLINE_SIZE + 2] = {0x00, 0x80};
+	assert(!knx_tpdu_value_parse(large, sizeof(large), &value));
+	assert(knx_tpdu_value_parse(large, sizeof(large) - 1, &value));
+})
+
+deftest(knx_ldata_packed, {
+	const uint8_t apdu[] = {0x80, 0x0C, 0x1A};
+
+	knx_ldata ldata = {
+		.control1 = {KNX_LDATA_PRIO_URGENT, false, true, true, false},
+		.control2 = {KNX_LDATA_ADDR_GROUP, 5},
+		.source = knx_individual_addr(1, 1, 4),
+		.destination = knx_group_addr(2, 3, 4),
+		.tpdu = {
+			.tpci = KNX_TPCI_UNNUMBERED_DATA,
+			.info = {.data = {KNX_APCI_GROUPVALUERESPONSE, apdu, sizeof(apdu)}}
+		}
+	};
+
+	assert(sizeof(knx_ldata_packed) == 24);
+
+	knx_ldata_packed packed;
+	assert(knx_ldata_pack(&packed, &ldata));
+
+	assert(knx_ldata_packed_priority(&packed) == KNX_LDATA_PRIO_URGENT);
+	assert(!knx_ldata_packed_repeat(&packed));
+	assert(knx_ldata_packed_system_broadcast(&packed));
+	assert(knx_ldata_packed_request_ack(&packed));
+	assert(!knx_ldata_packed_error(&packed));
+	assert(knx_ldata_packed_address_type(&packed) == KNX_LDATA_ADDR_GROUP);
+	assert(knx_ldata_packed_hops(&packed) == 5);
+	assert(knx_ldata_packed_tpci(&packed) == KNX_TPCI_UNNUMBERED_DATA);
+	assert(knx_ldata_packed_apci(&packed) == KNX_APCI_GROUPVALUERESPONSE);
+	assert(knx_ldata_packed_apdu_length(&packed) == sizeof(apdu));
+	assert(knx_ldata_packed_apdu(&packed)[2] == 0x1A);
+
+	// Wire format matches the unpacked generator
+	uint8_t expected[KNX_LDATA_HEADER_SIZE + KNX_LDATA_PACKED_TPDU_SIZE];
+	uint8_t actual[KNX_LDATA_HEADER_SIZE + KNX_LDATA_PACKED_TPDU_SIZE];
+
+	assert(knx_ldata_generate(expected, &ldata));
+	assert(knx_ldata_packed_size(&packed) == knx_ldata_size(&ldata));
+
+	knx_ldata_packed_generate(actual, &packed);
+	assert(memcmp(actual, expected, knx_ldata_size(&ldata)) == 0);
+
+	// Parsing yields the same representation
+	knx_ldata_packed parsed;
+	assert(knx_ldata_packed_parse(expected, knx_ldata_size(&ldata), &parsed));
+	assert(memcmp(&parsed, &packed, offsetof(knx_ldata_packed, tpdu) + packed.tpdu_length) == 0);
+
+	// Round trip
+	knx_ldata unpacked;
+	assert(knx_ldata_unpack(&parsed, &unpacked));
+	assert(unpacked.control1.priority == ldata.control1.priority);
+	assert(unpacked.control1.repeat == ldata.control1.repeat);
+	assert(unpacked.control2.hops == ldata.control2.hops);
+	assert(unpacked.source == ldata.source);
+	assert(unpacked.destination == ldata.destination);
+	assert(unpacked.tpdu.info.data.apci == ldata.tpdu.info.data.apci);
+	assert(unpacked.tpdu.info.data.length == sizeof(apdu));
+	assert(unpacked.tpdu.info.data.payload == parsed.tpdu + 1);
+
+	// Extended frames cannot be packed
+	uint8_t large[KNX_LDATA_PACKED_TPDU_SIZE] = {0};
+	ldata.tpdu.info.data.payload = large;
+	ldata.tpdu.info.data.length = sizeof(large);
+
+	assert(!knx_ldata_pack(&packed, &ldata));
+
+	expected[6] = KNX_LDATA_PACKED_TPDU_SIZE;
+	assert(!knx_ldata_packed_parse(expected, sizeof(expected), &parsed));
+})
+
 deftest(cemi, {
+	runsubtest(knx_tpdu_value);
+	runsubtest(knx_ldata_packed);
+
 	uint8_t example_Data[4] = {11, 22, 33, 44};
 
 	knx_cemi req = {
@@ -22,6 +22,8 @@
 #include "testfw.h"
 
 #include "../src/proto/proto.h"
+#include "../src/proto/iov.h"
+#include "../src/proto/template.h"
 
 #include <stdbool.h>
 #include <string.h>
@@ -243,6 +245,217 @@ deftest(knx_tunnel_response, {
 	assert(packet_out.payload.tunnel_res.status == packet_in.status);
 })
 
+deftest(knx_device_configuration_request, {
+	// M_PropRead.req for PID_IP_ADDRESS of the KNXnet/IP parameter object
+	const uint8_t frame[] = {
+		0x06, 0x10, 0x03, 0x10, 0x00, 0x11,
+		0x04, 0x07, 0x02, 0x00,
+		KNX_CEMI_MPROPREAD_REQ, 0x00, 0x0B, 0x01, 0x34, 0x10, 0x01
+	};
+
+	// Parse
+	knx_packet packet_out;
+	assert(knx_parse(frame, sizeof(frame), &packet_out) == sizeof(frame));
+
+	// Check
+	const knx_device_configuration_request* req = &packet_out.payload.config_req;
+
+	assert(packet_out.service == KNX_DEVICE_CONFIGURATION_REQUEST);
+	assert(req->channel == 7);
+	assert(req->seq_number == 2);
+	assert(req->cemi == frame + 10);
+	assert(req->cemi_length == 7);
+	assert(req->cemi[0] == KNX_CEMI_MPROPREAD_REQ);
+
+	// Generate
+	uint8_t buffer[sizeof(frame)];
+	assert(knx_size(KNX_DEVICE_CONFIGURATION_REQUEST, req) == sizeof(frame));
+	assert(knx_generate(buffer, KNX_DEVICE_CONFIGURATION_REQUEST, req));
+	assert(memcmp(buffer, frame, sizeof(frame)) == 0);
+
+	// Missing message code
+	assert(knx_parse(frame, 10, &packet_out) < 0);
+})
+
+deftest(knx_routing_lost_message, {
+	knx_routing_lost_message packet_in = {1, 300};
+
+	// Generate
+	uint8_t buffer[KNX_HEADER_SIZE + KNX_ROUTING_LOST_MESSAGE_SIZE];
+	assert(knx_generate(buffer, KNX_ROUTING_LOST_MESSAGE, &packet_in));
+
+	// Parse
+	knx_packet packet_out;
+	assert(knx_parse(buffer, sizeof(buffer), &packet_out) == sizeof(buffer));
+
+	// Check
+	assert(packet_out.service == KNX_ROUTING_LOST_MESSAGE);
+	assert(packet_out.payload.routing_lost.device_state == packet_in.device_state);
+	assert(packet_out.payload.routing_lost.lost_messages == packet_in.lost_messages);
+})
+
+deftest(knx_routing_busy, {
+	knx_routing_busy packet_in = {1, 100, 0};
+
+	// Generate
+	uint8_t buffer[KNX_HEADER_SIZE + KNX_ROUTING_BUSY_SIZE];
+	assert(knx_generate(buffer, KNX_ROUTING_BUSY, &packet_in));
+
+	// Parse
+	knx_packet packet_out;
+	assert(knx_parse(buffer, sizeof(buffer), &packet_out) == sizeof(buffer));
+
+	// Check
+	assert(packet_out.service == KNX_ROUTING_BUSY);
+	assert(packet_out.payload.routing_busy.device_state == packet_in.device_state);
+	assert(packet_out.payload.routing_busy.wait_time == packet_in.wait_time);
+	assert(packet_out.payload.routing_busy.control == packet_in.control);
+
+	// Structure length must match
+	buffer[KNX_HEADER_SIZE] = 4;
+	assert(knx_parse(buffer, sizeof(buffer), &packet_out) == -KNX_INVALID_PAYLOAD);
+})
+
+deftest(knx_generate_bounded, {
+	knx_routing_indication packet_in = {
+		{
+			KNX_CEMI_LDATA_IND,
+			0,
+			NULL,
+			{
+				.ldata = example_ldata
+			}
+		}
+	};
+
+	size_t frame_length = knx_size(KNX_ROUTING_INDICATION, &packet_in);
+
+	// Too small, the guard byte must remain untouched
+	uint8_t buffer[frame_length + 1];
+	buffer[frame_length - 1] = 0xAA;
+
+	assert(knx_generate_bounded(buffer, frame_length - 1, KNX_ROUTING_INDICATION, &packet_in) ==
+	       -KNX_INVALID_BUFFER);
+	assert(buffer[frame_length - 1] == 0xAA);
+
+	// Large enough
+	assert(knx_generate_bounded(buffer, sizeof(buffer), KNX_ROUTING_INDICATION, &packet_in) ==
+	       (ssize_t) frame_length);
+
+	knx_packet packet_out;
+	assert(knx_parse(buffer, frame_length, &packet_out) == (ssize_t) frame_length);
+	assert(packet_out.payload.routing_ind.data.payload.ldata.destination == example_ldata.destination);
+
+	// Fixed-size services
+	knx_tunnel_response res = {1, 2, 0};
+	assert(knx_generate_bounded(buffer, KNX_HEADER_SIZE + 3, KNX_TUNNEL_RESPONSE, &res) ==
+	       -KNX_INVALID_BUFFER);
+	assert(knx_generate_bounded(buffer, sizeof(buffer), KNX_TUNNEL_RESPONSE, &res) ==
+	       KNX_HEADER_SIZE + KNX_TUNNEL_RESPONSE_SIZE);
+})
+
+deftest(knx_generate_iov, {
+	const uint8_t add_info[3] = {1, 2, 3};
+
+	knx_tunnel_request packet_in = {
+		100,
+		7,
+		{
+			KNX_CEMI_LDATA_REQ,
+			sizeof(add_info),
+			add_info,
+			{
+				.ldata = example_ldata
+			}
+		}
+	};
+
+	// Reference
+	uint8_t buffer[KNX_HEADER_SIZE + knx_tunnel_request_size(&packet_in)];
+	assert(knx_generate(buffer, KNX_TUNNEL_REQUEST, &packet_in));
+
+	// Scatter
+	knx_frame_iov frame;
+	assert(knx_generate_iov(&frame, KNX_TUNNEL_REQUEST, &packet_in) == KNX_IOV_MAX);
+
+	// Bulk data must be referenced, not copied
+	assert(frame.iov[1].iov_base == add_info);
+	assert(frame.iov[3].iov_base == example_ldata_payload + 1);
+
+	// Gather
+	uint8_t gathered[sizeof(buffer)];
+	size_t offset = 0;
+
+	for (size_t i = 0; i < frame.iov_count; i++) {
+		assert(offset + frame.iov[i].iov_len <= sizeof(gathered));
+		memcpy(gathered + offset, frame.iov[i].iov_base, frame.iov[i].iov_len);
+		offset += frame.iov[i].iov_len;
+	}
+
+	assert(offset == sizeof(buffer));
+	assert(memcmp(gathered, buffer, sizeof(buffer)) == 0);
+
+	// Device configuration requests reference their CEMI frame, even if it exceeds the scratch area
+	uint8_t prop_write[KNX_IOV_SCRATCH_SIZE + 8] = {KNX_CEMI_MPROPWRITE_REQ, 0x00, 0x0B, 0x01, 0x4B};
+	knx_device_configuration_request config_req = {3, 4, prop_write, sizeof(prop_write)};
+
+	uint8_t config_buffer[KNX_HEADER_SIZE + knx_device_configuration_request_size(&config_req)];
+	assert(knx_generate(config_buffer, KNX_DEVICE_CONFIGURATION_REQUEST, &config_req));
+	assert(knx_generate_iov(&frame, KNX_DEVICE_CONFIGURATION_REQUEST, &config_req) == 2);
+
+	assert(frame.iov[0].iov_len == KNX_HEADER_SIZE + 4);
+	assert(memcmp(frame.iov[0].iov_base, config_buffer, KNX_HEADER_SIZE + 4) == 0);
+	assert(frame.iov[1].iov_base == prop_write);
+	assert(frame.iov[1].iov_len == sizeof(prop_write));
+
+	// Small services live in the scratch area
+	knx_tunnel_response res = {1, 2, 0};
+	assert(knx_generate_iov(&frame, KNX_TUNNEL_RESPONSE, &res) == 1);
+	assert(frame.iov[0].iov_len == KNX_HEADER_SIZE + KNX_TUNNEL_RESPONSE_SIZE);
+})
+
+deftest(knx_frame_template, {
+	const uint8_t initial_value[KNX_DPT_FLOAT16_SIZE] = {0, 0, 0};
+
+	knx_tunnel_request packet_in = {
+		100,
+		0,
+		{
+			KNX_CEMI_LDATA_REQ,
+			0,
+			NULL,
+			{
+				.ldata = example_ldata
+			}
+		}
+	};
+
+	packet_in.data.payload.ldata.tpdu.info.data.payload = initial_value;
+	packet_in.data.payload.ldata.tpdu.info.data.length = sizeof(initial_value);
+
+	knx_frame_template tmpl;
+	assert(knx_frame_template_init(&tmpl, KNX_TUNNEL_REQUEST, &packet_in));
+	assert(tmpl.length == knx_size(KNX_TUNNEL_REQUEST, &packet_in));
+
+	// Patch
+	knx_float16 value = 21.5;
+	knx_frame_template_set_seq(&tmpl, 77);
+	assert(knx_frame_template_set_value(&tmpl, KNX_DPT_FLOAT16, &value));
+	assert(!knx_frame_template_set_value(&tmpl, KNX_DPT_BOOL, &value));
+
+	// Must be equivalent to a fully generated frame
+	uint8_t apdu[KNX_DPT_FLOAT16_SIZE] = {0, 0, 0};
+	knx_dpt_to_apdu(apdu, KNX_DPT_FLOAT16, &value);
+
+	packet_in.seq_number = 77;
+	packet_in.data.payload.ldata.tpdu.info.data.payload = apdu;
+
+	uint8_t buffer[KNX_HEADER_SIZE + knx_tunnel_request_size(&packet_in)];
+	assert(knx_generate(buffer, KNX_TUNNEL_REQUEST, &packet_in));
+	assert(sizeof(buffer) == tmpl.length);
+	assert(memcmp(buffer, tmpl.frame, tmpl.length) == 0);
+})
+
 // deftest(knx_routing_indication, {
 // 	assert(true);
 // })
@@ -265,6 +478,157 @@ deftest(knx_description_request, {
 	assert(host_info_equal(&packet_out.payload.description_req.control_host, &packet_in.control_host));
 })
 
+deftest(knx_description_response, {
+	knx_description_service services[2] = {{3, 1}, {4, 2}};
+
+	knx_description_response packet_in = {
+		.medium = 2,
+		.status = 1,
+		.address = knx_individual_addr(1, 1, 5),
+		.id = 77,
+		.serial = {1, 2, 3, 4, 5, 6},
+		.multicast_address = htonl(0xE000170C),
+		.mac_address = {6, 5, 4, 3, 2, 1},
+		.name = "Test Gateway",
+		.num_services = 2,
+		.services = services
+	};
+
+	// Generate
+	uint8_t buffer[KNX_HEADER_SIZE + knx_description_response_size(&packet_in)];
+	assert(knx_generate(buffer, KNX_DESCRIPTION_RESPONSE, &packet_in));
+
+	// Parse
+	knx_packet packet_out;
+	assert(knx_parse(buffer, sizeof(buffer), &packet_out) > KNX_HEADER_SIZE);
+
+	// Check
+	assert(packet_out.service == KNX_DESCRIPTION_RESPONSE);
+	assert(packet_out.payload.description_res.address == packet_in.address);
+	assert(packet_out.payload.description_res.id == packet_in.id);
+	assert(packet_out.payload.description_res.multicast_address == packet_in.multicast_address);
+	assert(strcmp(packet_out.payload.description_res.name, packet_in.name) == 0);
+	assert(packet_out.payload.description_res.num_services == 2);
+	assert(packet_out.payload.description_res.services[1].family == 4);
+	assert(packet_out.payload.description_res.services[1].version == 2);
+
+	knx_description_response_free_services(&packet_out.payload.description_res);
+})
+
+deftest(knx_description_view, {
+	const uint8_t services[] = {2, 1, 4, 2};
+
+	knx_description_view view_in = {
+		.medium = 2,
+		.address = knx_individual_addr(1, 1, 5),
+		.name = "Test Gateway",
+		.services = services,
+		.num_services = 2
+	};
+
+	uint8_t buffer[knx_description_view_size(&view_in)];
+	assert(knx_description_view_generate(buffer, &view_in));
+
+	// Matches the allocating generator
+	knx_description_service array[2] = {{2, 1}, {4, 2}};
+	knx_description_response res = {
+		.medium = 2,
+		.address = knx_individual_addr(1, 1, 5),
+		.name = "Test Gateway",
+		.num_services = 2,
+		.services = array
+	};
+
+	uint8_t expected[knx_description_response_size(&res)];
+	assert(sizeof(expected) == sizeof(buffer));
+	assert(knx_description_response_generate(expected, &res));
+	assert(memcmp(buffer, expected, sizeof(buffer)) == 0);
+
+	// Services refer to the buffer
+	knx_description_view view_out;
+	assert(knx_description_view_parse(buffer, sizeof(buffer), &view_out));
+	assert(view_out.address == view_in.address);
+	assert(strcmp(view_out.name, "Test Gateway") == 0);
+	assert(view_out.services == buffer + 56);
+
+	knx_description_service_iter iter;
+	knx_description_service service;
+	size_t count = 0;
+
+	knx_description_service_iter_init(&iter, &view_out);
+
+	while (knx_description_service_iter_next(&iter, &service)) {
+		assert(service.family == array[count].family);
+		assert(service.version == array[count].version);
+		count++;
+	}
+
+	assert(count == 2);
+
+	// Truncated service families are rejected
+	assert(!knx_description_view_parse(buffer, sizeof(buffer) - 1, &view_out));
+	assert(!knx_description_response_parse(buffer, sizeof(buffer) - 1, &res));
+})
+
+static
+bool example_vendor_parse(const uint8_t* message, size_t length, void* payload) {
+	if (length < 1)
+		return false;
+
+	*(uint8_t*) payload = message[0];
+	return true;
+}
+
+static
+bool example_vendor_generate(uint8_t* buffer, const void* payload) {
+	buffer[0] = *(const uint8_t*) payload;
+	return true;
+}
+
+deftest(knx_register_service, {
+	const knx_service vendor_service = 0x0F01;
+	const knx_service_codec codec = {example_vendor_parse, example_vendor_generate, NULL, 1, NULL};
+
+	assert(knx_find_service(vendor_service) == NULL);
+	assert(knx_register_service(vendor_service, &codec));
+	assert(knx_find_service(vendor_service) != NULL);
+
+	uint8_t packet_in = 123;
+
+	// Generate
+	uint8_t buffer[KNX_HEADER_SIZE + 1];
+	assert(knx_size(vendor_service, &packet_in) == sizeof(buffer));
+	assert(knx_generate(buffer, vendor_service, &packet_in));
+
+	// Parse
+	knx_packet packet_out;
+	assert(knx_parse(buffer, sizeof(buffer), &packet_out) == sizeof(buffer));
+	assert(packet_out.service == vendor_service);
+	assert(*(uint8_t*) &packet_out.payload == packet_in);
+
+	// Leave the registry as it was
+	assert(knx_unregister_service(vendor_service));
+	assert(knx_find_service(vendor_service) == NULL);
+	assert(!knx_unregister_service(vendor_service));
+
+	// Codecs which cannot determine the payload size or generate the payload are rejected
+	const knx_service_codec no_size = {example_vendor_parse, example_vendor_generate, NULL, 0, NULL};
+	const knx_service_codec no_generate = {example_vendor_parse, NULL, NULL, 1, NULL};
+
+	assert(!knx_register_service(vendor_service, &no_size));
+	assert(!knx_register_service(vendor_service, &no_generate));
+	assert(!knx_register_service(KNX_TUNNEL_RESPONSE, &no_size));
+	assert(knx_find_service(vendor_service) == NULL);
+
+	// Built-in codecs are restored from a copy
+	const knx_service_codec builtin = *knx_find_service(KNX_TUNNEL_RESPONSE);
+
+	assert(knx_register_service(KNX_TUNNEL_RESPONSE, &codec));
+	assert(!knx_unregister_service(KNX_TUNNEL_RESPONSE));
+	assert(knx_register_service(KNX_TUNNEL_RESPONSE, &builtin));
+	assert(knx_find_service(KNX_TUNNEL_RESPONSE)->parse == builtin.parse);
+})
+
 deftest(knxnetip, {
 	runsubtest(knx_connection_request);
 	runsubtest(knx_connection_response);
@@ -274,6 +638,15 @@ deftest(knxnetip, {
 	runsubtest(knx_connection_state_response);
 	runsubtest(knx_tunnel_request);
 	runsubtest(knx_tunnel_response);
+	runsubtest(knx_device_configuration_request);
+	runsubtest(knx_generate_bounded);
+	runsubtest(knx_generate_iov);
+	runsubtest(knx_frame_template);
 	// runsubtest(knx_routing_indication);
+	runsubtest(knx_routing_lost_message);
+	runsubtest(knx_routing_busy);
 	runsubtest(knx_description_request);
+	runsubtest(knx_description_response);
+	runsubtest(knx_description_view);
+	runsubtest(knx_register_service);
 })
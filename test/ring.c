@@ -0,0 +1,248 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "testfw.h"
+
+#include "../src/util/ring.h"
+#include "../src/net/pipeline.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+
+static
+void ring_test_ldata(knx_ldata* ldata, knx_addr source, knx_addr destination, const uint8_t* apdu,
+                     size_t length) {
+	memset(ldata, 0, sizeof(knx_ldata));
+
+	ldata->control1.priority = KNX_LDATA_PRIO_LOW;
+	ldata->control2.address_type = KNX_LDATA_ADDR_GROUP;
+	ldata->source = source;
+	ldata->destination = destination;
+	ldata->tpdu.tpci = KNX_TPCI_UNNUMBERED_DATA;
+	ldata->tpdu.info.data.apci = KNX_APCI_GROUPVALUEWRITE;
+	ldata->tpdu.info.data.payload = apdu;
+	ldata->tpdu.info.data.length = length;
+}
+
+typedef struct {
+	size_t count;
+	knx_addr destinations[16];
+	bool apdu_inline;
+	size_t next[2];
+	bool ordered;
+} ring_test_state;
+
+static
+void ring_test_handler(void* data, const knx_event* event) {
+	ring_test_state* state = data;
+
+	if (state->count < 16)
+		state->destinations[state->count] = event->ldata.destination;
+
+	state->apdu_inline &= event->ldata.tpdu.info.data.payload == event->apdu;
+	state->count++;
+}
+
+deftest(knx_spsc_ring, {
+	knx_spsc_ring ring;
+	assert(knx_spsc_ring_init(&ring, 3));
+	assert(ring.index.mask == 3);
+
+	uint8_t apdu[KNX_EVENT_APDU_SIZE + 1] = {0x81, 1};
+	knx_ldata ldata;
+
+	// Fill the ring
+	for (knx_addr i = 0; i < 4; i++) {
+		ring_test_ldata(&ldata, 1, i, apdu, 2);
+		assert(knx_spsc_ring_publish(&ring, KNX_CEMI_LDATA_IND, &ldata));
+	}
+
+	assert(!knx_spsc_ring_publish(&ring, KNX_CEMI_LDATA_IND, &ldata));
+
+	ring_test_state state = {0, {0}, true, {0}, true};
+	assert(knx_spsc_ring_drain(&ring, ring_test_handler, &state, 3) == 3);
+	assert(state.apdu_inline);
+
+	// Wrap around
+	for (knx_addr i = 4; i < 7; i++) {
+		ring_test_ldata(&ldata, 1, i, apdu, 2);
+		assert(knx_spsc_ring_publish(&ring, KNX_CEMI_LDATA_IND, &ldata));
+	}
+
+	assert(knx_spsc_ring_drain(&ring, ring_test_handler, &state, 16) == 4);
+	assert(knx_spsc_ring_drain(&ring, ring_test_handler, &state, 16) == 0);
+
+	for (size_t i = 0; i < 7; i++)
+		assert(state.destinations[i] == i);
+
+	// APCI bits are cleared from the inline APDU
+	knx_event* event = knx_spsc_ring_reserve(&ring);
+	assert(event != NULL);
+	assert(knx_event_set(event, KNX_CEMI_LDATA_IND, &ldata));
+	assert(event->apdu[0] == 1);
+	assert(event->apdu[1] == 1);
+
+	// Oversized APDU
+	ring_test_ldata(&ldata, 1, 0, apdu, sizeof(apdu));
+	assert(!knx_spsc_ring_publish(&ring, KNX_CEMI_LDATA_IND, &ldata));
+
+	knx_spsc_ring_destroy(&ring);
+})
+
+#define RING_TEST_EVENTS 20000
+
+typedef struct {
+	knx_mpsc_ring* ring;
+	knx_addr producer;
+} ring_test_producer;
+
+static
+void* ring_test_produce(void* data) {
+	ring_test_producer* producer = data;
+	uint8_t apdu[2] = {0x80, 0};
+	knx_ldata ldata;
+
+	for (knx_addr i = 0; i < RING_TEST_EVENTS; i++) {
+		ring_test_ldata(&ldata, producer->producer, i, apdu, sizeof(apdu));
+
+		while (!knx_mpsc_ring_publish(producer->ring, KNX_CEMI_LDATA_IND, &ldata))
+			sched_yield();
+	}
+
+	return NULL;
+}
+
+static
+void ring_test_check_order(void* data, const knx_event* event) {
+	ring_test_state* state = data;
+
+	// Events of a producer arrive in the order they were published
+	if (event->ldata.destination != state->next[event->ldata.source])
+		state->ordered = false;
+
+	state->next[event->ldata.source]++;
+	state->count++;
+}
+
+deftest(knx_mpsc_ring, {
+	knx_mpsc_ring ring;
+	assert(knx_mpsc_ring_init(&ring, 64));
+
+	ring_test_producer producers[2] = {{&ring, 0}, {&ring, 1}};
+	pthread_t threads[2];
+
+	for (size_t i = 0; i < 2; i++)
+		assert(pthread_create(&threads[i], NULL, ring_test_produce, &producers[i]) == 0);
+
+	ring_test_state state = {0, {0}, true, {0, 0}, true};
+
+	while (state.count < 2 * RING_TEST_EVENTS) {
+		if (knx_mpsc_ring_drain(&ring, ring_test_check_order, &state, 32) == 0)
+			sched_yield();
+	}
+
+	for (size_t i = 0; i < 2; i++)
+		pthread_join(threads[i], NULL);
+
+	assert(state.ordered);
+	assert(state.next[0] == RING_TEST_EVENTS);
+	assert(state.next[1] == RING_TEST_EVENTS);
+	assert(knx_mpsc_ring_drain(&ring, ring_test_check_order, &state, 32) == 0);
+
+	knx_mpsc_ring_destroy(&ring);
+})
+
+#define PIPELINE_TEST_DESTINATIONS 64
+#define PIPELINE_TEST_ROUNDS 50
+
+typedef struct {
+	uint8_t next[PIPELINE_TEST_DESTINATIONS];
+	size_t workers[PIPELINE_TEST_DESTINATIONS];
+	bool ordered;
+	size_t count;
+} pipeline_test_state;
+
+static
+bool pipeline_test_resolve(void* data, knx_addr destination, knx_dpt* type) {
+	*type = KNX_DPT_UNSIGNED8;
+	return true;
+}
+
+// Each destination is served by exactly one worker, so its entries are not shared
+static
+void pipeline_test_handler(void* data, const knx_pipeline_event* event) {
+	pipeline_test_state* state = data;
+	knx_addr destination = event->cemi->payload.ldata.destination;
+
+	if (!event->has_value || event->value.unsigned8 != state->next[destination])
+		state->ordered = false;
+
+	state->next[destination]++;
+	state->workers[destination] = event->worker;
+
+	__atomic_add_fetch(&state->count, 1, __ATOMIC_RELAXED);
+}
+
+deftest(knx_pipeline, {
+	pipeline_test_state state;
+	memset(&state, 0, sizeof(state));
+	state.ordered = true;
+
+	knx_pipeline pipeline;
+	assert(!knx_pipeline_start(&pipeline, 0, 16, pipeline_test_handler, NULL, &state));
+	assert(knx_pipeline_start(&pipeline, 4, 16, pipeline_test_handler, pipeline_test_resolve,
+	                          &state));
+
+	knx_routing_indication ind = {{KNX_CEMI_LDATA_IND, 0, NULL, {.ldata = {.source = 0}}}};
+	uint8_t apdu[KNX_DPT_UNSIGNED8_SIZE];
+	uint8_t frame[64];
+
+	for (uint8_t round = 0; round < PIPELINE_TEST_ROUNDS; round++) {
+		for (knx_addr destination = 0; destination < PIPELINE_TEST_DESTINATIONS; destination++) {
+			knx_dpt_to_apdu(apdu, KNX_DPT_UNSIGNED8, &round);
+			ring_test_ldata(&ind.data.payload.ldata, 1, destination, apdu, sizeof(apdu));
+			assert(knx_generate(frame, KNX_ROUTING_INDICATION, &ind));
+
+			while (!knx_pipeline_push(&pipeline, frame, knx_size(KNX_ROUTING_INDICATION, &ind)))
+				sched_yield();
+		}
+	}
+
+	// Frames without L_Data are rejected
+	knx_tunnel_response res = {1, 0, 0};
+	assert(knx_generate(frame, KNX_TUNNEL_RESPONSE, &res));
+	assert(!knx_pipeline_push(&pipeline, frame, KNX_HEADER_SIZE + KNX_TUNNEL_RESPONSE_SIZE));
+
+	knx_pipeline_stop(&pipeline);
+
+	assert(state.count == PIPELINE_TEST_DESTINATIONS * PIPELINE_TEST_ROUNDS);
+	assert(state.ordered);
+
+	for (knx_addr destination = 0; destination < PIPELINE_TEST_DESTINATIONS; destination++)
+		assert(state.workers[destination] == knx_addr_bucket(destination, 4));
+})
+
+deftest(ring, {
+	runsubtest(knx_spsc_ring);
+	runsubtest(knx_mpsc_ring);
+	runsubtest(knx_pipeline);
+})
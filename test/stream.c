@@ -0,0 +1,107 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "testfw.h"
+
+#include "../src/proto/stream.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#define EXAMPLE_FRAME_SIZE (KNX_HEADER_SIZE + KNX_TUNNEL_RESPONSE_SIZE)
+
+static
+void example_stream_frame(uint8_t* buffer, uint8_t seq_number) {
+	knx_tunnel_response res = {1, seq_number, 0};
+	knx_generate(buffer, KNX_TUNNEL_RESPONSE, &res);
+}
+
+deftest(knx_stream_chunks, {
+	knx_stream stream;
+	assert(knx_stream_init(&stream, 0));
+
+	uint8_t data[EXAMPLE_FRAME_SIZE * 3];
+	for (size_t i = 0; i < 3; i++)
+		example_stream_frame(data + i * EXAMPLE_FRAME_SIZE, i);
+
+	const uint8_t* frame;
+
+	// Feed the frames in odd-sized chunks
+	assert(knx_stream_push(&stream, data, 7) == 7);
+	assert(knx_stream_next(&stream, &frame) == 0);
+
+	assert(knx_stream_push(&stream, data + 7, 17) == 17);
+	assert(knx_stream_next(&stream, &frame) == EXAMPLE_FRAME_SIZE);
+	assert(memcmp(frame, data, EXAMPLE_FRAME_SIZE) == 0);
+	assert(knx_stream_next(&stream, &frame) == EXAMPLE_FRAME_SIZE);
+	assert(memcmp(frame, data + EXAMPLE_FRAME_SIZE, EXAMPLE_FRAME_SIZE) == 0);
+	assert(knx_stream_next(&stream, &frame) == 0);
+
+	assert(knx_stream_push(&stream, data + 24, sizeof(data) - 24) == sizeof(data) - 24);
+	assert(knx_stream_next(&stream, &frame) == EXAMPLE_FRAME_SIZE);
+	assert(memcmp(frame, data + 2 * EXAMPLE_FRAME_SIZE, EXAMPLE_FRAME_SIZE) == 0);
+	assert(knx_stream_pending(&stream) == 0);
+
+	knx_stream_destroy(&stream);
+})
+
+deftest(knx_stream_wrap_around, {
+	knx_stream stream;
+	assert(knx_stream_init(&stream, 0));
+
+	uint8_t frame_data[EXAMPLE_FRAME_SIZE];
+	const uint8_t* frame;
+
+	// Fill the ring up to the last few bytes
+	size_t num_frames = stream.capacity / EXAMPLE_FRAME_SIZE;
+	for (size_t i = 0; i < num_frames; i++) {
+		example_stream_frame(frame_data, i);
+		assert(knx_stream_push(&stream, frame_data, EXAMPLE_FRAME_SIZE) == EXAMPLE_FRAME_SIZE);
+	}
+
+	// Consume all but one frame, these are contiguous
+	for (size_t i = 0; i < num_frames - 1; i++) {
+		assert(knx_stream_next(&stream, &frame) == EXAMPLE_FRAME_SIZE);
+		assert(frame == stream.buffer + i * EXAMPLE_FRAME_SIZE);
+		assert(frame[8] == (uint8_t) i);
+	}
+
+	// This frame crosses the end of the ring
+	example_stream_frame(frame_data, 123);
+	assert(knx_stream_push(&stream, frame_data, EXAMPLE_FRAME_SIZE) == EXAMPLE_FRAME_SIZE);
+	assert(knx_stream_next(&stream, &frame) == EXAMPLE_FRAME_SIZE);
+	assert(frame != stream.scratch);
+	assert(knx_stream_next(&stream, &frame) == EXAMPLE_FRAME_SIZE);
+	assert(frame == stream.scratch);
+	assert(memcmp(frame, frame_data, EXAMPLE_FRAME_SIZE) == 0);
+
+	// Malformed header
+	memset(frame_data, 0, sizeof(frame_data));
+	assert(knx_stream_push(&stream, frame_data, EXAMPLE_FRAME_SIZE) == EXAMPLE_FRAME_SIZE);
+	assert(knx_stream_next(&stream, &frame) == -KNX_INVALID_HEADER);
+
+	knx_stream_destroy(&stream);
+})
+
+deftest(stream, {
+	runsubtest(knx_stream_chunks);
+	runsubtest(knx_stream_wrap_around);
+})
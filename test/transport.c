@@ -0,0 +1,411 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "testfw.h"
+
+#include "../src/net/transport.h"
+#include "../src/net/uring.h"
+#include "../src/net/rxpool.h"
+
+#include <arpa/inet.h>
+#include <poll.h>
+#include <pthread.h>
+#include <string.h>
+
+static
+void transport_wait(knx_transport* transport) {
+	struct pollfd fd = {transport->sock, POLLIN, 0};
+	poll(&fd, 1, 1000);
+}
+
+typedef struct {
+	size_t count;
+	uint8_t seq_number[4];
+} transport_test_state;
+
+static
+void transport_test_handler(
+	void*                     data,
+	const struct sockaddr_in* sender,
+	const uint8_t*            frame,
+	size_t                    length,
+	const knx_packet*         packet
+) {
+	transport_test_state* state = data;
+	(void) sender;
+	(void) frame;
+	(void) length;
+
+	if (packet && packet->service == KNX_TUNNEL_RESPONSE && state->count < 4)
+		state->seq_number[state->count++] = packet->payload.tunnel_res.seq_number;
+}
+
+deftest(knx_transport_loopback, {
+	struct sockaddr_in local = {
+		.sin_family = AF_INET,
+		.sin_addr = {htonl(INADDR_LOOPBACK)},
+		.sin_port = 0
+	};
+
+	knx_transport a, b;
+	assert(knx_transport_init(&a, &local));
+	assert(knx_transport_init(&b, &local));
+
+	struct sockaddr_in target;
+	assert(knx_transport_local_address(&b, &target));
+
+	// Generated frames
+	for (uint8_t i = 0; i < 3; i++) {
+		knx_tunnel_response res = {1, i, 0};
+		assert(knx_transport_queue(&a, &target, KNX_TUNNEL_RESPONSE, &res));
+	}
+
+	// Preformatted frame
+	uint8_t frame[KNX_HEADER_SIZE + KNX_TUNNEL_RESPONSE_SIZE];
+	knx_tunnel_response res = {1, 42, 0};
+	assert(knx_generate(frame, KNX_TUNNEL_RESPONSE, &res));
+	assert(knx_transport_queue_raw(&a, &target, frame, sizeof(frame)));
+
+	assert(a.tx_count == 4);
+	assert(knx_transport_flush(&a) == 4);
+	assert(a.tx_count == 0);
+
+	transport_test_state state = {0, {0}};
+	while (state.count < 4) {
+		transport_wait(&b);
+		assert(knx_transport_dispatch(&b, transport_test_handler, &state) > 0);
+	}
+
+	assert(state.seq_number[0] == 0);
+	assert(state.seq_number[1] == 1);
+	assert(state.seq_number[2] == 2);
+	assert(state.seq_number[3] == 42);
+
+	// Nothing left
+	assert(knx_transport_poll(&b) == 0);
+
+	knx_transport_destroy(&a);
+	knx_transport_destroy(&b);
+})
+
+deftest(knx_transport_drop, {
+	struct sockaddr_in local = {
+		.sin_family = AF_INET,
+		.sin_addr = {htonl(INADDR_LOOPBACK)},
+		.sin_port = 0
+	};
+
+	knx_transport a, b;
+	assert(knx_transport_init(&a, &local));
+	assert(knx_transport_init(&b, &local));
+
+	struct sockaddr_in target;
+	assert(knx_transport_local_address(&b, &target));
+
+	// Exceeds the maximum UDP datagram size, the kernel rejects it with EMSGSIZE
+	static uint8_t oversized[70000];
+	assert(knx_transport_queue_raw(&a, &target, oversized, sizeof(oversized)));
+
+	knx_tunnel_response res = {1, 7, 0};
+	assert(knx_transport_queue(&a, &target, KNX_TUNNEL_RESPONSE, &res));
+
+	// The oversized frame is dropped instead of blocking the queue
+	assert(knx_transport_flush(&a) == -1);
+	assert(a.tx_dropped == 1);
+	assert(a.tx_count == 1);
+
+	assert(knx_transport_flush(&a) == 1);
+	assert(a.tx_count == 0);
+
+	transport_test_state state = {0, {0}};
+	while (state.count < 1) {
+		transport_wait(&b);
+		assert(knx_transport_dispatch(&b, transport_test_handler, &state) > 0);
+	}
+
+	assert(state.seq_number[0] == 7);
+
+	// A full queue whose head fails permanently still accepts new frames
+	for (size_t i = 0; i < KNX_TRANSPORT_BATCH; i++)
+		assert(knx_transport_queue_raw(&a, &target, oversized, sizeof(oversized)));
+
+	assert(knx_transport_queue(&a, &target, KNX_TUNNEL_RESPONSE, &res));
+	assert(a.tx_dropped == 2);
+	assert(a.tx_count == KNX_TRANSPORT_BATCH);
+
+	// Datagrams exceeding a receive slot are dropped instead of being handed out truncated
+	knx_transport c;
+	assert(knx_transport_init(&c, &local));
+
+	static uint8_t large[KNX_TRANSPORT_FRAME_SIZE + 64];
+	assert(knx_generate(large, KNX_TUNNEL_RESPONSE, &res));
+	assert(knx_transport_queue_raw(&c, &target, large, sizeof(large)));
+
+	res.seq_number = 8;
+	assert(knx_transport_queue(&c, &target, KNX_TUNNEL_RESPONSE, &res));
+	assert(knx_transport_flush(&c) == 2);
+
+	state.count = 0;
+	while (state.count < 1) {
+		transport_wait(&b);
+		assert(knx_transport_dispatch(&b, transport_test_handler, &state) >= 0);
+	}
+
+	assert(state.seq_number[0] == 8);
+	assert(b.rx_truncated == 1);
+
+	knx_transport_destroy(&c);
+
+	knx_transport_destroy(&a);
+	knx_transport_destroy(&b);
+})
+
+deftest(knx_uring_loopback, {
+	struct sockaddr_in local = {
+		.sin_family = AF_INET,
+		.sin_addr = {htonl(INADDR_LOOPBACK)},
+		.sin_port = 0
+	};
+
+	knx_uring uring;
+	assert(knx_uring_init(&uring, &local));
+
+	struct sockaddr_in target;
+	assert(knx_uring_local_address(&uring, &target));
+
+	// Send to ourselves
+	for (uint8_t i = 0; i < 3; i++) {
+		knx_tunnel_response res = {1, i, 0};
+		assert(knx_uring_queue(&uring, &target, KNX_TUNNEL_RESPONSE, &res));
+	}
+
+	assert(uring.tx_count == 3);
+	assert(knx_uring_submit(&uring) == 4);
+
+	transport_test_state state = {0, {0}};
+	for (size_t i = 0; i < 10 && state.count < 3; i++)
+		assert(knx_uring_dispatch(&uring, transport_test_handler, &state, 1000) >= 0);
+
+	assert(state.count == 3);
+	assert(state.seq_number[0] == 0);
+	assert(state.seq_number[1] == 1);
+	assert(state.seq_number[2] == 2);
+
+	// All sends have completed
+	assert(knx_uring_poll(&uring, 0) == 0);
+	assert(uring.tx_count == 0);
+	assert(uring.tx_dropped == 0);
+	assert(uring.rx_truncated == 0);
+
+	// Failed sends are counted
+	struct sockaddr_in invalid = target;
+	invalid.sin_port = 0;
+
+	knx_tunnel_response res = {1, 3, 0};
+	assert(knx_uring_queue(&uring, &invalid, KNX_TUNNEL_RESPONSE, &res));
+	assert(knx_uring_submit(&uring) == 1);
+
+	for (size_t i = 0; i < 10 && uring.tx_count > 0; i++)
+		assert(knx_uring_poll(&uring, 1000) >= 0);
+
+	assert(uring.tx_count == 0);
+	assert(uring.tx_dropped == 1);
+
+	// Datagrams exceeding a receive buffer are dropped and counted
+	knx_transport sender;
+	assert(knx_transport_init(&sender, &local));
+
+	static uint8_t large[KNX_TRANSPORT_FRAME_SIZE + 64];
+	assert(knx_generate(large, KNX_TUNNEL_RESPONSE, &res));
+	assert(knx_transport_queue_raw(&sender, &target, large, sizeof(large)));
+
+	res.seq_number = 4;
+	assert(knx_transport_queue(&sender, &target, KNX_TUNNEL_RESPONSE, &res));
+	assert(knx_transport_flush(&sender) == 2);
+
+	state.count = 0;
+	for (size_t i = 0; i < 10 && state.count < 1; i++)
+		assert(knx_uring_dispatch(&uring, transport_test_handler, &state, 1000) >= 0);
+
+	assert(state.count == 1);
+	assert(state.seq_number[0] == 4);
+	assert(uring.rx_truncated == 1);
+
+	knx_transport_destroy(&sender);
+	knx_uring_destroy(&uring);
+})
+
+typedef struct {
+	knx_rx_packet packets[4];
+	size_t        count;
+	bool          valid;
+} rx_pool_test_consumer;
+
+// Packets are inspected and released on another thread
+static
+void* rx_pool_test_consume(void* data) {
+	rx_pool_test_consumer* consumer = data;
+
+	for (size_t i = 0; i < consumer->count; i++) {
+		knx_rx_packet* rx_packet = &consumer->packets[i];
+		const knx_ldata* ldata = &rx_packet->packet.payload.tunnel_req.data.payload.ldata;
+
+		consumer->valid &=
+			ldata->destination == knx_group_addr(1, 0, i) &&
+			ldata->tpdu.info.data.payload > rx_packet->buffer->data &&
+			ldata->tpdu.info.data.payload < rx_packet->buffer->data + rx_packet->buffer->length;
+
+		knx_rx_packet_release(rx_packet);
+	}
+
+	return NULL;
+}
+
+deftest(knx_rx_pool, {
+	struct sockaddr_in local = {
+		.sin_family = AF_INET,
+		.sin_addr = {htonl(INADDR_LOOPBACK)},
+		.sin_port = 0
+	};
+
+	knx_transport a, b;
+	assert(knx_transport_init(&a, &local));
+	assert(knx_transport_init(&b, &local));
+
+	struct sockaddr_in target;
+	assert(knx_transport_local_address(&b, &target));
+
+	const uint8_t apdu[] = {0x80, 0x01};
+
+	for (uint8_t i = 0; i < 6; i++) {
+		knx_tunnel_request req = {
+			1,
+			i,
+			{
+				KNX_CEMI_LDATA_IND,
+				0,
+				NULL,
+				{
+					.ldata = {
+						.control1 = {KNX_LDATA_PRIO_LOW, true, true, false, false},
+						.control2 = {KNX_LDATA_ADDR_GROUP, 6},
+						.source = knx_individual_addr(1, 1, 1),
+						.destination = knx_group_addr(1, 0, i),
+						.tpdu = {
+							.tpci = KNX_TPCI_UNNUMBERED_DATA,
+							.info = {.data = {KNX_APCI_GROUPVALUEWRITE, apdu, sizeof(apdu)}}
+						}
+					}
+				}
+			}
+		};
+
+		assert(knx_transport_queue(&a, &target, KNX_TUNNEL_REQUEST, &req));
+	}
+
+	assert(knx_transport_flush(&a) == 6);
+
+	knx_rx_pool pool;
+	assert(knx_rx_pool_init(&pool, 4));
+
+	// The pool limits the batch
+	knx_rx_buffer* buffers[KNX_TRANSPORT_BATCH];
+	rx_pool_test_consumer consumer = {.count = 0, .valid = true};
+
+	while (consumer.count < 4) {
+		transport_wait(&b);
+
+		ssize_t count = knx_rx_pool_receive(&pool, &b, buffers, KNX_TRANSPORT_BATCH);
+		assert(count > 0);
+
+		for (ssize_t i = 0; i < count; i++) {
+			assert(knx_rx_packet_parse(&consumer.packets[consumer.count++], buffers[i]));
+			assert(buffers[i]->refs == 2);
+			assert(buffers[i]->sender.sin_port != 0);
+
+			knx_rx_buffer_release(buffers[i]);
+		}
+	}
+
+	assert(consumer.count == 4);
+	assert(knx_rx_pool_receive(&pool, &b, buffers, KNX_TRANSPORT_BATCH) == 0);
+
+	// Packets outlive the receive call
+	pthread_t thread;
+	assert(pthread_create(&thread, NULL, rx_pool_test_consume, &consumer) == 0);
+	pthread_join(thread, NULL);
+
+	assert(consumer.valid);
+
+	// Released buffers are recycled for the remaining datagrams
+	size_t remaining = 0;
+
+	while (remaining < 2) {
+		transport_wait(&b);
+
+		ssize_t count = knx_rx_pool_receive(&pool, &b, buffers, KNX_TRANSPORT_BATCH);
+		assert(count > 0);
+
+		for (ssize_t i = 0; i < count; i++, remaining++)
+			knx_rx_buffer_release(buffers[i]);
+	}
+
+	assert(remaining == 2);
+
+	// Datagrams exceeding a buffer are dropped and their buffers are recycled
+	static uint8_t large[KNX_TRANSPORT_FRAME_SIZE + 64];
+	knx_tunnel_response res = {1, 9, 0};
+
+	assert(knx_generate(large, KNX_TUNNEL_RESPONSE, &res));
+	assert(knx_transport_queue_raw(&a, &target, large, sizeof(large)));
+	assert(knx_transport_queue(&a, &target, KNX_TUNNEL_RESPONSE, &res));
+	assert(knx_transport_flush(&a) == 2);
+
+	remaining = 0;
+
+	while (remaining < 1) {
+		transport_wait(&b);
+
+		ssize_t count = knx_rx_pool_receive(&pool, &b, buffers, KNX_TRANSPORT_BATCH);
+		assert(count >= 0);
+
+		for (ssize_t i = 0; i < count; i++, remaining++) {
+			assert(buffers[i]->length == KNX_HEADER_SIZE + KNX_TUNNEL_RESPONSE_SIZE);
+			knx_rx_buffer_release(buffers[i]);
+		}
+	}
+
+	assert(b.rx_truncated == 1);
+
+	for (size_t i = 0; i < 4; i++)
+		assert(knx_rx_pool_acquire(&pool) != NULL);
+
+	knx_rx_pool_destroy(&pool);
+	knx_transport_destroy(&a);
+	knx_transport_destroy(&b);
+})
+
+deftest(transport, {
+	runsubtest(knx_transport_loopback);
+	runsubtest(knx_transport_drop);
+	runsubtest(knx_uring_loopback);
+	runsubtest(knx_rx_pool);
+})
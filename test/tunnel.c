@@ -0,0 +1,849 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "testfw.h"
+
+#include "../src/net/tunnel.h"
+#include "../src/net/pool.h"
+#include "../src/net/routing.h"
+#include "../src/net/reactor.h"
+#include "../src/net/gateway.h"
+#include "../src/util/timerwheel.h"
+
+#include <arpa/inet.h>
+#include <poll.h>
+#include <string.h>
+
+static
+void timer_test_count(knx_timer* timer, void* data) {
+	(void) timer;
+	(*(size_t*) data)++;
+}
+
+deftest(knx_timer_wheel, {
+	knx_timer_wheel wheel;
+	knx_timer_wheel_init(&wheel, 1000, 10);
+
+	size_t fired_a = 0, fired_b = 0, fired_c = 0;
+	knx_timer a, b, c;
+	knx_timer_init(&a, timer_test_count, &fired_a);
+	knx_timer_init(&b, timer_test_count, &fired_b);
+	knx_timer_init(&c, timer_test_count, &fired_c);
+
+	assert(knx_timer_wheel_timeout(&wheel) == -1);
+
+	knx_timer_schedule(&wheel, &a, 25);
+	knx_timer_schedule(&wheel, &b, 50);
+
+	// Longer than one revolution of the wheel
+	knx_timer_schedule(&wheel, &c, KNX_TIMER_WHEEL_SLOTS * 10 + 30);
+
+	assert(knx_timer_armed(&a));
+	assert(knx_timer_wheel_timeout(&wheel) == 30);
+
+	// Timers fire on the first tick after their deadline
+	assert(knx_timer_wheel_advance(&wheel, 1025) == 0);
+	assert(knx_timer_wheel_advance(&wheel, 1030) == 1);
+	assert(fired_a == 1 && !knx_timer_armed(&a));
+
+	knx_timer_cancel(&b);
+	assert(!knx_timer_armed(&b));
+
+	assert(knx_timer_wheel_advance(&wheel, 1100) == 0);
+	assert(fired_c == 0);
+
+	// Jumping far ahead still fires everything that is due
+	assert(knx_timer_wheel_advance(&wheel, 1000000) == 1);
+	assert(fired_c == 1);
+	assert(fired_b == 0);
+	assert(knx_timer_wheel_timeout(&wheel) == -1);
+})
+
+typedef struct {
+	knx_tunnel_state state;
+	size_t received;
+} tunnel_test_state;
+
+static
+void tunnel_test_state_changed(void* data, knx_tunnel_client* client, knx_tunnel_state state) {
+	(void) client;
+	((tunnel_test_state*) data)->state = state;
+}
+
+static
+void tunnel_test_received(void* data, knx_tunnel_client* client, const knx_cemi* cemi) {
+	(void) client;
+	(void) cemi;
+	((tunnel_test_state*) data)->received++;
+}
+
+static uint8_t tunnel_test_apdu[] = {0x80};
+
+static
+void tunnel_test_routed(void* data, knx_routing_engine* engine, const knx_cemi* cemi) {
+	(void) engine;
+
+	if (cemi->service == KNX_CEMI_LDATA_IND)
+		(*(size_t*) data)++;
+}
+
+static
+void tunnel_test_cemi(knx_cemi* cemi, knx_addr destination) {
+	*cemi = (knx_cemi) {
+		KNX_CEMI_LDATA_REQ,
+		0,
+		NULL,
+		{
+			.ldata = {
+				.control1 = {KNX_LDATA_PRIO_LOW, true, true, false, false},
+				.control2 = {KNX_LDATA_ADDR_GROUP, 7},
+				.source = 0,
+				.destination = destination,
+				.tpdu = {
+					.tpci = KNX_TPCI_UNNUMBERED_DATA,
+					.info = {
+						.data = {
+							.apci = KNX_APCI_GROUPVALUEWRITE,
+							.payload = tunnel_test_apdu,
+							.length = sizeof(tunnel_test_apdu)
+						}
+					}
+				}
+			}
+		}
+	};
+}
+
+// Flush the client transport and receive the next packet on the gateway side
+static
+bool tunnel_test_exchange(knx_transport* client, knx_transport* gateway, knx_packet* packet) {
+	if (knx_transport_flush(client) < 0 || client->tx_count != 0)
+		return false;
+
+	struct pollfd fd = {gateway->sock, POLLIN, 0};
+	if (poll(&fd, 1, 1000) != 1)
+		return false;
+
+	// Receive a single datagram so each one can be checked in order
+	ssize_t count = recv(gateway->sock, gateway->rx_buffers[0], KNX_TRANSPORT_FRAME_SIZE, 0);
+	return count > 0 && knx_parse(gateway->rx_buffers[0], count, packet) > 0;
+}
+
+deftest(knx_tunnel_client, {
+	struct sockaddr_in local = {
+		.sin_family = AF_INET,
+		.sin_addr = {htonl(INADDR_LOOPBACK)},
+		.sin_port = 0
+	};
+
+	knx_transport transport, gateway;
+	assert(knx_transport_init(&transport, &local));
+	assert(knx_transport_init(&gateway, &local));
+
+	struct sockaddr_in gateway_address;
+	assert(knx_transport_local_address(&gateway, &gateway_address));
+
+	knx_timer_wheel wheel;
+	knx_timer_wheel_init(&wheel, 0, 10);
+
+	tunnel_test_state state = {KNX_TUNNEL_DISCONNECTED, 0};
+	knx_tunnel_handlers handlers = {tunnel_test_state_changed, tunnel_test_received};
+
+	knx_tunnel_client client;
+	knx_tunnel_client_init(&client, &transport, &wheel, &gateway_address, &handlers, &state);
+	client.reconnect_delay = 5000;
+
+	knx_packet packet;
+
+	// Connect
+	assert(knx_tunnel_client_connect(&client));
+	assert(state.state == KNX_TUNNEL_CONNECTING);
+	assert(tunnel_test_exchange(&transport, &gateway, &packet));
+	assert(packet.service == KNX_CONNECTION_REQUEST);
+
+	packet.service = KNX_CONNECTION_RESPONSE;
+	packet.payload.conn_res = (knx_connection_response) {
+		7, 0, KNX_HOST_INFO_NAT(KNX_PROTO_UDP), {4, 0x11, 0x01}
+	};
+	assert(knx_tunnel_client_handle(&client, &packet));
+	assert(state.state == KNX_TUNNEL_CONNECTED);
+	assert(client.channel == 7);
+
+	// Outgoing frames, the second one waits for the first to be acknowledged
+	knx_cemi cemi;
+	tunnel_test_cemi(&cemi, knx_group_addr(1, 2, 3));
+
+	assert(knx_tunnel_client_send(&client, &cemi));
+	assert(knx_tunnel_client_send(&client, &cemi));
+	assert(client.queue_count == 2);
+
+	assert(tunnel_test_exchange(&transport, &gateway, &packet));
+	assert(packet.service == KNX_TUNNEL_REQUEST);
+	assert(packet.payload.tunnel_req.channel == 7);
+	assert(packet.payload.tunnel_req.seq_number == 0);
+
+	// Missing acknowledgement causes a repetition
+	knx_timer_wheel_advance(&wheel, KNX_TUNNEL_ACK_TIMEOUT);
+	assert(tunnel_test_exchange(&transport, &gateway, &packet));
+	assert(packet.service == KNX_TUNNEL_REQUEST);
+	assert(packet.payload.tunnel_req.seq_number == 0);
+
+	packet.service = KNX_TUNNEL_RESPONSE;
+	packet.payload.tunnel_res = (knx_tunnel_response) {7, 0, 0};
+	assert(knx_tunnel_client_handle(&client, &packet));
+	assert(client.queue_count == 1);
+
+	assert(tunnel_test_exchange(&transport, &gateway, &packet));
+	assert(packet.service == KNX_TUNNEL_REQUEST);
+	assert(packet.payload.tunnel_req.seq_number == 1);
+
+	// Incoming frames are acknowledged, duplicates are not delivered twice
+	knx_packet incoming = {KNX_TUNNEL_REQUEST, .payload.tunnel_req = {7, 0, cemi}};
+	assert(knx_tunnel_client_handle(&client, &incoming));
+	assert(knx_tunnel_client_handle(&client, &incoming));
+	assert(state.received == 1);
+
+	for (size_t i = 0; i < 2; i++) {
+		assert(tunnel_test_exchange(&transport, &gateway, &packet));
+		assert(packet.service == KNX_TUNNEL_RESPONSE);
+		assert(packet.payload.tunnel_res.seq_number == 0);
+	}
+
+	// Foreign channel
+	incoming.payload.tunnel_req.channel = 8;
+	assert(!knx_tunnel_client_handle(&client, &incoming));
+
+	// Second transmission fails as well, the connection is given up
+	knx_timer_wheel_advance(&wheel, 2 * KNX_TUNNEL_ACK_TIMEOUT);
+	assert(tunnel_test_exchange(&transport, &gateway, &packet));
+	assert(packet.payload.tunnel_req.seq_number == 1);
+
+	knx_timer_wheel_advance(&wheel, 3 * KNX_TUNNEL_ACK_TIMEOUT);
+	assert(tunnel_test_exchange(&transport, &gateway, &packet));
+	assert(packet.service == KNX_DISCONNECT_REQUEST);
+	assert(state.state == KNX_TUNNEL_DISCONNECTED);
+	assert(client.queue_count == 1);
+
+	// Reconnect
+	knx_timer_wheel_advance(&wheel, 3 * KNX_TUNNEL_ACK_TIMEOUT + client.reconnect_delay);
+	assert(state.state == KNX_TUNNEL_CONNECTING);
+	assert(tunnel_test_exchange(&transport, &gateway, &packet));
+	assert(packet.service == KNX_CONNECTION_REQUEST);
+
+	knx_tunnel_client_disconnect(&client);
+	assert(state.state == KNX_TUNNEL_DISCONNECTED);
+
+	knx_tunnel_client_destroy(&client);
+	knx_transport_destroy(&transport);
+	knx_transport_destroy(&gateway);
+})
+
+deftest(knx_tunnel_pool, {
+	struct sockaddr_in local = {
+		.sin_family = AF_INET,
+		.sin_addr = {htonl(INADDR_LOOPBACK)},
+		.sin_port = 0
+	};
+
+	knx_transport transport, gateway;
+	assert(knx_transport_init(&transport, &local));
+	assert(knx_transport_init(&gateway, &local));
+
+	struct sockaddr_in gateway_address;
+	assert(knx_transport_local_address(&gateway, &gateway_address));
+
+	knx_timer_wheel wheel;
+	knx_timer_wheel_init(&wheel, 0, 10);
+
+	knx_tunnel_handlers handlers = {NULL, NULL};
+
+	knx_tunnel_pool pool;
+	assert(!knx_tunnel_pool_init(&pool, 0, &transport, &wheel, &gateway_address, &handlers, NULL));
+	assert(knx_tunnel_pool_init(&pool, 2, &transport, &wheel, &gateway_address, &handlers, NULL));
+
+	knx_packet packet;
+
+	// Connections are established one after another
+	knx_tunnel_pool_connect(&pool);
+
+	for (uint8_t channel = 1; channel <= 2; channel++) {
+		assert(tunnel_test_exchange(&transport, &gateway, &packet));
+		assert(packet.service == KNX_CONNECTION_REQUEST);
+		assert(transport.tx_count == 0);
+
+		packet.service = KNX_CONNECTION_RESPONSE;
+		packet.payload.conn_res = (knx_connection_response) {
+			channel, 0, KNX_HOST_INFO_NAT(KNX_PROTO_UDP), {4, 0x11, channel}
+		};
+		assert(knx_tunnel_pool_handle(&pool, &packet));
+		knx_timer_wheel_advance(&wheel, wheel.now + wheel.resolution);
+	}
+
+	assert(knx_tunnel_pool_connected(&pool) == 2);
+
+	// Find two destinations served by different connections
+	knx_addr first = knx_group_addr(1, 0, 0), second = first + 1;
+	while (knx_tunnel_pool_select(&pool, first) == knx_tunnel_pool_select(&pool, second))
+		second++;
+
+	// Both are transmitted without waiting for an acknowledgement
+	knx_cemi cemi;
+	tunnel_test_cemi(&cemi, first);
+	assert(knx_tunnel_pool_send(&pool, &cemi));
+	assert(knx_tunnel_pool_send(&pool, &cemi));
+	tunnel_test_cemi(&cemi, second);
+	assert(knx_tunnel_pool_send(&pool, &cemi));
+
+	assert(transport.tx_count == 2);
+	assert(knx_tunnel_pool_select(&pool, first)->queue_count == 2);
+
+	uint8_t channels = 0;
+	for (size_t i = 0; i < 2; i++) {
+		assert(tunnel_test_exchange(&transport, &gateway, &packet));
+		assert(packet.service == KNX_TUNNEL_REQUEST);
+		assert(packet.payload.tunnel_req.seq_number == 0);
+		channels |= packet.payload.tunnel_req.channel;
+	}
+
+	assert(channels == 3);
+
+	knx_tunnel_pool_disconnect(&pool);
+	knx_tunnel_pool_destroy(&pool);
+	knx_transport_destroy(&transport);
+	knx_transport_destroy(&gateway);
+})
+
+// Answer a connection request of a pooled client
+static
+bool tunnel_test_pool_accept(knx_tunnel_pool* pool, uint8_t channel, uint8_t status) {
+	knx_packet packet = {
+		KNX_CONNECTION_RESPONSE,
+		.payload.conn_res = {channel, status, KNX_HOST_INFO_NAT(KNX_PROTO_UDP), {4, 0x11, channel}}
+	};
+
+	return knx_tunnel_pool_handle(pool, &packet);
+}
+
+// Acknowledge a tunnel request and expect the next one
+static
+bool tunnel_test_pool_ack(knx_tunnel_pool* pool, uint8_t channel, uint8_t seq_number) {
+	knx_packet packet = {KNX_TUNNEL_RESPONSE, .payload.tunnel_res = {channel, seq_number, 0}};
+	return knx_tunnel_pool_handle(pool, &packet);
+}
+
+deftest(knx_tunnel_pool_routes, {
+	struct sockaddr_in local = {
+		.sin_family = AF_INET,
+		.sin_addr = {htonl(INADDR_LOOPBACK)},
+		.sin_port = 0
+	};
+
+	knx_transport transport, gateway;
+	assert(knx_transport_init(&transport, &local));
+	assert(knx_transport_init(&gateway, &local));
+
+	struct sockaddr_in gateway_address;
+	assert(knx_transport_local_address(&gateway, &gateway_address));
+
+	knx_timer_wheel wheel;
+	knx_timer_wheel_init(&wheel, 0, 10);
+
+	knx_tunnel_handlers handlers = {NULL, NULL};
+
+	knx_tunnel_pool pool;
+	assert(knx_tunnel_pool_init(&pool, 2, &transport, &wheel, &gateway_address, &handlers, NULL));
+
+	// Retry before the pending tunnel request times out
+	pool.reconnect_delay = KNX_TUNNEL_ACK_TIMEOUT / 2;
+
+	// A destination which is served by the second connection once both are established
+	knx_addr moved = knx_group_addr(1, 0, 0);
+	while (knx_addr_bucket(moved, 2) != 1)
+		moved++;
+
+	knx_cemi cemi;
+	tunnel_test_cemi(&cemi, moved);
+
+	// Nothing is queued without an established connection
+	assert(!knx_tunnel_pool_send(&pool, &cemi));
+	assert(knx_tunnel_pool_select(&pool, moved) == NULL);
+
+	knx_packet packet;
+	knx_tunnel_pool_connect(&pool);
+
+	assert(tunnel_test_exchange(&transport, &gateway, &packet));
+	assert(packet.service == KNX_CONNECTION_REQUEST);
+	assert(tunnel_test_pool_accept(&pool, 1, 0));
+
+	// The gateway has no slot for the second connection, every destination uses the first one
+	knx_timer_wheel_advance(&wheel, wheel.now + wheel.resolution);
+	assert(tunnel_test_exchange(&transport, &gateway, &packet));
+	assert(packet.service == KNX_CONNECTION_REQUEST);
+	assert(tunnel_test_pool_accept(&pool, 0, 0x24));
+	assert(knx_tunnel_pool_connected(&pool) == 1);
+
+	assert(knx_tunnel_pool_send(&pool, &cemi));
+	assert(knx_tunnel_pool_send(&pool, &cemi));
+	assert(pool.clients[0].queue_count == 2);
+
+	assert(tunnel_test_exchange(&transport, &gateway, &packet));
+	assert(packet.service == KNX_TUNNEL_REQUEST);
+	assert(packet.payload.tunnel_req.channel == 1);
+
+	// A slot becomes available on the next attempt
+	knx_timer_wheel_advance(&wheel, wheel.now + pool.reconnect_delay + wheel.resolution);
+	assert(tunnel_test_exchange(&transport, &gateway, &packet));
+	assert(packet.service == KNX_CONNECTION_REQUEST);
+	assert(tunnel_test_pool_accept(&pool, 2, 0));
+	assert(knx_tunnel_pool_connected(&pool) == 2);
+
+	// The destination stays with the first connection until its queue has drained
+	assert(knx_tunnel_pool_select(&pool, moved) == &pool.clients[0]);
+	assert(knx_tunnel_pool_send(&pool, &cemi));
+	assert(pool.clients[0].queue_count == 3);
+
+	for (uint8_t seq_number = 0; seq_number < 3; seq_number++) {
+		assert(tunnel_test_pool_ack(&pool, 1, seq_number));
+
+		if (seq_number < 2) {
+			assert(tunnel_test_exchange(&transport, &gateway, &packet));
+			assert(packet.payload.tunnel_req.channel == 1);
+			assert(packet.payload.tunnel_req.seq_number == seq_number + 1);
+		}
+	}
+
+	assert(pool.clients[0].queue_count == 0);
+
+	// Afterwards it moves to the second connection
+	assert(knx_tunnel_pool_select(&pool, moved) == &pool.clients[1]);
+	assert(knx_tunnel_pool_send(&pool, &cemi));
+
+	assert(tunnel_test_exchange(&transport, &gateway, &packet));
+	assert(packet.service == KNX_TUNNEL_REQUEST);
+	assert(packet.payload.tunnel_req.channel == 2);
+
+	knx_tunnel_pool_disconnect(&pool);
+	knx_tunnel_pool_destroy(&pool);
+	knx_transport_destroy(&transport);
+	knx_transport_destroy(&gateway);
+})
+
+deftest(knx_routing_engine, {
+	struct sockaddr_in local = {
+		.sin_family = AF_INET,
+		.sin_addr = {htonl(INADDR_LOOPBACK)},
+		.sin_port = 0
+	};
+
+	knx_transport transport;
+	assert(knx_transport_init(&transport, &local));
+
+	knx_timer_wheel wheel;
+	knx_timer_wheel_init(&wheel, 0, 1);
+
+	knx_routing_engine engine;
+	knx_routing_engine_init(&engine, &transport, &wheel, &local, NULL, NULL);
+
+	knx_cemi cemi;
+	tunnel_test_cemi(&cemi, knx_group_addr(1, 2, 3));
+
+	// Only a burst leaves immediately, the remainder is paced
+	for (size_t i = 0; i < KNX_ROUTING_BURST + 5; i++)
+		assert(knx_routing_engine_send(&engine, &cemi));
+
+	assert(transport.tx_count == KNX_ROUTING_BURST);
+	assert(engine.queue_count == 5);
+
+	knx_timer_wheel_advance(&wheel, 1000 / KNX_ROUTING_RATE);
+	assert(transport.tx_count == KNX_ROUTING_BURST + 1);
+
+	// Busy routers pause the output for the wait time plus a random back-off
+	knx_packet busy = {KNX_ROUTING_BUSY, .payload.routing_busy = {0, 100, 0}};
+	assert(knx_routing_engine_handle(&engine, &busy));
+	assert(knx_routing_engine_paused(&engine));
+	assert(engine.busy_count == 1);
+
+	knx_timer_wheel_advance(&wheel, 1000 / KNX_ROUTING_RATE + 99);
+	assert(transport.tx_count == KNX_ROUTING_BURST + 1);
+
+	knx_timer_wheel_advance(&wheel, 1000 / KNX_ROUTING_RATE + 150);
+	assert(!knx_routing_engine_paused(&engine));
+	assert(transport.tx_count > KNX_ROUTING_BURST + 1);
+
+	// Lost messages are accumulated
+	knx_packet lost = {KNX_ROUTING_LOST_MESSAGE, .payload.routing_lost = {0, 3}};
+	assert(knx_routing_engine_handle(&engine, &lost));
+	assert(engine.lost_messages == 3);
+
+	knx_routing_engine_destroy(&engine);
+	knx_transport_destroy(&transport);
+})
+
+deftest(knx_reactor, {
+	struct sockaddr_in local = {
+		.sin_family = AF_INET,
+		.sin_addr = {htonl(INADDR_LOOPBACK)},
+		.sin_port = 0
+	};
+
+	knx_transport gateway;
+	assert(knx_transport_init(&gateway, &local));
+
+	struct sockaddr_in gateway_address;
+	assert(knx_transport_local_address(&gateway, &gateway_address));
+
+	knx_reactor reactor;
+	assert(knx_reactor_init(&reactor));
+
+	tunnel_test_state state = {KNX_TUNNEL_DISCONNECTED, 0};
+	knx_tunnel_handlers handlers = {tunnel_test_state_changed, tunnel_test_received};
+
+	knx_reactor_session sessions[2];
+	for (size_t i = 0; i < 2; i++)
+		assert(knx_reactor_add_tunnel(&reactor, &sessions[i], &gateway_address, &handlers, &state));
+
+	assert(reactor.num_sessions == 2);
+
+	// Connection requests are flushed at the end of an iteration
+	assert(knx_reactor_run_once(&reactor, 0) == 0);
+
+	struct pollfd fd = {gateway.sock, POLLIN, 0};
+	size_t requests = 0;
+
+	while (requests < 2 && poll(&fd, 1, 1000) == 1) {
+		ssize_t count = knx_transport_poll(&gateway);
+		assert(count > 0);
+
+		for (ssize_t i = 0; i < count; i++) {
+			knx_packet packet;
+			assert(knx_parse(gateway.rx_datagrams[i].frame, gateway.rx_datagrams[i].length, &packet) > 0);
+			assert(packet.service == KNX_CONNECTION_REQUEST);
+
+			knx_connection_response res = {
+				requests + 1, 0, KNX_HOST_INFO_NAT(KNX_PROTO_UDP), {4, 0x11, 0x01}
+			};
+			assert(knx_transport_queue(&gateway, &gateway.rx_senders[i], KNX_CONNECTION_RESPONSE, &res));
+			requests++;
+		}
+	}
+
+	assert(requests == 2);
+	assert(knx_transport_flush(&gateway) == 2);
+
+	// Both responses are drained from their sockets
+	for (size_t i = 0; i < 10; i++) {
+		if (sessions[0].link.tunnel.state == KNX_TUNNEL_CONNECTED &&
+		    sessions[1].link.tunnel.state == KNX_TUNNEL_CONNECTED)
+			break;
+
+		assert(knx_reactor_run_once(&reactor, 100) >= 0);
+	}
+
+	assert(sessions[0].link.tunnel.state == KNX_TUNNEL_CONNECTED);
+	assert(sessions[1].link.tunnel.state == KNX_TUNNEL_CONNECTED);
+	assert(sessions[0].link.tunnel.channel != sessions[1].link.tunnel.channel);
+
+	// Routing sessions deliver incoming indications to their handler
+	knx_reactor_session routing;
+	size_t indications = 0;
+
+	assert(knx_reactor_add_routing(
+		&reactor,
+		&routing,
+		&local,
+		htonl(INADDR_LOOPBACK),
+		tunnel_test_routed,
+		&indications
+	));
+	assert(routing.routing);
+	assert(reactor.num_sessions == 3);
+
+	struct sockaddr_in routing_address;
+	assert(knx_transport_local_address(&routing.transport, &routing_address));
+
+	knx_routing_indication ind;
+	tunnel_test_cemi(&ind.data, knx_group_addr(1, 2, 3));
+	ind.data.service = KNX_CEMI_LDATA_IND;
+
+	assert(knx_transport_queue(&gateway, &routing_address, KNX_ROUTING_INDICATION, &ind));
+	assert(knx_transport_flush(&gateway) == 1);
+
+	for (size_t i = 0; i < 10 && indications == 0; i++)
+		assert(knx_reactor_run_once(&reactor, 100) >= 0);
+
+	assert(indications == 1);
+
+	// A full read which contained a dropped datagram does not stop the socket from being drained
+	static uint8_t oversized[KNX_TRANSPORT_FRAME_SIZE + 64];
+	assert(knx_generate(oversized, KNX_ROUTING_INDICATION, &ind));
+	assert(knx_transport_queue_raw(&gateway, &routing_address, oversized, sizeof(oversized)));
+
+	for (size_t i = 0; i < KNX_TRANSPORT_BATCH; i++) {
+		assert(knx_transport_queue(&gateway, &routing_address, KNX_ROUTING_INDICATION, &ind));
+
+		if (gateway.tx_count == KNX_TRANSPORT_BATCH)
+			assert(knx_transport_flush(&gateway) == KNX_TRANSPORT_BATCH);
+	}
+
+	assert(knx_transport_flush(&gateway) == 1);
+
+	indications = 0;
+	assert(knx_reactor_run_once(&reactor, 1000) == 1);
+	assert(indications == KNX_TRANSPORT_BATCH);
+	assert(routing.transport.rx_truncated == 1);
+
+	knx_reactor_remove(&reactor, &routing);
+	assert(reactor.num_sessions == 2);
+
+	// Removal sends a disconnect request
+	knx_reactor_destroy(&reactor);
+	assert(reactor.num_sessions == 0);
+
+	for (size_t i = 0; i < 2 && poll(&fd, 1, 1000) == 1; ) {
+		ssize_t count = knx_transport_poll(&gateway);
+
+		for (ssize_t j = 0; j < count; j++, i++) {
+			knx_packet packet;
+			assert(knx_parse(gateway.rx_datagrams[j].frame, gateway.rx_datagrams[j].length, &packet) > 0);
+			assert(packet.service == KNX_DISCONNECT_REQUEST);
+		}
+	}
+
+	knx_transport_destroy(&gateway);
+})
+
+typedef struct {
+	knx_tunnel_state state;
+	size_t indications;
+	size_t confirmations;
+	knx_addr destinations[16];
+} gateway_test_state;
+
+static
+void gateway_test_state_changed(void* data, knx_tunnel_client* client, knx_tunnel_state state) {
+	(void) client;
+	((gateway_test_state*) data)->state = state;
+}
+
+static
+void gateway_test_received(void* data, knx_tunnel_client* client, const knx_cemi* cemi) {
+	gateway_test_state* state = data;
+	(void) client;
+
+	if (cemi->service == KNX_CEMI_LDATA_CON) {
+		state->confirmations++;
+	} else if (cemi->service == KNX_CEMI_LDATA_IND) {
+		if (state->indications < 16)
+			state->destinations[state->indications] = cemi->payload.ldata.destination;
+
+		state->indications++;
+	}
+}
+
+static
+void gateway_test_dispatch(
+	void*                     data,
+	const struct sockaddr_in* sender,
+	const uint8_t*            frame,
+	size_t                    length,
+	const knx_packet*         packet
+) {
+	(void) sender;
+	(void) frame;
+	(void) length;
+
+	if (packet)
+		knx_tunnel_client_handle(data, packet);
+}
+
+// Exchange packets between client and simulator until both sides are idle
+static
+void gateway_test_pump(
+	knx_transport*     client_transport,
+	knx_tunnel_client* client,
+	knx_transport*     sim_transport,
+	knx_gateway_sim*   sim
+) {
+	struct pollfd fds[2] = {
+		{client_transport->sock, POLLIN, 0},
+		{sim_transport->sock, POLLIN, 0}
+	};
+
+	for (size_t i = 0; i < 1000; i++) {
+		knx_transport_flush(client_transport);
+		knx_transport_flush(sim_transport);
+
+		if (poll(fds, 2, 20) <= 0)
+			break;
+
+		knx_transport_dispatch(sim_transport, knx_gateway_sim_dispatch, sim);
+		knx_transport_dispatch(client_transport, gateway_test_dispatch, client);
+	}
+}
+
+deftest(knx_gateway_sim, {
+	struct sockaddr_in local = {
+		.sin_family = AF_INET,
+		.sin_addr = {htonl(INADDR_LOOPBACK)},
+		.sin_port = 0
+	};
+
+	knx_transport sim_transport, client_transport;
+	assert(knx_transport_init(&sim_transport, &local));
+	assert(knx_transport_init(&client_transport, &local));
+
+	struct sockaddr_in gateway_address;
+	assert(knx_transport_local_address(&sim_transport, &gateway_address));
+
+	knx_timer_wheel wheel;
+	knx_timer_wheel_init(&wheel, 0, 10);
+
+	knx_gateway_sim sim;
+	knx_gateway_sim_init(&sim, &sim_transport, &wheel, NULL, NULL);
+
+	gateway_test_state state = {KNX_TUNNEL_DISCONNECTED, 0, 0, {0}};
+	knx_tunnel_handlers handlers = {gateway_test_state_changed, gateway_test_received};
+
+	knx_tunnel_client client;
+	knx_tunnel_client_init(&client, &client_transport, &wheel, &gateway_address, &handlers, &state);
+
+	// Connection is assigned the first channel
+	assert(knx_tunnel_client_connect(&client));
+	gateway_test_pump(&client_transport, &client, &sim_transport, &sim);
+
+	assert(state.state == KNX_TUNNEL_CONNECTED);
+	assert(client.channel == 1);
+	assert(knx_gateway_sim_connections(&sim) == 1);
+	assert(sim.channels[0].address == sim.address);
+
+	// Description requests are answered without a connection
+	struct sockaddr_in client_address;
+	assert(knx_transport_local_address(&client_transport, &client_address));
+
+	knx_packet description = {
+		KNX_DESCRIPTION_REQUEST,
+		{.description_req = {KNX_HOST_INFO_NAT(KNX_PROTO_UDP)}}
+	};
+
+	assert(knx_gateway_sim_handle(&sim, &client_address, &description));
+	assert(knx_transport_flush(&sim_transport) == 1);
+
+	struct pollfd fd = {client_transport.sock, POLLIN, 0};
+	assert(poll(&fd, 1, 1000) == 1);
+	assert(knx_transport_poll(&client_transport) == 1);
+
+	knx_description_view view;
+	assert(knx_description_view_parse(
+		client_transport.rx_datagrams[0].frame + KNX_HEADER_SIZE,
+		client_transport.rx_datagrams[0].length - KNX_HEADER_SIZE,
+		&view
+	));
+	assert(view.address == sim.address);
+	assert(view.num_services == 3);
+
+	// L_Data.req is acknowledged and confirmed
+	knx_cemi cemi;
+	tunnel_test_cemi(&cemi, knx_group_addr(1, 2, 3));
+
+	assert(knx_tunnel_client_send(&client, &cemi));
+	gateway_test_pump(&client_transport, &client, &sim_transport, &sim);
+
+	assert(sim.stats.received == 1);
+	assert(client.queue_count == 0);
+	assert(state.confirmations == 1);
+
+	// 1000 frames per second yield 10 frames within 10ms
+	knx_gateway_sim_traffic traffic = {
+		1000,
+		KNX_GATEWAY_SIM_SEQUENTIAL,
+		knx_group_addr(1, 0, 0),
+		4,
+		knx_individual_addr(1, 1, 1)
+	};
+
+	assert(knx_gateway_sim_set_traffic(&sim, &traffic));
+
+	knx_timer_wheel_advance(&wheel, 10);
+	gateway_test_pump(&client_transport, &client, &sim_transport, &sim);
+
+	assert(state.indications == 10);
+	assert(sim.stats.injected == 10);
+	assert(sim.stats.acknowledged == 11);
+
+	for (size_t i = 0; i < 10; i++)
+		assert(state.destinations[i] == knx_group_addr(1, 0, i % 4));
+
+	// Connections beyond the channel limit are refused
+	knx_packet packet = {
+		KNX_CONNECTION_REQUEST,
+		{
+			.conn_req = {
+				KNX_CONNECTION_REQUEST_TUNNEL,
+				KNX_CONNECTION_LAYER_TUNNEL,
+				KNX_HOST_INFO_NAT(KNX_PROTO_UDP),
+				KNX_HOST_INFO_NAT(KNX_PROTO_UDP)
+			}
+		}
+	};
+
+	for (size_t i = 1; i < KNX_GATEWAY_SIM_CHANNELS + 1; i++)
+		assert(knx_gateway_sim_handle(&sim, &gateway_address, &packet));
+
+	assert(knx_gateway_sim_connections(&sim) == KNX_GATEWAY_SIM_CHANNELS);
+	assert(sim.stats.rejected == 1);
+
+	packet.service = KNX_DISCONNECT_REQUEST;
+	packet.payload.dc_req = (knx_disconnect_request) {0, 0, KNX_HOST_INFO_NAT(KNX_PROTO_UDP)};
+
+	for (size_t i = 2; i <= KNX_GATEWAY_SIM_CHANNELS; i++) {
+		packet.payload.dc_req.channel = i;
+		assert(knx_gateway_sim_handle(&sim, &gateway_address, &packet));
+	}
+
+	assert(knx_gateway_sim_connections(&sim) == 1);
+
+	// Unknown channels are ignored
+	packet = (knx_packet) {KNX_TUNNEL_REQUEST, {.tunnel_req = {9, 0, cemi}}};
+	assert(!knx_gateway_sim_handle(&sim, &gateway_address, &packet));
+
+	// Disconnect releases the channel
+	knx_tunnel_client_disconnect(&client);
+	gateway_test_pump(&client_transport, &client, &sim_transport, &sim);
+
+	assert(state.state == KNX_TUNNEL_DISCONNECTED);
+	assert(knx_gateway_sim_connections(&sim) == 0);
+
+	knx_tunnel_client_destroy(&client);
+	knx_gateway_sim_destroy(&sim);
+
+	knx_transport_destroy(&client_transport);
+	knx_transport_destroy(&sim_transport);
+})
+
+deftest(tunnel, {
+	runsubtest(knx_timer_wheel);
+	runsubtest(knx_tunnel_client);
+	runsubtest(knx_tunnel_pool);
+	runsubtest(knx_tunnel_pool_routes);
+	runsubtest(knx_routing_engine);
+	runsubtest(knx_reactor);
+	runsubtest(knx_gateway_sim);
+})
@@ -0,0 +1,227 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "testfw.h"
+
+#include "../src/proto/view.h"
+#include "../src/proto/batch.h"
+#include "../src/proto/classify.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+static
+const uint8_t example_view_payload[3] = {0, 11, 22};
+
+deftest(knx_frame_view_tunnel_request, {
+	knx_tunnel_request packet_in = {
+		100,
+		42,
+		{
+			KNX_CEMI_LDATA_REQ,
+			0,
+			NULL,
+			{
+				.ldata = {
+					.control1 = {KNX_LDATA_PRIO_LOW, true, true, true, false},
+					.control2 = {KNX_LDATA_ADDR_GROUP, 7},
+					.source = 123,
+					.destination = 456,
+					.tpdu = {
+						.tpci = KNX_TPCI_UNNUMBERED_DATA,
+						.info = {
+							.data = {
+								.apci = KNX_APCI_GROUPVALUEWRITE,
+								.payload = example_view_payload,
+								.length = sizeof(example_view_payload)
+							}
+						}
+					}
+				}
+			}
+		}
+	};
+
+	uint8_t buffer[knx_size(KNX_TUNNEL_REQUEST, &packet_in)];
+	assert(knx_generate(buffer, KNX_TUNNEL_REQUEST, &packet_in));
+
+	knx_frame_view view;
+	assert(knx_frame_view_init(&view, buffer, sizeof(buffer)) == (ssize_t) sizeof(buffer));
+	assert(view.service == KNX_TUNNEL_REQUEST);
+
+	uint8_t channel, seq_number;
+	assert(knx_frame_view_channel(&view, &channel) && channel == 100);
+	assert(knx_frame_view_seq_number(&view, &seq_number) && seq_number == 42);
+
+	knx_cemi_service cemi_service;
+	assert(knx_frame_view_cemi_service(&view, &cemi_service));
+	assert(cemi_service == KNX_CEMI_LDATA_REQ);
+
+	knx_addr source, destination;
+	knx_ldata_addr_type address_type;
+	assert(knx_frame_view_source(&view, &source) && source == 123);
+	assert(knx_frame_view_destination(&view, &destination, &address_type));
+	assert(destination == 456 && address_type == KNX_LDATA_ADDR_GROUP);
+
+	knx_apci apci;
+	assert(knx_frame_view_apci(&view, &apci) && apci == KNX_APCI_GROUPVALUEWRITE);
+
+	const uint8_t* apdu;
+	size_t apdu_length;
+	assert(knx_frame_view_apdu(&view, &apdu, &apdu_length));
+	assert(apdu_length == sizeof(example_view_payload));
+	assert(memcmp(apdu + 1, example_view_payload + 1, apdu_length - 1) == 0);
+
+	// Must agree with the eager parser
+	knx_packet packet_out;
+	assert(knx_parse(buffer, sizeof(buffer), &packet_out) > 0);
+	assert(packet_out.payload.tunnel_req.data.payload.ldata.tpdu.info.data.payload == apdu);
+})
+
+deftest(knx_frame_view_invalid, {
+	knx_tunnel_response packet_in = {1, 2, 0};
+
+	uint8_t buffer[KNX_HEADER_SIZE + KNX_TUNNEL_RESPONSE_SIZE];
+	assert(knx_generate(buffer, KNX_TUNNEL_RESPONSE, &packet_in));
+
+	knx_frame_view view;
+	assert(knx_frame_view_init(&view, buffer, sizeof(buffer) - 1) == -KNX_INVALID_BUFFER);
+	assert(knx_frame_view_init(&view, buffer, sizeof(buffer)) > 0);
+
+	// Tunnel responses contain no CEMI frame
+	knx_addr destination;
+	assert(!knx_frame_view_destination(&view, &destination, NULL));
+
+	uint8_t seq_number;
+	assert(knx_frame_view_seq_number(&view, &seq_number) && seq_number == 2);
+})
+
+deftest(knx_parse_batch, {
+	knx_routing_indication ind = {
+		{
+			KNX_CEMI_LDATA_IND,
+			0,
+			NULL,
+			{
+				.ldata = {
+					.control1 = {KNX_LDATA_PRIO_NORMAL, false, true, false, false},
+					.control2 = {KNX_LDATA_ADDR_GROUP, 6},
+					.source = 0x1101,
+					.destination = knx_group_addr(1, 2, 3),
+					.tpdu = {
+						.tpci = KNX_TPCI_UNNUMBERED_DATA,
+						.info = {
+							.data = {
+								.apci = KNX_APCI_GROUPVALUEREAD,
+								.payload = example_view_payload,
+								.length = 1
+							}
+						}
+					}
+				}
+			}
+		}
+	};
+
+	knx_connection_state_response state_res = {7, 0};
+
+	// Tunnel requests carrying a data TPDU and a control TPDU
+	knx_tunnel_request data_req = {1, 0, ind.data};
+	data_req.data.service = KNX_CEMI_LDATA_REQ;
+	data_req.data.payload.ldata.control2.address_type = KNX_LDATA_ADDR_INDIVIDUAL;
+	data_req.data.payload.ldata.destination = knx_individual_addr(1, 1, 5);
+
+	knx_tunnel_request control_req = data_req;
+	control_req.data.payload.ldata.tpdu = (knx_tpdu) {
+		.tpci = KNX_TPCI_UNNUMBERED_CONTROL,
+		.info = {.control = KNX_TPCI_CONTROL_CONNECTED}
+	};
+
+	uint8_t ind_buffer[knx_size(KNX_ROUTING_INDICATION, &ind)];
+	uint8_t state_buffer[KNX_HEADER_SIZE + KNX_CONNECTION_STATE_RESPONSE_SIZE];
+	uint8_t data_buffer[knx_size(KNX_TUNNEL_REQUEST, &data_req)];
+	uint8_t control_buffer[knx_size(KNX_TUNNEL_REQUEST, &control_req)];
+	assert(knx_generate(ind_buffer, KNX_ROUTING_INDICATION, &ind));
+	assert(knx_generate(state_buffer, KNX_CONNECTION_STATE_RESPONSE, &state_res));
+	assert(knx_generate(data_buffer, KNX_TUNNEL_REQUEST, &data_req));
+	assert(knx_generate(control_buffer, KNX_TUNNEL_REQUEST, &control_req));
+
+	const knx_datagram datagrams[] = {
+		{ind_buffer, sizeof(ind_buffer)},
+		{state_buffer, sizeof(state_buffer)},
+		{ind_buffer, 3},
+		{data_buffer, sizeof(data_buffer)},
+		{control_buffer, sizeof(control_buffer)}
+	};
+
+	knx_batch_result result;
+	assert(knx_parse_batch(datagrams, 5, &result) == 5);
+	assert(result.count == 5);
+
+	assert(result.status[0] == 0);
+	assert(result.service[0] == KNX_ROUTING_INDICATION);
+	assert(result.destination[0] == knx_group_addr(1, 2, 3));
+	assert(result.address_type[0] == KNX_LDATA_ADDR_GROUP);
+	assert(result.apci[0] == KNX_APCI_GROUPVALUEREAD);
+	assert(result.payload_length[0] == 1);
+	assert(result.payload_offset[0] + 1u == sizeof(ind_buffer));
+
+	assert(result.status[1] == 0);
+	assert(result.service[1] == KNX_CONNECTION_STATE_RESPONSE);
+	assert(result.payload_offset[1] == KNX_HEADER_SIZE);
+	assert(result.payload_length[1] == KNX_CONNECTION_STATE_RESPONSE_SIZE);
+
+	assert(result.status[2] == KNX_INVALID_BUFFER);
+
+	assert(result.status[3] == 0);
+	assert(result.service[3] == KNX_TUNNEL_REQUEST);
+	assert(result.destination[3] == knx_individual_addr(1, 1, 5));
+	assert(result.address_type[3] == KNX_LDATA_ADDR_INDIVIDUAL);
+	assert(result.apci[3] == KNX_APCI_GROUPVALUEREAD);
+	assert(result.payload_length[3] == 1);
+	assert(result.payload_offset[3] + 1u == sizeof(data_buffer));
+
+	// Control TPDUs have no payload
+	assert(result.status[4] == 0);
+	assert(result.service[4] == KNX_TUNNEL_REQUEST);
+	assert(result.destination[4] == knx_individual_addr(1, 1, 5));
+	assert(result.apci[4] == 0);
+	assert(result.payload_offset[4] == 0);
+	assert(result.payload_length[4] == 0);
+
+	// Classification must agree with the batch parser
+	knx_class key = knx_classify(ind_buffer, sizeof(ind_buffer));
+	assert(knx_class_service(key) == KNX_ROUTING_INDICATION);
+	assert(knx_class_cemi_service(key) == KNX_CEMI_LDATA_IND);
+	assert(knx_class_flags(key) == (KNX_CLASS_GROUP | KNX_CLASS_DATA));
+	assert(knx_class_apci(key) == KNX_APCI_GROUPVALUEREAD);
+	assert(knx_class_destination(key) == knx_group_addr(1, 2, 3));
+	assert(knx_class_apdu_length(key) == 1);
+
+	assert(knx_classify(state_buffer, sizeof(state_buffer)) == 0);
+	assert(knx_classify(ind_buffer, 3) == 0);
+})
+
+deftest(view, {
+	runsubtest(knx_frame_view_tunnel_request);
+	runsubtest(knx_frame_view_invalid);
+	runsubtest(knx_parse_batch);
+})
@@ -0,0 +1,234 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+// Simulated tunnelling gateway for load tests, see `knx-gatewaysim --help`
+
+#include "../src/net/gateway.h"
+
+#include <arpa/inet.h>
+#include <getopt.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static volatile sig_atomic_t running = 1;
+
+static
+void on_signal(int sig) {
+	(void) sig;
+	running = 0;
+}
+
+static
+void usage(const char* name) {
+	fprintf(
+		stderr,
+		"Usage: %s [options]\n"
+		"  -b, --bind ADDRESS         Local address (default 127.0.0.1)\n"
+		"  -p, --port PORT            Local port (default 3671)\n"
+		"  -r, --rate N|max           L_Data.ind per second and connection (default 0)\n"
+		"  -d, --distribution TYPE    sequential, uniform or hotspot (default sequential)\n"
+		"  -g, --group MAIN/MID/SUB   First destination group address (default 1/0/0)\n"
+		"  -n, --count N              Number of destination group addresses (default 256)\n"
+		"  -c, --no-confirm           Do not answer L_Data.req with L_Data.con\n"
+		"  -i, --interval MS          Statistics interval, 0 disables them (default 1000)\n",
+		name
+	);
+}
+
+static
+bool parse_distribution(const char* text, knx_gateway_sim_distribution* distribution) {
+	if (strcmp(text, "sequential") == 0)
+		*distribution = KNX_GATEWAY_SIM_SEQUENTIAL;
+	else if (strcmp(text, "uniform") == 0)
+		*distribution = KNX_GATEWAY_SIM_UNIFORM;
+	else if (strcmp(text, "hotspot") == 0)
+		*distribution = KNX_GATEWAY_SIM_HOTSPOT;
+	else
+		return false;
+
+	return true;
+}
+
+static
+bool parse_group(const char* text, knx_addr* address) {
+	unsigned main, middle, sub;
+
+	if (sscanf(text, "%u/%u/%u", &main, &middle, &sub) != 3 || main > 31 || middle > 7 || sub > 255)
+		return false;
+
+	*address = knx_group_addr(main, middle, sub);
+	return true;
+}
+
+static
+void print_stats(const knx_gateway_sim* sim) {
+	fprintf(
+		stderr,
+		"connections=%zu injected=%llu acknowledged=%llu repeated=%llu dropped=%llu received=%llu\n",
+		knx_gateway_sim_connections(sim),
+		(unsigned long long) sim->stats.injected,
+		(unsigned long long) sim->stats.acknowledged,
+		(unsigned long long) sim->stats.repeated,
+		(unsigned long long) sim->stats.dropped,
+		(unsigned long long) sim->stats.received
+	);
+}
+
+int main(int argc, char** argv) {
+	static const struct option options[] = {
+		{"bind",         required_argument, NULL, 'b'},
+		{"port",         required_argument, NULL, 'p'},
+		{"rate",         required_argument, NULL, 'r'},
+		{"distribution", required_argument, NULL, 'd'},
+		{"group",        required_argument, NULL, 'g'},
+		{"count",        required_argument, NULL, 'n'},
+		{"no-confirm",   no_argument,       NULL, 'c'},
+		{"interval",     required_argument, NULL, 'i'},
+		{"help",         no_argument,       NULL, 'h'},
+		{NULL, 0, NULL, 0}
+	};
+
+	struct sockaddr_in local = {.sin_family = AF_INET};
+	local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	local.sin_port = htons(3671);
+
+	knx_gateway_sim_traffic traffic = {
+		0,
+		KNX_GATEWAY_SIM_SEQUENTIAL,
+		knx_group_addr(1, 0, 0),
+		256,
+		knx_individual_addr(1, 1, 1)
+	};
+
+	bool confirm = true;
+	unsigned long interval = 1000;
+	int opt;
+
+	while ((opt = getopt_long(argc, argv, "b:p:r:d:g:n:ci:h", options, NULL)) != -1) {
+		switch (opt) {
+			case 'b':
+				if (inet_pton(AF_INET, optarg, &local.sin_addr) != 1) {
+					fprintf(stderr, "Invalid address '%s'\n", optarg);
+					return 1;
+				}
+
+				break;
+
+			case 'p':
+				local.sin_port = htons(strtoul(optarg, NULL, 10));
+				break;
+
+			case 'r':
+				if (strcmp(optarg, "max") == 0)
+					traffic.rate = KNX_GATEWAY_SIM_UNPACED;
+				else
+					traffic.rate = strtoul(optarg, NULL, 10);
+
+				break;
+
+			case 'd':
+				if (!parse_distribution(optarg, &traffic.distribution)) {
+					fprintf(stderr, "Unknown distribution '%s'\n", optarg);
+					return 1;
+				}
+
+				break;
+
+			case 'g':
+				if (!parse_group(optarg, &traffic.first)) {
+					fprintf(stderr, "Invalid group address '%s'\n", optarg);
+					return 1;
+				}
+
+				break;
+
+			case 'n':
+				traffic.count = strtoul(optarg, NULL, 10);
+				break;
+
+			case 'c':
+				confirm = false;
+				break;
+
+			case 'i':
+				interval = strtoul(optarg, NULL, 10);
+				break;
+
+			default:
+				usage(argv[0]);
+				return opt == 'h' ? 0 : 1;
+		}
+	}
+
+	knx_transport transport;
+	if (!knx_transport_init(&transport, &local)) {
+		perror("knx_transport_init");
+		return 1;
+	}
+
+	knx_timer_wheel wheel;
+	knx_timer_wheel_init(&wheel, knx_timer_now(), 1);
+
+	knx_gateway_sim sim;
+	knx_gateway_sim_init(&sim, &transport, &wheel, NULL, NULL);
+	sim.confirm = confirm;
+
+	if (!knx_gateway_sim_set_traffic(&sim, &traffic)) {
+		fprintf(stderr, "The destination range must not be empty\n");
+		return 1;
+	}
+
+	signal(SIGINT, on_signal);
+	signal(SIGTERM, on_signal);
+
+	uint64_t reported = wheel.now;
+
+	while (running) {
+		struct pollfd pfd = {transport.sock, POLLIN, 0};
+		int timeout = knx_timer_wheel_timeout(&wheel);
+
+		if (interval > 0 && (timeout < 0 || (unsigned long) timeout > interval))
+			timeout = interval;
+
+		if (poll(&pfd, 1, transport.tx_count > 0 ? 0 : timeout) < 0)
+			continue;
+
+		while (knx_transport_dispatch(&transport, knx_gateway_sim_dispatch, &sim) > 0);
+
+		knx_timer_wheel_advance(&wheel, knx_timer_now());
+		knx_transport_flush(&transport);
+
+		if (interval > 0 && wheel.now - reported >= interval) {
+			print_stats(&sim);
+			reported = wheel.now;
+		}
+	}
+
+	print_stats(&sim);
+
+	knx_gateway_sim_destroy(&sim);
+	knx_transport_destroy(&transport);
+
+	return 0;
+}
@@ -0,0 +1,616 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+// Traffic generator with latency percentiles, see `knx-loadgen --help`
+
+#include "../src/net/tunnel.h"
+#include "../src/net/routing.h"
+
+#include <arpa/inet.h>
+#include <getopt.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * Maximum number of tunnel connections
+ */
+#define LOADGEN_CONNECTIONS 8
+
+/**
+ * Number of acknowledged frames per connection that may await their L_Data.con
+ */
+#define LOADGEN_PENDING_CON 1024
+
+/**
+ * Time to wait for outstanding acknowledgements and confirmations after the run
+ */
+#define LOADGEN_DRAIN_TIME 1000000
+
+typedef enum {
+	LOADGEN_GROUP_WRITE,
+	LOADGEN_GROUP_READ,
+	LOADGEN_NUMBERED_DATA,
+	LOADGEN_KINDS
+} loadgen_kind;
+
+typedef struct {
+	uint64_t* values;
+	size_t    count;
+	size_t    capacity;
+} loadgen_samples;
+
+typedef struct loadgen_connection loadgen_connection;
+
+typedef struct {
+	bool     routing;
+	uint32_t rate;
+	uint64_t duration;
+	uint32_t weights[LOADGEN_KINDS];
+	knx_addr group;
+	uint16_t group_count;
+	knx_addr device;
+
+	uint64_t sent;
+	uint64_t acknowledged;
+	uint64_t confirmed;
+	uint64_t unmatched;
+
+	loadgen_samples ack_latency;
+	loadgen_samples con_latency;
+} loadgen;
+
+// Submission times follow the client's queue, confirmations arrive in the same order
+struct loadgen_connection {
+	loadgen*          gen;
+	knx_transport     transport;
+	knx_tunnel_client client;
+
+	uint64_t ack_times[KNX_TUNNEL_QUEUE_SIZE];
+	size_t   ack_head;
+	size_t   ack_count;
+
+	uint64_t con_times[LOADGEN_PENDING_CON];
+	size_t   con_head;
+	size_t   con_count;
+};
+
+static
+uint64_t loadgen_now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static
+void loadgen_record(loadgen_samples* samples, uint64_t value) {
+	if (samples->count == samples->capacity) {
+		size_t capacity = samples->capacity > 0 ? samples->capacity * 2 : 4096;
+		uint64_t* values = realloc(samples->values, capacity * sizeof(uint64_t));
+
+		if (!values)
+			return;
+
+		samples->values = values;
+		samples->capacity = capacity;
+	}
+
+	samples->values[samples->count++] = value;
+}
+
+static
+int loadgen_compare(const void* a, const void* b) {
+	uint64_t x = *(const uint64_t*) a, y = *(const uint64_t*) b;
+	return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of sorted samples
+static
+uint64_t loadgen_percentile(const loadgen_samples* samples, double p) {
+	size_t rank = (size_t) (p * samples->count + 0.999999);
+
+	if (rank == 0)
+		rank = 1;
+
+	return samples->values[rank - 1];
+}
+
+static
+void loadgen_print_samples(const char* name, loadgen_samples* samples) {
+	if (samples->count == 0) {
+		printf("\"%s\":null", name);
+		return;
+	}
+
+	qsort(samples->values, samples->count, sizeof(uint64_t), loadgen_compare);
+
+	printf(
+		"\"%s\":{\"count\":%zu,\"p50\":%llu,\"p99\":%llu,\"p999\":%llu,\"max\":%llu}",
+		name,
+		samples->count,
+		(unsigned long long) loadgen_percentile(samples, 0.5),
+		(unsigned long long) loadgen_percentile(samples, 0.99),
+		(unsigned long long) loadgen_percentile(samples, 0.999),
+		(unsigned long long) samples->values[samples->count - 1]
+	);
+}
+
+static
+loadgen_kind loadgen_pick(const loadgen* gen, uint64_t n) {
+	uint32_t total = 0;
+
+	for (size_t i = 0; i < LOADGEN_KINDS; i++)
+		total += gen->weights[i];
+
+	uint32_t point = n % total;
+
+	for (size_t i = 0; i < LOADGEN_KINDS; i++) {
+		if (point < gen->weights[i])
+			return i;
+
+		point -= gen->weights[i];
+	}
+
+	return LOADGEN_GROUP_WRITE;
+}
+
+// Build the n-th frame of the mix, `apdu` must have room for 3 bytes
+static
+void loadgen_frame(const loadgen* gen, uint64_t n, knx_cemi* cemi, uint8_t* apdu) {
+	*cemi = (knx_cemi) {
+		gen->routing ? KNX_CEMI_LDATA_IND : KNX_CEMI_LDATA_REQ,
+		0,
+		NULL,
+		{
+			.ldata = {
+				.control1 = {KNX_LDATA_PRIO_LOW, true, true, false, false},
+				.control2 = {KNX_LDATA_ADDR_GROUP, 6},
+				.source = 0,
+				.destination = gen->group + n % gen->group_count,
+				.tpdu = {
+					.tpci = KNX_TPCI_UNNUMBERED_DATA,
+					.info = {.data = {KNX_APCI_GROUPVALUEWRITE, apdu, 2}}
+				}
+			}
+		}
+	};
+
+	knx_ldata* ldata = &cemi->payload.ldata;
+
+	switch (loadgen_pick(gen, n)) {
+		case LOADGEN_GROUP_WRITE:
+			apdu[0] = 0;
+			apdu[1] = n & 0xFF;
+			break;
+
+		case LOADGEN_GROUP_READ:
+			apdu[0] = 0;
+			ldata->tpdu.info.data.apci = KNX_APCI_GROUPVALUEREAD;
+			ldata->tpdu.info.data.length = 1;
+			break;
+
+		case LOADGEN_NUMBERED_DATA:
+			// Memory read of one byte at 0x0010
+			apdu[0] = 1;
+			apdu[1] = 0x00;
+			apdu[2] = 0x10;
+
+			ldata->control2.address_type = KNX_LDATA_ADDR_INDIVIDUAL;
+			ldata->destination = gen->device;
+			ldata->tpdu.tpci = KNX_TPCI_NUMBERED_DATA;
+			ldata->tpdu.seq_number = n & 15;
+			ldata->tpdu.info.data.apci = KNX_APCI_MEMORYREAD;
+			ldata->tpdu.info.data.length = 3;
+			break;
+
+		default:
+			break;
+	}
+}
+
+static
+void loadgen_received(void* data, knx_tunnel_client* client, const knx_cemi* cemi) {
+	loadgen_connection* conn = data;
+	(void) client;
+
+	if (cemi->service != KNX_CEMI_LDATA_CON)
+		return;
+
+	if (conn->con_count == 0) {
+		conn->gen->unmatched++;
+		return;
+	}
+
+	loadgen_record(&conn->gen->con_latency, loadgen_now() - conn->con_times[conn->con_head]);
+
+	conn->con_head = (conn->con_head + 1) % LOADGEN_PENDING_CON;
+	conn->con_count--;
+	conn->gen->confirmed++;
+}
+
+static
+void loadgen_dispatch(
+	void*                     data,
+	const struct sockaddr_in* sender,
+	const uint8_t*            frame,
+	size_t                    length,
+	const knx_packet*         packet
+) {
+	loadgen_connection* conn = data;
+	uint8_t seq_number = conn->client.tx_seq_number;
+
+	(void) sender;
+	(void) frame;
+	(void) length;
+
+	if (!packet || !knx_tunnel_client_handle(&conn->client, packet))
+		return;
+
+	// The sequence number only advances when the request in flight has been acknowledged
+	if (packet->service != KNX_TUNNEL_RESPONSE || conn->client.tx_seq_number == seq_number ||
+	    conn->ack_count == 0)
+		return;
+
+	uint64_t submitted = conn->ack_times[conn->ack_head];
+
+	conn->ack_head = (conn->ack_head + 1) % KNX_TUNNEL_QUEUE_SIZE;
+	conn->ack_count--;
+	conn->gen->acknowledged++;
+
+	loadgen_record(&conn->gen->ack_latency, loadgen_now() - submitted);
+
+	// Without confirmations the oldest entry makes room
+	if (conn->con_count == LOADGEN_PENDING_CON) {
+		conn->con_head = (conn->con_head + 1) % LOADGEN_PENDING_CON;
+		conn->con_count--;
+	}
+
+	conn->con_times[(conn->con_head + conn->con_count) % LOADGEN_PENDING_CON] = submitted;
+	conn->con_count++;
+}
+
+static
+bool loadgen_submit(loadgen_connection* conn, const knx_cemi* cemi) {
+	if (!knx_tunnel_client_send(&conn->client, cemi))
+		return false;
+
+	conn->ack_times[(conn->ack_head + conn->ack_count) % KNX_TUNNEL_QUEUE_SIZE] = loadgen_now();
+	conn->ack_count++;
+
+	return true;
+}
+
+static
+void loadgen_routing_dispatch(
+	void*                     data,
+	const struct sockaddr_in* sender,
+	const uint8_t*            frame,
+	size_t                    length,
+	const knx_packet*         packet
+) {
+	(void) sender;
+	(void) frame;
+	(void) length;
+
+	if (packet)
+		knx_routing_engine_handle(data, packet);
+}
+
+static
+void usage(const char* name) {
+	fprintf(
+		stderr,
+		"Usage: %s [options]\n"
+		"  -t, --target ADDRESS[:PORT]  Gateway or multicast group (default 127.0.0.1:3671)\n"
+		"  -R, --routing                Send routing indications instead of tunnelling\n"
+		"  -c, --connections N          Tunnel connections (default 1, at most %d)\n"
+		"  -r, --rate N                 Frames per second in total (default 100)\n"
+		"  -d, --duration SECONDS       Length of the run (default 10)\n"
+		"  -m, --mix W:R:T              Weights of group writes, group reads and numbered\n"
+		"                               T_Data (default 90:5:5)\n"
+		"  -g, --group MAIN/MID/SUB     First destination group address (default 1/0/0)\n"
+		"  -n, --count N                Number of destination group addresses (default 256)\n"
+		"  -D, --device AREA.LINE.DEV   Destination of numbered T_Data (default 1.1.10)\n"
+		"\n"
+		"Latencies are reported in microseconds, measured from the submission of a frame.\n",
+		name,
+		LOADGEN_CONNECTIONS
+	);
+}
+
+static
+bool parse_target(const char* text, struct sockaddr_in* target) {
+	char host[64];
+	unsigned port = 3671;
+
+	if (sscanf(text, "%63[^:]:%u", host, &port) < 1 || port > 65535 ||
+	    inet_pton(AF_INET, host, &target->sin_addr) != 1)
+		return false;
+
+	target->sin_family = AF_INET;
+	target->sin_port = htons(port);
+
+	return true;
+}
+
+int main(int argc, char** argv) {
+	static const struct option options[] = {
+		{"target",      required_argument, NULL, 't'},
+		{"routing",     no_argument,       NULL, 'R'},
+		{"connections", required_argument, NULL, 'c'},
+		{"rate",        required_argument, NULL, 'r'},
+		{"duration",    required_argument, NULL, 'd'},
+		{"mix",         required_argument, NULL, 'm'},
+		{"group",       required_argument, NULL, 'g'},
+		{"count",       required_argument, NULL, 'n'},
+		{"device",      required_argument, NULL, 'D'},
+		{"help",        no_argument,       NULL, 'h'},
+		{NULL, 0, NULL, 0}
+	};
+
+	static loadgen gen = {
+		.routing = false,
+		.rate = 100,
+		.duration = 10,
+		.weights = {90, 5, 5},
+		.group_count = 256
+	};
+
+	static loadgen_connection conns[LOADGEN_CONNECTIONS];
+
+	struct sockaddr_in target = {.sin_family = AF_INET};
+	target.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	target.sin_port = htons(3671);
+
+	gen.group = knx_group_addr(1, 0, 0);
+	gen.device = knx_individual_addr(1, 1, 10);
+
+	size_t num_conns = 1;
+	unsigned a, b, c;
+	int opt;
+
+	while ((opt = getopt_long(argc, argv, "t:Rc:r:d:m:g:n:D:h", options, NULL)) != -1) {
+		switch (opt) {
+			case 't':
+				if (!parse_target(optarg, &target)) {
+					fprintf(stderr, "Invalid target '%s'\n", optarg);
+					return 1;
+				}
+
+				break;
+
+			case 'R':
+				gen.routing = true;
+				break;
+
+			case 'c':
+				num_conns = strtoul(optarg, NULL, 10);
+				break;
+
+			case 'r':
+				gen.rate = strtoul(optarg, NULL, 10);
+				break;
+
+			case 'd':
+				gen.duration = strtoul(optarg, NULL, 10);
+				break;
+
+			case 'm':
+				if (sscanf(optarg, "%u:%u:%u", &a, &b, &c) != 3 || a + b + c == 0) {
+					fprintf(stderr, "Invalid mix '%s'\n", optarg);
+					return 1;
+				}
+
+				gen.weights[LOADGEN_GROUP_WRITE] = a;
+				gen.weights[LOADGEN_GROUP_READ] = b;
+				gen.weights[LOADGEN_NUMBERED_DATA] = c;
+				break;
+
+			case 'g':
+				if (sscanf(optarg, "%u/%u/%u", &a, &b, &c) != 3 || a > 31 || b > 7 || c > 255) {
+					fprintf(stderr, "Invalid group address '%s'\n", optarg);
+					return 1;
+				}
+
+				gen.group = knx_group_addr(a, b, c);
+				break;
+
+			case 'n':
+				gen.group_count = strtoul(optarg, NULL, 10);
+				break;
+
+			case 'D':
+				if (sscanf(optarg, "%u.%u.%u", &a, &b, &c) != 3 || a > 15 || b > 15 || c > 255) {
+					fprintf(stderr, "Invalid individual address '%s'\n", optarg);
+					return 1;
+				}
+
+				gen.device = knx_individual_addr(a, b, c);
+				break;
+
+			default:
+				usage(argv[0]);
+				return opt == 'h' ? 0 : 1;
+		}
+	}
+
+	if (num_conns == 0 || num_conns > LOADGEN_CONNECTIONS || gen.rate == 0 ||
+	    gen.group_count == 0) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	if (gen.routing)
+		num_conns = 1;
+
+	knx_timer_wheel wheel;
+	knx_timer_wheel_init(&wheel, knx_timer_now(), 1);
+
+	knx_tunnel_handlers handlers = {NULL, loadgen_received};
+	knx_routing_engine engine;
+	struct pollfd fds[LOADGEN_CONNECTIONS];
+
+	for (size_t i = 0; i < num_conns; i++) {
+		loadgen_connection* conn = &conns[i];
+		conn->gen = &gen;
+
+		if (!knx_transport_init(&conn->transport, NULL)) {
+			perror("knx_transport_init");
+			return 1;
+		}
+
+		fds[i] = (struct pollfd) {conn->transport.sock, POLLIN, 0};
+
+		if (!gen.routing) {
+			knx_tunnel_client_init(&conn->client, &conn->transport, &wheel, &target, &handlers, conn);
+			knx_tunnel_client_connect(&conn->client);
+		}
+	}
+
+	if (gen.routing) {
+		if (IN_MULTICAST(ntohl(target.sin_addr.s_addr)))
+			knx_transport_join(&conns[0].transport, target.sin_addr.s_addr, INADDR_ANY);
+
+		knx_routing_engine_init(&engine, &conns[0].transport, &wheel, &target, NULL, NULL);
+
+		// The load generator deliberately exceeds the rate permitted for routing participants
+		engine.rate = gen.rate;
+		engine.burst = gen.rate / 100 > KNX_ROUTING_BURST ? gen.rate / 100 : KNX_ROUTING_BURST;
+	}
+
+	uint64_t start = 0, end = 0, now;
+	size_t next_conn = 0;
+
+	while (true) {
+		now = loadgen_now();
+
+		// The clock starts once every tunnel connection is established
+		if (start == 0) {
+			size_t connected = 0;
+
+			for (size_t i = 0; i < num_conns; i++) {
+				if (gen.routing || conns[i].client.state == KNX_TUNNEL_CONNECTED)
+					connected++;
+			}
+
+			if (connected == num_conns) {
+				start = now;
+				end = start + gen.duration * 1000000;
+			}
+		}
+
+		if (start > 0 && now >= end + LOADGEN_DRAIN_TIME)
+			break;
+
+		if (start > 0 && now < end) {
+			uint64_t due = (now - start) * gen.rate / 1000000;
+
+			while (gen.sent < due) {
+				uint8_t apdu[3];
+				knx_cemi cemi;
+				bool queued;
+
+				loadgen_frame(&gen, gen.sent, &cemi, apdu);
+
+				if (gen.routing) {
+					queued = knx_routing_engine_send(&engine, &cemi);
+				} else {
+					queued = loadgen_submit(&conns[next_conn], &cemi);
+					next_conn = (next_conn + 1) % num_conns;
+				}
+
+				// Frames stay due while the queues are full
+				if (!queued)
+					break;
+
+				gen.sent++;
+			}
+		}
+
+		int timeout = knx_timer_wheel_timeout(&wheel);
+		if (timeout < 0 || timeout > 1)
+			timeout = 1;
+
+		poll(fds, num_conns, timeout);
+
+		for (size_t i = 0; i < num_conns; i++) {
+			if (gen.routing)
+				knx_transport_dispatch(&conns[i].transport, loadgen_routing_dispatch, &engine);
+			else
+				knx_transport_dispatch(&conns[i].transport, loadgen_dispatch, &conns[i]);
+		}
+
+		knx_timer_wheel_advance(&wheel, knx_timer_now());
+
+		for (size_t i = 0; i < num_conns; i++)
+			knx_transport_flush(&conns[i].transport);
+
+		// Give up if the connections cannot be established
+		if (start == 0 && !gen.routing && conns[0].client.state == KNX_TUNNEL_DISCONNECTED) {
+			fprintf(stderr, "Connection to the gateway failed\n");
+			return 1;
+		}
+	}
+
+	printf(
+		"{\"mode\":\"%s\",\"connections\":%zu,\"rate\":%u,\"duration\":%llu,\"sent\":%llu,"
+		"\"achieved_rate\":%.1f,\"acknowledged\":%llu,\"confirmed\":%llu,\"unmatched\":%llu,",
+		gen.routing ? "routing" : "tunnel",
+		num_conns,
+		gen.rate,
+		(unsigned long long) gen.duration,
+		(unsigned long long) gen.sent,
+		gen.duration > 0 ? (double) gen.sent / gen.duration : 0.0,
+		(unsigned long long) gen.acknowledged,
+		(unsigned long long) gen.confirmed,
+		(unsigned long long) gen.unmatched
+	);
+
+	loadgen_print_samples("ack", &gen.ack_latency);
+	printf(",");
+	loadgen_print_samples("con", &gen.con_latency);
+
+	if (gen.routing)
+		printf(",\"lost_messages\":%llu", (unsigned long long) engine.lost_messages);
+
+	printf("}\n");
+
+	for (size_t i = 0; i < num_conns; i++) {
+		if (!gen.routing) {
+			knx_tunnel_client_disconnect(&conns[i].client);
+			knx_transport_flush(&conns[i].transport);
+			knx_tunnel_client_destroy(&conns[i].client);
+		}
+
+		knx_transport_destroy(&conns[i].transport);
+	}
+
+	if (gen.routing)
+		knx_routing_engine_destroy(&engine);
+
+	free(gen.ack_latency.values);
+	free(gen.con_latency.values);
+
+	return 0;
+}